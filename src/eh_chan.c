@@ -0,0 +1,241 @@
+/**
+ * @file eh_chan.c
+ * @brief 通道的实现，等待中的发送者和接收者以事件接收器的形式挂在通道的
+ *    send_event/recv_event上，对端操作时直接取出第一个接收器完成数据交接并唤醒对应任务，
+ *    不会唤醒其他无关的任务。
+ *      使用限制: 此模块所有的函数都只能在协程上下文中使用
+ * @author simon.xiaoapeng (simon.xiaoapeng@gmail.com)
+ * @version 1.0
+ * @date 2024-08-08
+ * 
+ * @copyright Copyright (c) 2024  simon.xiaoapeng@gmail.com
+ * 
+ * @par 修改日志:
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "eh.h"
+#include "eh_error.h"
+#include "eh_event.h"
+#include "eh_mem.h"
+#include "eh_platform.h"
+#include "eh_interior.h"
+#include "eh_timer.h"
+#include "eh_chan.h"
+
+struct eh_chan {
+    eh_event_t                  send_event;         /* 接收器链表上挂着等待发送的任务 */
+    eh_event_t                  recv_event;         /* 接收器链表上挂着等待接收的任务 */
+    uint8_t                     *buf;
+    uint32_t                    elem_size;
+    uint32_t                    capacity;
+    uint32_t                    r;
+    uint32_t                    cnt;
+    bool                        closed;
+};
+
+/* 一次select的等待上下文，多个等待者共享，只有一个能完成 */
+struct eh_chan_wait_ctx {
+    int                         done_index;
+    int                         result;
+};
+
+struct eh_chan_waiter {
+    struct eh_event_receptor    receptor;
+    struct eh_chan_wait_ctx     *ctx;
+    void                        *elem;
+    int                         index;
+};
+
+#define eh_chan_elem(chan, pos)     ((chan)->buf + (size_t)((pos) % (chan)->capacity) * (chan)->elem_size)
+
+static struct eh_chan_waiter* _eh_chan_first_waiter_no_lock(eh_event_t *e){
+    struct eh_event_receptor *pos;
+    struct eh_chan_waiter *waiter;
+    eh_list_for_each_entry(pos, &e->receptor_list_head, list_node){
+        waiter = eh_container_of(pos, struct eh_chan_waiter, receptor);
+        if(waiter->ctx->done_index < 0)
+            return waiter;
+    }
+    return NULL;
+}
+
+static void _eh_chan_waiter_complete_no_lock(struct eh_chan_waiter *waiter, int result){
+    waiter->ctx->done_index = waiter->index;
+    waiter->ctx->result = result;
+    waiter->receptor.trigger = 1;
+    eh_event_remove_receptor_no_lock(&waiter->receptor);
+    eh_task_wake_up(waiter->receptor.wakeup_task);
+}
+
+static int _eh_chan_try_send_no_lock(struct eh_chan *chan, const void *elem){
+    struct eh_chan_waiter *receiver;
+    if(chan->closed)
+        return EH_RET_INVALID_STATE;
+    receiver = _eh_chan_first_waiter_no_lock(&chan->recv_event);
+    if(receiver){
+        /* 直接交给等待中的接收者 */
+        memcpy(receiver->elem, elem, chan->elem_size);
+        _eh_chan_waiter_complete_no_lock(receiver, EH_RET_OK);
+        return EH_RET_OK;
+    }
+    if(chan->cnt < chan->capacity){
+        memcpy(eh_chan_elem(chan, chan->r + chan->cnt), elem, chan->elem_size);
+        chan->cnt++;
+        return EH_RET_OK;
+    }
+    return EH_RET_BUSY;
+}
+
+static int _eh_chan_try_recv_no_lock(struct eh_chan *chan, void *elem){
+    struct eh_chan_waiter *sender;
+    sender = _eh_chan_first_waiter_no_lock(&chan->send_event);
+    if(chan->cnt){
+        memcpy(elem, eh_chan_elem(chan, chan->r), chan->elem_size);
+        chan->r = (chan->r + 1) % chan->capacity;
+        chan->cnt--;
+        if(sender){
+            /* 缓冲区腾出了位置，把等待中的发送者的数据补到队尾 */
+            memcpy(eh_chan_elem(chan, chan->r + chan->cnt), sender->elem, chan->elem_size);
+            chan->cnt++;
+            _eh_chan_waiter_complete_no_lock(sender, EH_RET_OK);
+        }
+        return EH_RET_OK;
+    }
+    if(sender){
+        memcpy(elem, sender->elem, chan->elem_size);
+        _eh_chan_waiter_complete_no_lock(sender, EH_RET_OK);
+        return EH_RET_OK;
+    }
+    if(chan->closed)
+        return EH_RET_INVALID_STATE;
+    return EH_RET_BUSY;
+}
+
+static int _eh_chan_try_case_no_lock(struct eh_chan_case *chan_case){
+    struct eh_chan *chan = (struct eh_chan *)chan_case->chan;
+    if(chan_case->dir == EH_CHAN_DIR_SEND)
+        return _eh_chan_try_send_no_lock(chan, chan_case->elem);
+    return _eh_chan_try_recv_no_lock(chan, chan_case->elem);
+}
+
+eh_chan_t eh_chan_create(uint32_t elem_size, uint32_t capacity){
+    struct eh_chan *chan;
+    if(elem_size == 0)
+        return eh_error_to_ptr(EH_RET_INVALID_PARAM);
+    chan = eh_malloc(sizeof(struct eh_chan) + (size_t)elem_size * capacity);
+    if(chan == NULL)
+        return eh_error_to_ptr(EH_RET_MALLOC_ERROR);
+    eh_event_init(&chan->send_event);
+    eh_event_init(&chan->recv_event);
+    chan->buf = (uint8_t*)(chan + 1);
+    chan->elem_size = elem_size;
+    chan->capacity = capacity;
+    chan->r = 0;
+    chan->cnt = 0;
+    chan->closed = false;
+    return (eh_chan_t)chan;
+}
+
+void eh_chan_destroy(eh_chan_t _chan){
+    struct eh_chan *chan = (struct eh_chan *)_chan;
+    eh_event_clean(&chan->send_event);
+    eh_event_clean(&chan->recv_event);
+    eh_free(chan);
+}
+
+void eh_chan_close(eh_chan_t _chan){
+    struct eh_chan *chan = (struct eh_chan *)_chan;
+    struct eh_chan_waiter *waiter;
+    eh_save_state_t state;
+    state = eh_enter_critical();
+    chan->closed = true;
+    while((waiter = _eh_chan_first_waiter_no_lock(&chan->send_event)) != NULL)
+        _eh_chan_waiter_complete_no_lock(waiter, EH_RET_INVALID_STATE);
+    while((waiter = _eh_chan_first_waiter_no_lock(&chan->recv_event)) != NULL)
+        _eh_chan_waiter_complete_no_lock(waiter, EH_RET_INVALID_STATE);
+    eh_exit_critical(state);
+}
+
+int __async__ eh_chan_select(struct eh_chan_case *cases, int case_cnt, eh_sclock_t timeout){
+    struct eh_chan_waiter waiters[EH_CHAN_SELECT_CASE_MAX];
+    struct eh_chan_wait_ctx ctx;
+    struct eh_event_receptor receptor_timer;
+    eh_timer_event_t timeout_timer;
+    eh_save_state_t state;
+    struct eh_chan *chan;
+    int i, ret;
+
+    eh_param_assert(cases);
+    eh_param_assert(case_cnt > 0 && case_cnt <= EH_CHAN_SELECT_CASE_MAX);
+
+    state = eh_enter_critical();
+    for(i = 0; i < case_cnt; i++){
+        ret = _eh_chan_try_case_no_lock(&cases[i]);
+        if(ret != EH_RET_BUSY){
+            eh_exit_critical(state);
+            return ret < 0 ? ret : i;
+        }
+    }
+    if(timeout == 0){
+        eh_exit_critical(state);
+        return EH_RET_TIMEOUT;
+    }
+
+    ctx.done_index = -1;
+    ctx.result = EH_RET_OK;
+    for(i = 0; i < case_cnt; i++){
+        chan = (struct eh_chan *)cases[i].chan;
+        eh_event_receptor_init(&waiters[i].receptor, eh_task_get_current());
+        waiters[i].ctx = &ctx;
+        waiters[i].elem = cases[i].elem;
+        waiters[i].index = i;
+        eh_event_add_receptor_no_lock(cases[i].dir == EH_CHAN_DIR_SEND ? &chan->send_event : &chan->recv_event,
+            &waiters[i].receptor);
+    }
+    eh_exit_critical(state);
+
+    eh_event_receptor_init(&receptor_timer, eh_task_get_current());
+    if(!eh_time_is_forever(timeout)){
+        eh_timer_init(&timeout_timer);
+        eh_timer_config_interval(&timeout_timer, timeout);
+        /* timer没有start前，可以无锁add */
+        eh_event_add_receptor_no_lock(eh_timer_to_event(&timeout_timer), &receptor_timer);
+        eh_timer_start(&timeout_timer);
+    }
+
+    for(;;){
+        state = eh_enter_critical();
+        if(ctx.done_index >= 0){
+            ret = ctx.result < 0 ? ctx.result : ctx.done_index;
+            goto unlock_out;
+        }
+        for(i = 0; i < case_cnt; i++){
+            if(waiters[i].receptor.error){
+                ret = EH_RET_EVENT_ERROR;
+                goto unlock_out;
+            }
+        }
+        if(receptor_timer.flags){
+            ret = receptor_timer.trigger ? EH_RET_TIMEOUT : EH_RET_EVENT_ERROR;
+            goto unlock_out;
+        }
+        eh_task_set_current_state(EH_TASK_STATE_WAIT);
+        eh_exit_critical(state);
+
+        __await__ eh_task_next();
+    }
+
+unlock_out:
+    for(i = 0; i < case_cnt; i++)
+        eh_event_remove_receptor_no_lock(&waiters[i].receptor);
+    eh_exit_critical(state);
+
+    if(!eh_time_is_forever(timeout)){
+        eh_timer_stop(&timeout_timer);
+        eh_event_remove_receptor_no_lock(&receptor_timer);
+    }
+    return ret;
+}
@@ -0,0 +1,84 @@
+/**
+ * @file eh_counter_event.c
+ * @brief 计数事件的实现
+ * @author simon.xiaoapeng (simon.xiaoapeng@gmail.com)
+ * @version 1.0
+ * @date 2024-08-15
+ *
+ * @copyright Copyright (c) 2024  simon.xiaoapeng@gmail.com
+ *
+ * @par 修改日志:
+ */
+
+#include "eh.h"
+#include "eh_error.h"
+#include "eh_event.h"
+#include "eh_counter_event.h"
+
+struct eh_counter_event_take_ctx {
+    eh_counter_event_t              *ce;
+    uint32_t                        max;
+    uint32_t                        count;
+};
+
+int eh_counter_event_init(eh_counter_event_t *ce, uint32_t init_count){
+    eh_param_assert(ce);
+    __atomic_store_n(&ce->count, init_count, __ATOMIC_RELAXED);
+    return eh_event_init(&ce->event);
+}
+
+void eh_counter_event_clean(eh_counter_event_t *ce){
+    eh_event_clean(&ce->event);
+}
+
+int eh_counter_event_add(eh_counter_event_t *ce, uint32_t n){
+    uint32_t count;
+    eh_param_assert(ce);
+    if(n == 0)
+        return EH_RET_OK;
+    count = __atomic_load_n(&ce->count, __ATOMIC_RELAXED);
+    do{
+        if(count > UINT32_MAX - n)
+            return EH_RET_BUSY;
+    }while(!__atomic_compare_exchange_n(&ce->count, &count, count + n, true,
+        __ATOMIC_SEQ_CST, __ATOMIC_RELAXED));
+    /*
+     * 计数原本不为0时，等待者要么还没检查计数，要么已经被上一次通知唤醒，
+     * 无论哪种情况都会看到新增的计数，无需再次通知
+     */
+    if(count)
+        return EH_RET_OK;
+    return eh_event_notify(&ce->event);
+}
+
+uint32_t eh_counter_event_try_take(eh_counter_event_t *ce, uint32_t max){
+    uint32_t count, take;
+    count = __atomic_load_n(&ce->count, __ATOMIC_RELAXED);
+    do{
+        if(count == 0)
+            return 0;
+        take = count < max ? count : max;
+    }while(!__atomic_compare_exchange_n(&ce->count, &count, count - take, true,
+        __ATOMIC_SEQ_CST, __ATOMIC_RELAXED));
+    return take;
+}
+
+static bool condition_take(void *arg){
+    struct eh_counter_event_take_ctx *ctx = (struct eh_counter_event_take_ctx *)arg;
+    ctx->count = eh_counter_event_try_take(ctx->ce, ctx->max);
+    return ctx->count != 0;
+}
+
+int __async__ eh_counter_event_take(eh_counter_event_t *ce, uint32_t max, uint32_t *count, eh_sclock_t timeout){
+    struct eh_counter_event_take_ctx ctx;
+    int ret;
+    eh_param_assert(ce);
+    eh_param_assert(max);
+    ctx.ce = ce;
+    ctx.max = max;
+    ctx.count = 0;
+    ret = __await__ eh_event_wait_condition_timeout(&ce->event, &ctx, condition_take, timeout);
+    if(count)
+        *count = ctx.count;
+    return ret;
+}
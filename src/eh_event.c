@@ -123,16 +123,38 @@ unlock_out:
     return ret;
 }
 
+struct eh_epoll_waiter{
+    struct eh_list_head                 list_node;
+    eh_task_t                           *task;
+};
+
+/**
+ * @brief 唤醒等待最久的一个空闲等待者，被唤醒的等待者离开空闲队列
+ */
+static void _eh_epoll_wake_one_waiter_no_lock(struct eh_epoll *epoll){
+    struct eh_epoll_waiter *waiter;
+    if(eh_list_empty(&epoll->waiter_list_head)){
+        /* 只在调度循环中检查的epoll没有等待者，其他线程通知时需要打断空闲 */
+        if(epoll->idle_break)
+            eh_idle_break();
+        return ;
+    }
+    waiter = eh_list_entry(epoll->waiter_list_head.next, struct eh_epoll_waiter, list_node);
+    eh_list_del_init(&waiter->list_node);
+    eh_task_wake_up(waiter->task);
+}
+
 static void _eh_event_trigger_receptor_no_lock(struct eh_event_receptor *receptor){
     struct eh_event_epoll_receptor *epoll_receptor;
     if(receptor->wakeup_task)
             eh_task_wake_up(receptor->wakeup_task);
     if(receptor->epoll){
         epoll_receptor = eh_container_of(receptor, struct eh_event_epoll_receptor, receptor);
-        if(eh_list_empty(&epoll_receptor->pending_list_node))
+        /* 每新增一个待处理项只唤醒一个等待者，已在队列中的项不重复唤醒 */
+        if(eh_list_empty(&epoll_receptor->pending_list_node)){
             eh_list_add_tail(&epoll_receptor->pending_list_node, &receptor->epoll->pending_list_head);
-        if(receptor->epoll->wakeup_task)
-            eh_task_wake_up(receptor->epoll->wakeup_task);
+            _eh_epoll_wake_one_waiter_no_lock(receptor->epoll);
+        }
     }
 }
 
@@ -158,15 +180,52 @@ void eh_event_clean(eh_event_t *e){
 }
 
 
+static bool _eh_event_receptor_is_exclusive(struct eh_event_receptor *receptor){
+    return receptor->epoll && 
+        (eh_container_of(receptor, struct eh_event_epoll_receptor, receptor)->mode & EH_EPOLLEXCLUSIVE);
+}
+
+/**
+ * @brief 从start开始选出本次通知要唤醒的独占接收器
+ *        优先选择自身还不在所属epoll待处理链表上的接收器，
+ *        只检查该接收器本身，不检查epoll上是否有其他待处理事件；
+ *        都已在待处理链表上时返回start
+ */
+static struct eh_event_receptor* _eh_event_pick_exclusive_no_lock(eh_event_t *e, struct eh_event_receptor *start){
+    struct eh_event_receptor *pos = start;
+    if(eh_list_empty(&eh_container_of(start, struct eh_event_epoll_receptor, receptor)->pending_list_node))
+        return start;
+    eh_list_for_each_entry_continue(pos, &e->receptor_list_head, list_node){
+        if(!_eh_event_receptor_is_exclusive(pos))
+            continue;
+        if(eh_list_empty(&eh_container_of(pos, struct eh_event_epoll_receptor, receptor)->pending_list_node))
+            return pos;
+    }
+    return start;
+}
+
 int eh_event_notify(eh_event_t *e){
     eh_save_state_t state;
-    struct eh_event_receptor *pos;
+    struct eh_event_receptor *pos, *n, *exclusive = NULL;
+    bool exclusive_done = false;
     eh_param_assert(e);
     state = eh_enter_critical();
-    eh_list_for_each_entry(pos, &e->receptor_list_head, list_node){
+    eh_list_for_each_entry_safe(pos, n, &e->receptor_list_head, list_node){
+        if(_eh_event_receptor_is_exclusive(pos)){
+            if(exclusive_done)
+                continue;
+            exclusive_done = true;
+            exclusive = _eh_event_pick_exclusive_no_lock(e, pos);
+            exclusive->trigger = 1;
+            _eh_event_trigger_receptor_no_lock(exclusive);
+            continue;
+        }
         pos->trigger = 1;
         _eh_event_trigger_receptor_no_lock(pos);
     }
+    /* 被唤醒的独占接收器移到队尾，下次优先唤醒其他epoll */
+    if(exclusive)
+        eh_list_move_tail(&exclusive->list_node, &e->receptor_list_head);
     eh_exit_critical(state);
     return EH_RET_OK;
 }
@@ -234,7 +293,10 @@ eh_epoll_t eh_epoll_new(void){
     if( epoll == NULL )
         return eh_error_to_ptr(EH_RET_MALLOC_ERROR);
     eh_list_head_init(&epoll->pending_list_head);
+    eh_list_head_init(&epoll->all_receptor_list_head);
+    eh_list_head_init(&epoll->waiter_list_head);
     eh_rb_root_init(&epoll->all_receptor_tree, __epoll_rbtree_cmp);
+    epoll->idle_break = false;
     return (eh_epoll_t)epoll;
 }
 
@@ -243,15 +305,47 @@ void eh_epoll_del(eh_epoll_t _epoll){
     struct eh_epoll *epoll = (struct eh_epoll *)_epoll;
     eh_save_state_t state;
     state = eh_enter_critical();
-    eh_rb_postorder_for_each_entry_safe(pos, n, &epoll->all_receptor_tree, rb_node){
+    eh_list_for_each_entry_safe(pos, n, &epoll->all_receptor_list_head, epoll_list_node){
         eh_event_remove_receptor_no_lock(&pos->receptor);
+        eh_list_del_init(&pos->pending_list_node);
+        eh_list_del_init(&pos->epoll_list_node);
+        /* 在树上的节点是eh_epoll_add_event申请的，用户提供的节点只做分离 */
+        if(eh_rb_node_is_empty(&pos->rb_node)){
+            pos->receptor.epoll = NULL;
+            continue;
+        }
         eh_free(pos);
     }
     eh_exit_critical(state);
     eh_free(epoll);
 }
 
+static void _eh_epoll_node_init(struct eh_epoll *epoll, struct eh_event_epoll_receptor *receptor, 
+        eh_event_t *e, void *userdata, uint32_t mode, bool (*level_condition)(void *userdata)){
+    eh_event_receptor_epoll_init(&receptor->receptor, NULL, epoll);
+    eh_list_head_init(&receptor->pending_list_node);
+    eh_list_head_init(&receptor->epoll_list_node);
+    eh_rb_node_init(&receptor->rb_node);
+    receptor->event = e;
+    receptor->userdata = userdata;
+    receptor->mode = mode;
+    receptor->level_condition = level_condition;
+}
+
+static int _eh_epoll_mode_check(uint32_t mode, bool (*level_condition)(void *userdata)){
+    if(mode & ~(uint32_t)(EH_EPOLLLT | EH_EPOLLONESHOT | EH_EPOLLEXCLUSIVE))
+        return EH_RET_INVALID_PARAM;
+    if((mode & EH_EPOLLLT) && level_condition == NULL)
+        return EH_RET_INVALID_PARAM;
+    return EH_RET_OK;
+}
+
 int eh_epoll_add_event(eh_epoll_t _epoll, eh_event_t *e, void *userdata){
+    return eh_epoll_add_event_mode(_epoll, e, userdata, EH_EPOLLET, NULL);
+}
+
+int eh_epoll_add_event_mode(eh_epoll_t _epoll, eh_event_t *e, void *userdata, 
+        uint32_t mode, bool (*level_condition)(void *userdata)){
     eh_save_state_t state;
     int ret = EH_RET_OK;
     struct eh_rbtree_node  *ret_rb;
@@ -259,15 +353,14 @@ int eh_epoll_add_event(eh_epoll_t _epoll, eh_event_t *e, void *userdata){
     struct eh_event_epoll_receptor *receptor;
     eh_param_assert(_epoll);
     eh_param_assert(e);
+    ret = _eh_epoll_mode_check(mode, level_condition);
+    if(ret < 0)
+        return ret;
     
     receptor = eh_malloc(sizeof(struct eh_event_epoll_receptor));
     if( receptor == NULL )
         return EH_RET_MALLOC_ERROR;
-    eh_event_receptor_epoll_init(&receptor->receptor, NULL, epoll);
-    eh_list_head_init(&receptor->pending_list_node);
-    eh_rb_node_init(&receptor->rb_node);
-    receptor->event = e;
-    receptor->userdata = userdata;
+    _eh_epoll_node_init(epoll, receptor, e, userdata, mode, level_condition);
     state = eh_enter_critical();;
     /* 添加到epoll树中 */
     ret_rb = eh_rb_find_add(&receptor->rb_node, &epoll->all_receptor_tree);
@@ -276,6 +369,7 @@ int eh_epoll_add_event(eh_epoll_t _epoll, eh_event_t *e, void *userdata){
         ret = EH_RET_INVALID_PARAM;
         goto out;
     }
+    eh_list_add_tail(&receptor->epoll_list_node, &epoll->all_receptor_list_head);
     /* 添加接收器到event中 */
     eh_event_add_receptor_no_lock(e, &receptor->receptor);
 out:
@@ -283,6 +377,87 @@ out:
     return ret;
 }
 
+int eh_epoll_add_node(eh_epoll_t _epoll, eh_epoll_node_t *node, eh_event_t *e, void *userdata){
+    return eh_epoll_add_node_mode(_epoll, node, e, userdata, EH_EPOLLET, NULL);
+}
+
+int eh_epoll_add_node_mode(eh_epoll_t _epoll, eh_epoll_node_t *node, eh_event_t *e, void *userdata, 
+        uint32_t mode, bool (*level_condition)(void *userdata)){
+    eh_save_state_t state;
+    struct eh_epoll *epoll = (struct eh_epoll *)_epoll;
+    int ret;
+    eh_param_assert(_epoll);
+    eh_param_assert(node);
+    eh_param_assert(e);
+    ret = _eh_epoll_mode_check(mode, level_condition);
+    if(ret < 0)
+        return ret;
+
+    /* rb_node保持为空，以区分eh_epoll_add_event申请的节点 */
+    _eh_epoll_node_init(epoll, node, e, userdata, mode, level_condition);
+    state = eh_enter_critical();
+    eh_list_add_tail(&node->epoll_list_node, &epoll->all_receptor_list_head);
+    eh_event_add_receptor_no_lock(e, &node->receptor);
+    eh_exit_critical(state);
+    return EH_RET_OK;
+}
+
+static int _eh_epoll_rearm_no_lock(struct eh_epoll *epoll, struct eh_event_epoll_receptor *receptor){
+    if(receptor->receptor.epoll != epoll)
+        return EH_RET_INVALID_PARAM;
+    if(!(receptor->mode & EH_EPOLLONESHOT))
+        return EH_RET_INVALID_STATE;
+    if(eh_event_receptors_is_isolate(&receptor->receptor))
+        eh_event_add_receptor_no_lock(receptor->event, &receptor->receptor);
+    return EH_RET_OK;
+}
+
+int eh_epoll_rearm_node(eh_epoll_t _epoll, eh_epoll_node_t *node){
+    eh_save_state_t state;
+    int ret;
+    eh_param_assert(_epoll);
+    eh_param_assert(node);
+    state = eh_enter_critical();
+    ret = _eh_epoll_rearm_no_lock((struct eh_epoll *)_epoll, node);
+    eh_exit_critical(state);
+    return ret;
+}
+
+int eh_epoll_rearm_event(eh_epoll_t _epoll, eh_event_t *e){
+    eh_save_state_t state;
+    struct eh_event_epoll_receptor *epoll_receptor;
+    struct eh_epoll *epoll = (struct eh_epoll *)_epoll;
+    int ret;
+    eh_param_assert(_epoll);
+    eh_param_assert(e);
+    state = eh_enter_critical();
+    epoll_receptor = eh_rb_entry_safe(
+        eh_rb_match_find(e, &epoll->all_receptor_tree, __epoll_rbtree_match),
+        struct eh_event_epoll_receptor, rb_node );
+    ret = epoll_receptor ? _eh_epoll_rearm_no_lock(epoll, epoll_receptor) : EH_RET_INVALID_PARAM;
+    eh_exit_critical(state);
+    return ret;
+}
+
+int eh_epoll_del_node(eh_epoll_t _epoll, eh_epoll_node_t *node){
+    eh_save_state_t state;
+    struct eh_epoll *epoll = (struct eh_epoll *)_epoll;
+    eh_param_assert(_epoll);
+    eh_param_assert(node);
+
+    state = eh_enter_critical();
+    if(node->receptor.epoll != epoll || !eh_rb_node_is_empty(&node->rb_node)){
+        eh_exit_critical(state);
+        return EH_RET_INVALID_PARAM;
+    }
+    eh_event_remove_receptor_no_lock(&node->receptor);
+    eh_list_del_init(&node->pending_list_node);
+    eh_list_del_init(&node->epoll_list_node);
+    node->receptor.epoll = NULL;
+    eh_exit_critical(state);
+    return EH_RET_OK;
+}
+
 int eh_epoll_del_event(eh_epoll_t _epoll,eh_event_t *e){
     eh_save_state_t state;
     struct eh_event_epoll_receptor *epoll_receptor;
@@ -303,6 +478,7 @@ int eh_epoll_del_event(eh_epoll_t _epoll,eh_event_t *e){
     /* 从事件中删除接收器 */
     eh_event_remove_receptor_no_lock(&epoll_receptor->receptor);
     eh_list_del(&epoll_receptor->pending_list_node);
+    eh_list_del(&epoll_receptor->epoll_list_node);
     eh_rb_del(&epoll_receptor->rb_node, &epoll->all_receptor_tree);
     eh_exit_critical(state);
     eh_free(epoll_receptor);
@@ -311,39 +487,94 @@ int eh_epoll_del_event(eh_epoll_t _epoll,eh_event_t *e){
 
 static int _eh_epoll_pending_read_on_lock(struct eh_epoll *epoll, eh_epoll_slot_t *epool_slot, int slot_size){
     struct eh_event_epoll_receptor *pos, *n;
+    struct eh_list_head level_list_head;
     int slot_i=0;
+    eh_list_head_init(&level_list_head);
     eh_list_for_each_entry_safe(pos, n, &epoll->pending_list_head, pending_list_node){
         if(pos->receptor.flags == 0){
-            eh_list_del_init(&pos->pending_list_node);
-            break;
+            /* 水平触发的重复投递，事件已不再就绪时移出 */
+            if(!(pos->mode & EH_EPOLLLT) || !pos->level_condition(pos->userdata)){
+                eh_list_del_init(&pos->pending_list_node);
+                continue;
+            }
+            pos->receptor.trigger = 1;
         }
         epool_slot[slot_i].userdata = pos->userdata;
         epool_slot[slot_i].event = pos->event;
         epool_slot[slot_i].affair = pos->receptor.error ? EH_EPOLL_AFFAIR_ERROR : 
                                     pos->receptor.trigger ? EH_EPOLL_AFFAIR_EVENT_TRIGGER : EH_EPOLL_AFFAIR_ERROR;
+        if(pos->mode & EH_EPOLLONESHOT){
+            /* 解除监听，直到rearm */
+            eh_event_remove_receptor_no_lock(&pos->receptor);
+            eh_list_del_init(&pos->pending_list_node);
+        }else if((pos->mode & EH_EPOLLLT) && !pos->receptor.error){
+            /* 暂存，读取完后放到队尾，避免总是优先投递水平触发的事件 */
+            eh_list_move_tail(&pos->pending_list_node, &level_list_head);
+        }else{
+            eh_list_del_init(&pos->pending_list_node);
+        }
         pos->receptor.flags = 0;
-        eh_list_del_init(&pos->pending_list_node);
         if(++slot_i >= slot_size) break;
     }
+    /* 槽位不够没有读完时，把剩余的边沿/单次触发项交给下一个空闲等待者，
+       水平触发项在下一次等待时重新检查，唤醒其他等待者只会重复投递 */
+    if(slot_i){
+        eh_list_for_each_entry(pos, &epoll->pending_list_head, pending_list_node){
+            if(!(pos->mode & EH_EPOLLLT) || pos->receptor.error){
+                _eh_epoll_wake_one_waiter_no_lock(epoll);
+                break;
+            }
+        }
+    }
+    eh_list_splice(&level_list_head, epoll->pending_list_head.prev);
     return slot_i;
 }
 
+int eh_epoll_pending_read_event(eh_epoll_t _epoll, eh_event_t *e, eh_epoll_slot_t *epool_slot){
+    eh_save_state_t state;
+    struct eh_event_epoll_receptor *epoll_receptor;
+    struct eh_epoll *epoll = (struct eh_epoll *)_epoll;
+    int ret = 0;
+
+    state = eh_enter_critical();
+    epoll_receptor = eh_rb_entry_safe(
+        eh_rb_match_find(e, &epoll->all_receptor_tree, __epoll_rbtree_match),
+        struct eh_event_epoll_receptor, rb_node );
+    if(epoll_receptor == NULL || eh_list_empty(&epoll_receptor->pending_list_node) || epoll_receptor->receptor.flags == 0)
+        goto out;
+    epool_slot->userdata = epoll_receptor->userdata;
+    epool_slot->event = epoll_receptor->event;
+    epool_slot->affair = epoll_receptor->receptor.error ? EH_EPOLL_AFFAIR_ERROR : EH_EPOLL_AFFAIR_EVENT_TRIGGER;
+    eh_list_del_init(&epoll_receptor->pending_list_node);
+    epoll_receptor->receptor.flags = 0;
+    ret = 1;
+out:
+    eh_exit_critical(state);
+    return ret;
+}
+
 static int __async__ _eh_epoll_wait(struct eh_epoll *epoll, eh_epoll_slot_t *epool_slot, int slot_size){
     eh_save_state_t state;
+    struct eh_epoll_waiter waiter;
     int ret;
+    eh_list_head_init(&waiter.list_node);
+    waiter.task = eh_task_get_current();
     for(;;){
         state = eh_enter_critical();;
         ret = _eh_epoll_pending_read_on_lock(epoll, epool_slot, slot_size);
         if(ret != 0)
             goto unlock_exit;
+        /* 被唤醒后没抢到事件，重新排到空闲队列尾部 */
+        if(eh_list_empty(&waiter.list_node))
+            eh_list_add_tail(&waiter.list_node, &epoll->waiter_list_head);
         eh_task_set_current_state(EH_TASK_STATE_WAIT);
-        epoll->wakeup_task = eh_task_get_current();
         eh_exit_critical(state);
 
         __await__ eh_task_next();
     }
 
 unlock_exit:
+    eh_list_del_init(&waiter.list_node);
     eh_exit_critical(state);
     return ret;
 }
@@ -352,8 +583,11 @@ static int __async__ _eh_epoll_wait_timeout(struct eh_epoll *epoll, eh_epoll_slo
     eh_save_state_t state;
     eh_timer_event_t timeout_timer;
     struct eh_event_receptor receptor_timer;
+    struct eh_epoll_waiter waiter;
     int ret;
     
+    eh_list_head_init(&waiter.list_node);
+    waiter.task = eh_task_get_current();
     eh_event_receptor_init(&receptor_timer, eh_task_get_current());
     eh_timer_init(&timeout_timer);
     eh_timer_config_interval(&timeout_timer, timeout);
@@ -372,14 +606,16 @@ static int __async__ _eh_epoll_wait_timeout(struct eh_epoll *epoll, eh_epoll_slo
             ret = receptor_timer.trigger ? EH_RET_TIMEOUT : EH_RET_EVENT_ERROR;
             goto unlock_out;
         }
+        if(eh_list_empty(&waiter.list_node))
+            eh_list_add_tail(&waiter.list_node, &epoll->waiter_list_head);
         eh_task_set_current_state(EH_TASK_STATE_WAIT);
-        epoll->wakeup_task = eh_task_get_current();
         eh_exit_critical(state);
 
         __await__ eh_task_next();
     }
 
 unlock_out:
+    eh_list_del_init(&waiter.list_node);
     eh_exit_critical(state);
     eh_timer_stop(&timeout_timer);
     eh_event_remove_receptor_no_lock(&receptor_timer);
@@ -12,44 +12,150 @@
 #include "eh.h"
 #include "eh_event.h"
 #include "eh_event_cb.h"
+#include "eh_formatio.h"
+#include "eh_platform.h"
 #include "eh_interior.h"
 
 #define EH_EVENT_CB_EPOLL_SLOT_SIZE 8
-static eh_task_t *signal_dispose_task = NULL;
-static eh_epoll_t signal_dispose_epoll = NULL;
-static eh_epoll_slot_t epool_slot[EH_EVENT_CB_EPOLL_SLOT_SIZE];
+#define EH_EVENT_CB_LANE_NAME_SIZE  16
+
+#if defined(EH_CONFIG_EVENT_CALLBACK_LANE_BATCH_SIZE)
+#define EH_EVENT_CB_LANE_BATCH_SIZE_DEFAULT     EH_CONFIG_EVENT_CALLBACK_LANE_BATCH_SIZE
+#else
+#define EH_EVENT_CB_LANE_BATCH_SIZE_DEFAULT     EH_EVENT_CB_EPOLL_SLOT_SIZE
+#endif
+
+#if defined(EH_CONFIG_EVENT_CALLBACK_LANE_BATCH_SIZE_MAX)
+#define EH_EVENT_CB_LANE_BATCH_SIZE_MAX         EH_CONFIG_EVENT_CALLBACK_LANE_BATCH_SIZE_MAX
+#else
+#define EH_EVENT_CB_LANE_BATCH_SIZE_MAX         32
+#endif
+
+eh_static_assert(EH_EVENT_CB_LANE_BATCH_SIZE_DEFAULT >= 1 && 
+    EH_EVENT_CB_LANE_BATCH_SIZE_DEFAULT <= EH_EVENT_CB_LANE_BATCH_SIZE_MAX, "event_cb lane batch size out of range");
+
+struct eh_event_cb_lane{
+    eh_task_t                   *task;
+    eh_epoll_t                  epoll;
+    int                         batch_size;
+    eh_epoll_slot_t             slots[EH_EVENT_CB_LANE_BATCH_SIZE_MAX];
+};
+
+static struct eh_event_cb_lane signal_dispose_lanes[EH_EVENT_CB_LANE_CNT];
+static eh_epoll_t signal_deferred_epoll = NULL;
+
+static void _eh_event_cb_dispatch(eh_epoll_t epoll, eh_epoll_slot_t *slots, int n){
+    int i;
+    for(i=0;i<n;i++){
+        eh_event_cb_trigger_t *trigger = (eh_event_cb_trigger_t*)slots[i].userdata;
+        eh_event_cb_slot_t *slot,*next;
+        eh_event_t *e = slots[i].event;
+        if(slots[i].affair == EH_EPOLL_AFFAIR_ERROR || trigger == NULL){
+            eh_epoll_del_event(epoll, e);
+            continue;
+        }
+
+        eh_list_for_each_entry_safe(slot, next, &trigger->cb_head, cb_node){
+            if(slot->slot_function)
+                slot->slot_function(e, slot->slot_param);
+        }
+    }
+}
+
+/**
+ * @brief 是否有比lane优先级更高(编号更小)的通道还有待处理的事件，
+ *   有待处理事件的通道任务一定已被唤醒，让出后会先于lane运行
+ */
+static bool _eh_event_cb_higher_lane_pending(struct eh_event_cb_lane *lane){
+    struct eh_event_cb_lane *pos;
+    eh_save_state_t state;
+    bool pending = false;
+    state = eh_enter_critical();
+    for(pos = signal_dispose_lanes; pos < lane; pos++){
+        if(!eh_list_empty(&((struct eh_epoll *)pos->epoll)->pending_list_head)){
+            pending = true;
+            break;
+        }
+    }
+    eh_exit_critical(state);
+    return pending;
+}
+
 static int task_signal_dispose(void *arg)
 {
-    int ret,i;
-    (void) arg;
+    struct eh_event_cb_lane *lane = (struct eh_event_cb_lane *)arg;
+    int ret;
     while(1){
-        ret = eh_epoll_wait(signal_dispose_epoll, epool_slot, EH_EVENT_CB_EPOLL_SLOT_SIZE, EH_TIME_FOREVER);
+        ret = eh_epoll_wait(lane->epoll, lane->slots, lane->batch_size, EH_TIME_FOREVER);
         if(ret < 0)
             return ret;
-        for(i=0;i<ret;i++){
-            eh_event_cb_trigger_t *trigger = (eh_event_cb_trigger_t*)epool_slot[i].userdata;
-            eh_event_cb_slot_t *slot,*n;
-            eh_event_t *e = epool_slot[i].event;
-            if(epool_slot[i].affair == EH_EPOLL_AFFAIR_ERROR || trigger == NULL){
-                eh_epoll_del_event(signal_dispose_epoll, e);
-                continue;
-            }
-
-            eh_list_for_each_entry_safe(slot, n, &trigger->cb_head, cb_node){
-                if(slot->slot_function)
-                    slot->slot_function(e, slot->slot_param);
-            }
-        }
+        /* 同时被唤醒时，先让更高优先级的通道处理完 */
+        while(_eh_event_cb_higher_lane_pending(lane))
+            __await__ eh_task_yield();
+        _eh_event_cb_dispatch(lane->epoll, lane->slots, ret);
+        /* 低优先级通道每处理完一批就让出，被唤醒的0号通道(系统任务)会排在最前面先运行 */
+        if(lane != &signal_dispose_lanes[0])
+            __await__ eh_task_yield();
     }
 }
 
-int eh_event_cb_register(eh_event_t *e, eh_event_cb_trigger_t *trigger){
+int eh_event_cb_lane_set_batch_size(int lane, int batch_size){
+    if(lane < 0 || lane >= EH_EVENT_CB_LANE_CNT)
+        return EH_RET_INVALID_PARAM;
+    if(batch_size < 1 || batch_size > EH_EVENT_CB_LANE_BATCH_SIZE_MAX)
+        return EH_RET_INVALID_PARAM;
+    signal_dispose_lanes[lane].batch_size = batch_size;
+    return EH_RET_OK;
+}
+
+void eh_event_cb_deferred_dispatch(void){
+    /* 槽函数中可能再次触发DIRECT信号而重入，所以使用栈上的槽位 */
+    eh_epoll_slot_t slots[EH_EVENT_CB_EPOLL_SLOT_SIZE];
+    int ret;
+    for(;;){
+        ret = eh_epoll_wait(signal_deferred_epoll, slots, EH_EVENT_CB_EPOLL_SLOT_SIZE, 0);
+        if(ret <= 0)
+            return ;
+        _eh_event_cb_dispatch(signal_deferred_epoll, slots, ret);
+    }
+}
+
+void eh_event_cb_direct_dispatch(eh_event_t *e){
+    eh_epoll_slot_t slot;
+    if(eh_epoll_pending_read_event(signal_deferred_epoll, e, &slot) == 1)
+        _eh_event_cb_dispatch(signal_deferred_epoll, &slot, 1);
+}
+
+static void _eh_event_cb_deferred_poll(void *arg){
+    (void) arg;
+    eh_event_cb_deferred_dispatch();
+}
+
+static eh_loop_poll_task_t deferred_poll_task = {
+    .poll_task = _eh_event_cb_deferred_poll,
+    .arg = NULL,
+    .list_node = EH_LIST_HEAD_INIT(deferred_poll_task.list_node),
+};
+
+int eh_event_cb_register_lane(eh_event_t *e, eh_event_cb_trigger_t *trigger, int lane){
     eh_param_assert(trigger);
-    return eh_epoll_add_event(signal_dispose_epoll, e, (void*)trigger);
+    if(lane < 0 || lane >= EH_EVENT_CB_LANE_CNT)
+        return EH_RET_INVALID_PARAM;
+    if(trigger->mode == EH_EVENT_CB_MODE_TASK)
+        return eh_epoll_add_event(signal_dispose_lanes[lane].epoll, e, (void*)trigger);
+    return eh_epoll_add_event(signal_deferred_epoll, e, (void*)trigger);
+}
+
+int eh_event_cb_register(eh_event_t *e, eh_event_cb_trigger_t *trigger){
+    return eh_event_cb_register_lane(e, trigger, 0);
 }
 
 int eh_event_cb_unregister(eh_event_t *e){
-    return eh_epoll_del_event(signal_dispose_epoll, e);
+    for(int i = 0; i < EH_EVENT_CB_LANE_CNT; i++){
+        if(eh_epoll_del_event(signal_dispose_lanes[i].epoll, e) == EH_RET_OK)
+            return EH_RET_OK;
+    }
+    return eh_epoll_del_event(signal_deferred_epoll, e);
 }
 int eh_event_cb_connect(eh_event_cb_trigger_t *trigger, eh_event_cb_slot_t *slot){
     eh_param_assert(trigger);
@@ -67,31 +173,63 @@ void eh_event_cb_disconnect(eh_event_cb_slot_t *slot){
 
 void eh_event_cb_trigger_clean(eh_event_cb_trigger_t *trigger){
     eh_event_cb_slot_t *slot,*n;
-    if(trigger) return ;
+    if(!trigger) return ;
     eh_list_for_each_entry_safe(slot, n, &trigger->cb_head, cb_node)
         eh_event_cb_disconnect(slot);
 }
+static void _eh_event_cb_lane_exit(int lane_cnt){
+    for(int i = 0; i < lane_cnt; i++){
+        eh_epoll_del(signal_dispose_lanes[i].epoll);
+        eh_task_destroy(signal_dispose_lanes[i].task);
+    }
+}
+
 static int __init eh_event_cb_init(void)
 {
     int ret = EH_RET_OK;
-    signal_dispose_task = eh_task_create("event_cb", EH_TASK_FLAGS_SYSTEM_TASK, EH_CONFIG_EVENT_CALLBACK_FUNCTION_STACK_SIZE, NULL, task_signal_dispose);
-    if(eh_ptr_to_error(signal_dispose_task) < 0)
-        return eh_ptr_to_error(signal_dispose_task);
-    signal_dispose_epoll = eh_epoll_new();
-    if(eh_ptr_to_error(signal_dispose_epoll) < 0){
-        ret = eh_ptr_to_error(signal_dispose_epoll);
-        goto eh_epoll_new_error;
+    int i;
+    struct eh_event_cb_lane *lane;
+    char name[EH_EVENT_CB_LANE_NAME_SIZE];
+    for(i = 0; i < EH_EVENT_CB_LANE_CNT; i++){
+        lane = &signal_dispose_lanes[i];
+        lane->batch_size = EH_EVENT_CB_LANE_BATCH_SIZE_DEFAULT;
+        lane->epoll = eh_epoll_new();
+        if(eh_ptr_to_error(lane->epoll) < 0){
+            ret = eh_ptr_to_error(lane->epoll);
+            goto lane_error;
+        }
+        /* 0号通道为系统任务，被唤醒时优先调度，其他通道之间按编号让出 */
+        if(i == 0)
+            eh_snprintf(name, sizeof(name), "event_cb");
+        else
+            eh_snprintf(name, sizeof(name), "event_cb_lane%d", i);
+        lane->task = eh_task_create(name, i == 0 ? EH_TASK_FLAGS_SYSTEM_TASK : 0, 
+            EH_CONFIG_EVENT_CALLBACK_FUNCTION_STACK_SIZE, lane, task_signal_dispose);
+        if(eh_ptr_to_error(lane->task) < 0){
+            ret = eh_ptr_to_error(lane->task);
+            eh_epoll_del(lane->epoll);
+            goto lane_error;
+        }
+    }
+    signal_deferred_epoll = eh_epoll_new();
+    if(eh_ptr_to_error(signal_deferred_epoll) < 0){
+        ret = eh_ptr_to_error(signal_deferred_epoll);
+        goto lane_error;
     }
+    /* 延迟epoll只在eh_poll中检查，其他线程的通知需要打断空闲 */
+    ((struct eh_epoll *)signal_deferred_epoll)->idle_break = true;
+    eh_loop_poll_task_add(&deferred_poll_task);
     return ret;
-eh_epoll_new_error:
-    eh_task_destroy(signal_dispose_task);
+lane_error:
+    _eh_event_cb_lane_exit(i);
     return ret;
 }
 
 static void __exit eh_event_cb_exit(void)
 {
-    eh_epoll_del(signal_dispose_epoll);
-    eh_task_destroy(signal_dispose_task);
+    eh_loop_poll_task_del(&deferred_poll_task);
+    eh_epoll_del(signal_deferred_epoll);
+    _eh_event_cb_lane_exit(EH_EVENT_CB_LANE_CNT);
 }
 
 
@@ -23,21 +23,18 @@
 #include "eh_mem.h"
 #include "eh_platform.h"
 #include "eh_interior.h"
+#include "eh_waitq.h"
 #include "eh_mutex.h"
 
 #define EH_MUTEX_LOCK_CNT_MAX   0xFFFFFFFF
 struct eh_mutex {
-    eh_event_t                  wakeup_event;
+    eh_waitq_t                  waitq;
     uint32_t                    lock_cnt;
+    uint32_t                    wait_cnt;           /* 无等待者时解锁不需要访问等待队列 */
     enum eh_mutex_type          type;
     eh_task_t                   *lock_task;
 };
 
-static bool condition_mutex(void *arg){
-    struct eh_mutex *mutex = (struct eh_mutex *)arg;
-    return mutex->lock_cnt == 0 || (mutex->type == EH_MUTEX_TYPE_RECURSIVE && mutex->lock_task == eh_task_self());
-}
-
 eh_mutex_t eh_mutex_create(enum eh_mutex_type type){
     struct eh_mutex *new_mutex;
 
@@ -48,25 +45,42 @@ eh_mutex_t eh_mutex_create(enum eh_mutex_type type){
     if( new_mutex == NULL )
         return eh_error_to_ptr(EH_RET_MALLOC_ERROR);
     new_mutex->lock_cnt = 0;
+    new_mutex->wait_cnt = 0;
     new_mutex->type = type;
-    eh_event_init(&new_mutex->wakeup_event);
+    new_mutex->lock_task = NULL;
+    eh_waitq_init(&new_mutex->waitq);
     return (eh_mutex_t)new_mutex;
 }
 void eh_mutex_destroy(eh_mutex_t _mutex){
     struct eh_mutex *mutex = (struct eh_mutex *)_mutex;
-    eh_event_clean(&mutex->wakeup_event);
+    eh_waitq_clean(&mutex->waitq);
     eh_free(mutex);
 }
 int __async__ eh_mutex_lock(eh_mutex_t _mutex, eh_sclock_t timeout){
     struct eh_mutex *mutex = (struct eh_mutex *)_mutex;
+    eh_task_t *self = eh_task_self();
     int ret;
-    ret = __await__ eh_event_wait_condition_timeout(&mutex->wakeup_event, mutex, condition_mutex, timeout);
+    if(mutex->lock_cnt == 0){
+        mutex->lock_task = self;
+        mutex->lock_cnt = 1;
+        return EH_RET_OK;
+    }
+    if(mutex->type == EH_MUTEX_TYPE_RECURSIVE && mutex->lock_task == self){
+        if( mutex->lock_cnt == EH_MUTEX_LOCK_CNT_MAX )
+            return EH_RET_INVALID_STATE;
+        mutex->lock_cnt++;
+        return EH_RET_OK;
+    }
+    mutex->wait_cnt++;
+    ret = __await__ eh_waitq_wait(&mutex->waitq, 0, NULL, timeout);
+    /* 锁已被销毁，不能再访问mutex */
+    if(ret == EH_RET_EVENT_ERROR)
+        return ret;
+    mutex->wait_cnt--;
     if(ret < 0)
         return ret;
-    if( mutex->lock_cnt == EH_MUTEX_LOCK_CNT_MAX )
-        return EH_RET_INVALID_STATE;
-    mutex->lock_task = eh_task_self();
-    mutex->lock_cnt++;
+    /* 解锁者已经将锁直接交给了本任务，lock_cnt已经为1 */
+    mutex->lock_task = self;
     return EH_RET_OK;
 }
 int eh_mutex_unlock(eh_mutex_t _mutex){
@@ -80,12 +94,10 @@ int eh_mutex_unlock(eh_mutex_t _mutex){
     mutex->lock_cnt--;
     if(mutex->lock_cnt)
         return EH_RET_OK;
-    return eh_event_notify_and_reorder(&mutex->wakeup_event, 1);
+    if(mutex->wait_cnt && eh_waitq_wake(&mutex->waitq, EH_WAITQ_KEY_ANY, 1, NULL) == 1){
+        /* 直接移交给第一个等待者，在它运行之前其他任务无法抢到锁 */
+        mutex->lock_cnt = 1;
+        mutex->lock_task = NULL;
+    }
+    return EH_RET_OK;
 }
-
-
-
-
-
-
-
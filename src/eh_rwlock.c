@@ -0,0 +1,139 @@
+/**
+ * @file eh_rwlock.c
+ * @brief 任务读写锁的实现，读者和写者分别在不同的事件上等待，
+ *    这样写锁释放时可以一次性唤醒全部读者，或只唤醒一个写者。
+ *      使用限制: 此模块所有的函数都只能在协程上下文中使用，
+ *      也就是说，不要在中断上下文，或者其他线程上下文中调用本函数
+ * @author simon.xiaoapeng (simon.xiaoapeng@gmail.com)
+ * @version 1.0
+ * @date 2024-08-10
+ * 
+ * @copyright Copyright (c) 2024  simon.xiaoapeng@gmail.com
+ * 
+ * @par 修改日志:
+ */
+
+#include <stdint.h>
+#include "eh.h"
+#include "eh_error.h"
+#include "eh_event.h"
+#include "eh_mem.h"
+#include "eh_platform.h"
+#include "eh_interior.h"
+#include "eh_rwlock.h"
+
+struct eh_rwlock {
+    eh_event_t                  reader_event;
+    eh_event_t                  writer_event;
+    uint32_t                    reader_cnt;
+    uint32_t                    writer_wait_cnt;
+    enum eh_rwlock_type         type;
+    eh_task_t                   *writer;
+};
+
+static bool condition_rdlock(void *arg){
+    struct eh_rwlock *rwlock = (struct eh_rwlock *)arg;
+    if(rwlock->writer)
+        return false;
+    return rwlock->type != EH_RWLOCK_TYPE_WRITER_PREFER || rwlock->writer_wait_cnt == 0;
+}
+
+static bool condition_wrlock(void *arg){
+    struct eh_rwlock *rwlock = (struct eh_rwlock *)arg;
+    return rwlock->writer == NULL && rwlock->reader_cnt == 0;
+}
+
+static bool _eh_rwlock_has_waiter(eh_event_t *e){
+    eh_save_state_t state;
+    bool ret;
+    state = eh_enter_critical();
+    ret = !eh_list_empty(&e->receptor_list_head);
+    eh_exit_critical(state);
+    return ret;
+}
+
+/* 锁完全释放后，根据策略唤醒读者或写者 */
+static int _eh_rwlock_wakeup(struct eh_rwlock *rwlock){
+    bool reader_wait = _eh_rwlock_has_waiter(&rwlock->reader_event);
+    bool writer_wait = rwlock->writer_wait_cnt != 0;
+    if(reader_wait && (!writer_wait || rwlock->type != EH_RWLOCK_TYPE_WRITER_PREFER))
+        return eh_event_notify(&rwlock->reader_event);
+    if(writer_wait)
+        return eh_event_notify_and_reorder(&rwlock->writer_event, 1);
+    return EH_RET_OK;
+}
+
+eh_rwlock_t eh_rwlock_create(enum eh_rwlock_type type){
+    struct eh_rwlock *new_rwlock;
+
+    if( type >= EH_RWLOCK_TYPE_MAX)
+        return eh_error_to_ptr(EH_RET_INVALID_PARAM);
+
+    new_rwlock = eh_malloc(sizeof(struct eh_rwlock));
+    if( new_rwlock == NULL )
+        return eh_error_to_ptr(EH_RET_MALLOC_ERROR);
+    new_rwlock->reader_cnt = 0;
+    new_rwlock->writer_wait_cnt = 0;
+    new_rwlock->type = type;
+    new_rwlock->writer = NULL;
+    eh_event_init(&new_rwlock->reader_event);
+    eh_event_init(&new_rwlock->writer_event);
+    return (eh_rwlock_t)new_rwlock;
+}
+
+void eh_rwlock_destroy(eh_rwlock_t _rwlock){
+    struct eh_rwlock *rwlock = (struct eh_rwlock *)_rwlock;
+    eh_event_clean(&rwlock->reader_event);
+    eh_event_clean(&rwlock->writer_event);
+    eh_free(rwlock);
+}
+
+int __async__ eh_rwlock_rdlock(eh_rwlock_t _rwlock, eh_sclock_t timeout){
+    struct eh_rwlock *rwlock = (struct eh_rwlock *)_rwlock;
+    int ret;
+    ret = __await__ eh_event_wait_condition_timeout(&rwlock->reader_event, rwlock, condition_rdlock, timeout);
+    if(ret < 0)
+        return ret;
+    rwlock->reader_cnt++;
+    return EH_RET_OK;
+}
+
+int __async__ eh_rwlock_wrlock(eh_rwlock_t _rwlock, eh_sclock_t timeout){
+    struct eh_rwlock *rwlock = (struct eh_rwlock *)_rwlock;
+    int ret;
+    if(condition_wrlock(rwlock)){
+        rwlock->writer = eh_task_self();
+        return EH_RET_OK;
+    }
+    rwlock->writer_wait_cnt++;
+    ret = __await__ eh_event_wait_condition_timeout(&rwlock->writer_event, rwlock, condition_wrlock, timeout);
+    /* 锁已被销毁，不能再访问rwlock */
+    if(ret == EH_RET_EVENT_ERROR)
+        return ret;
+    rwlock->writer_wait_cnt--;
+    if(ret < 0){
+        /* 写者优先时，等待超时的写者可能挡住了读者 */
+        if(rwlock->writer_wait_cnt == 0 && rwlock->writer == NULL && 
+            rwlock->type == EH_RWLOCK_TYPE_WRITER_PREFER)
+            eh_event_notify(&rwlock->reader_event);
+        return ret;
+    }
+    rwlock->writer = eh_task_self();
+    return EH_RET_OK;
+}
+
+int eh_rwlock_unlock(eh_rwlock_t _rwlock){
+    struct eh_rwlock *rwlock = (struct eh_rwlock *)_rwlock;
+    if(rwlock->writer){
+        if(rwlock->writer != eh_task_self())
+            return EH_RET_INVALID_STATE;
+        rwlock->writer = NULL;
+        return _eh_rwlock_wakeup(rwlock);
+    }
+    if(rwlock->reader_cnt == 0)
+        return EH_RET_INVALID_STATE;
+    rwlock->reader_cnt--;
+    if(rwlock->reader_cnt)
+        return EH_RET_OK;
+    return _eh_rwlock_wakeup(rwlock);
+}
@@ -14,28 +14,38 @@
  */
 
 
+#include <stdbool.h>
+#include <stdatomic.h>
 #include "eh.h"
 #include "eh_event.h"
 #include "eh_mem.h"
 #include "eh_platform.h"
 #include "eh_interior.h"
+#include "eh_waitq.h"
 #include "eh_sem.h"
-#include <stdbool.h>
 
 struct eh_sem {
-    eh_event_t                  wakeup_event;
+    eh_waitq_t                  waitq;
     /**
-     * @brief 从线程上考虑，读者（P操作）永远只有一个，就是协程上下文，
-     *   写者(V操作)可能有多个，那么只需对V操作进行加锁，将PV变量分开，
-     *   可以得到更好的性能
+     * @brief P操作在无竞争时只需一次CAS，V操作在没有等待者时
+     *   也无需进入临界区，有等待者时V操作直接将计数移交给队首的等待者，
+     *   被唤醒的任务醒来时已经持有信号量，不会被其他任务抢走后再次睡眠
      */
-    uint32_t                    sem_num_p; /* wait */
-    uint32_t                    sem_num_v; /* post */
+    atomic_uint                 value;
+    atomic_uint                 wait_cnt;
 };
 
+static bool _eh_sem_try_take(struct eh_sem *sem){
+    unsigned int value = atomic_load(&sem->value);
+    while(value){
+        if(atomic_compare_exchange_weak(&sem->value, &value, value - 1))
+            return true;
+    }
+    return false;
+}
+
 static bool condition_sem(void *arg){
-    struct eh_sem *sem = (struct eh_sem *)arg;
-    return !(sem->sem_num_p == sem->sem_num_v) ;
+    return _eh_sem_try_take((struct eh_sem *)arg);
 }
 
 eh_sem_t eh_sem_create(uint32_t value){
@@ -43,15 +53,15 @@ eh_sem_t eh_sem_create(uint32_t value){
     new_sem = (struct eh_sem *)eh_malloc(sizeof(struct eh_sem));
     if( new_sem == NULL )
         return eh_error_to_ptr(EH_RET_MALLOC_ERROR);
-    new_sem->sem_num_v = value;
-    new_sem->sem_num_p = 0;
-    eh_event_init(&new_sem->wakeup_event);
+    atomic_init(&new_sem->value, value);
+    atomic_init(&new_sem->wait_cnt, 0);
+    eh_waitq_init(&new_sem->waitq);
     return (eh_sem_t)new_sem;
 }
 
 void eh_sem_destroy(eh_sem_t _sem){
     struct eh_sem *sem = (struct eh_sem *)_sem;
-    eh_event_clean(&sem->wakeup_event);
+    eh_waitq_clean(&sem->waitq);
     eh_free(sem);
 }
 
@@ -59,30 +69,34 @@ void eh_sem_destroy(eh_sem_t _sem){
 int eh_sem_wait(eh_sem_t _sem, eh_sclock_t timeout){
     struct eh_sem *sem = (struct eh_sem *)_sem;
     int ret;
-    ret = __await__ eh_event_wait_condition_timeout(&sem->wakeup_event, sem, condition_sem, timeout);
-    if(ret < 0)
+    if(_eh_sem_try_take(sem))
+        return EH_RET_OK;
+    /* 先登记等待者再检查计数，与post中先加计数再检查等待者配对，不会丢失唤醒 */
+    atomic_fetch_add(&sem->wait_cnt, 1);
+    ret = __await__ eh_waitq_wait_condition(&sem->waitq, 0, condition_sem, sem, NULL, timeout);
+    /* 信号量已被销毁，不能再访问sem */
+    if(ret == EH_RET_EVENT_ERROR)
         return ret;
-    sem->sem_num_p++;
-    return EH_RET_OK;
+    atomic_fetch_sub(&sem->wait_cnt, 1);
+    return ret;
 }
 
 int eh_sem_post(eh_sem_t _sem){
     struct eh_sem *sem = (struct eh_sem *)_sem;
-    int ret = EH_RET_OK;
+    unsigned int value = atomic_load(&sem->value);
     eh_save_state_t state;
-    state = eh_enter_critical();;
-    if(sem->sem_num_v + 1 == sem->sem_num_p){
-        ret = EH_RET_BUSY;
-        goto out;
-    }
-    sem->sem_num_v++;
-    ret = eh_event_notify_and_reorder(&sem->wakeup_event, 1);
-out:
-    eh_exit_critical(state);
-    return ret;
-}
-
-
-
+    do{
+        if(value == UINT32_MAX)
+            return EH_RET_BUSY;
+    }while(!atomic_compare_exchange_weak(&sem->value, &value, value + 1));
 
+    if(atomic_load(&sem->wait_cnt) == 0)
+        return EH_RET_OK;
 
+    state = eh_enter_critical();
+    /* 从计数中取出一个直接交给队首等待者 */
+    if(eh_waitq_has_waiter(&sem->waitq) && _eh_sem_try_take(sem))
+        eh_waitq_wake(&sem->waitq, EH_WAITQ_KEY_ANY, 1, NULL);
+    eh_exit_critical(state);
+    return EH_RET_OK;
+}
@@ -0,0 +1,223 @@
+/**
+ * @file eh_signal_queue.c
+ * @brief 排队信号的实现，内部使用一个普通的事件触发器和一个分发槽，
+ *    分发槽每次取出一批负载，依次交给用户连接的槽，再统一释放，
+ *    只有队列由空变为非空时才通知事件，一批处理完后还有剩余负载时再次通知。
+ * @author simon.xiaoapeng (simon.xiaoapeng@gmail.com)
+ * @version 1.0
+ * @date 2024-08-18
+ *
+ * @copyright Copyright (c) 2024  simon.xiaoapeng@gmail.com
+ *
+ * @par 修改日志:
+ */
+
+#include <string.h>
+#include "eh.h"
+#include "eh_error.h"
+#include "eh_event.h"
+#include "eh_event_cb.h"
+#include "eh_mem.h"
+#include "eh_platform.h"
+#include "eh_signal_queue.h"
+
+struct eh_signal_queue_entry {
+    uint32_t                    len;
+    union{
+        uint8_t                 inline_buf[EH_SIGNAL_QUEUE_INLINE_SIZE];
+        void                    *pool_buf;
+    };
+};
+
+struct eh_signal_queue {
+    eh_event_cb_trigger_t       trigger;
+    eh_event_t                  event;
+    eh_event_cb_slot_t          dispatch_slot;          /* 唯一连接在trigger上的槽，负责按批分发 */
+    struct eh_list_head         slot_head;              /* 用户连接的槽 */
+    struct eh_signal_queue_entry *entries;
+    uint32_t                    capacity;
+    uint32_t                    r;
+    uint32_t                    cnt;
+    uint32_t                    max_payload_size;
+    uint32_t                    dropped;
+    void                        *pool_free;             /* 空闲内存块链表，块的前sizeof(void*)字节存放下一个空闲块 */
+    int                         batch_cnt;
+    eh_signal_payload_t         batch[EH_SIGNAL_QUEUE_BATCH_SIZE];
+};
+
+#define eh_signal_queue_entry(sq, pos)      (&(sq)->entries[(pos) % (sq)->capacity])
+
+static const void* _eh_signal_queue_entry_buf(struct eh_signal_queue_entry *entry){
+    return entry->len > EH_SIGNAL_QUEUE_INLINE_SIZE ? entry->pool_buf : entry->inline_buf;
+}
+
+static void _eh_signal_queue_dispatch(eh_event_t *e, void *slot_param){
+    eh_signal_queue_t *sq = (eh_signal_queue_t *)slot_param;
+    struct eh_signal_queue_entry *entry;
+    eh_event_cb_slot_t *slot, *next;
+    eh_save_state_t state;
+    uint32_t i, n, remaining;
+
+    /* DIRECT模式下槽函数中再次触发本信号会重入，当前批次未释放，交给外层处理 */
+    if(sq->batch_cnt)
+        return ;
+    /* 生产者只会写入[r+cnt, r+capacity)范围，取出的这一批在释放前不会被改动 */
+    state = eh_enter_critical();
+    n = sq->cnt < EH_SIGNAL_QUEUE_BATCH_SIZE ? sq->cnt : EH_SIGNAL_QUEUE_BATCH_SIZE;
+    for(i = 0; i < n; i++){
+        entry = eh_signal_queue_entry(sq, sq->r + i);
+        sq->batch[i].buf = _eh_signal_queue_entry_buf(entry);
+        sq->batch[i].len = entry->len;
+    }
+    eh_exit_critical(state);
+    if(n == 0)
+        return ;
+
+    sq->batch_cnt = (int)n;
+    eh_list_for_each_entry_safe(slot, next, &sq->slot_head, cb_node){
+        if(slot->slot_function)
+            slot->slot_function(e, slot->slot_param);
+    }
+    sq->batch_cnt = 0;
+
+    state = eh_enter_critical();
+    for(i = 0; i < n; i++){
+        entry = eh_signal_queue_entry(sq, sq->r + i);
+        if(entry->len > EH_SIGNAL_QUEUE_INLINE_SIZE){
+            *(void**)entry->pool_buf = sq->pool_free;
+            sq->pool_free = entry->pool_buf;
+        }
+    }
+    sq->r = (sq->r + n) % sq->capacity;
+    sq->cnt -= n;
+    remaining = sq->cnt;
+    eh_exit_critical(state);
+
+    /* 每次只分发一批，剩余的负载重新排队，不长时间占用调度通道 */
+    if(remaining)
+        eh_event_notify(&sq->event);
+}
+
+eh_signal_queue_t* eh_signal_queue_create(uint32_t capacity, uint32_t max_payload_size, uint32_t pool_cnt){
+    eh_signal_queue_t *sq;
+    size_t block_size = 0, size;
+    uint8_t *pool;
+    uint32_t i;
+
+    if(capacity == 0 || max_payload_size == 0)
+        return eh_error_to_ptr(EH_RET_INVALID_PARAM);
+    if(max_payload_size <= EH_SIGNAL_QUEUE_INLINE_SIZE){
+        pool_cnt = 0;
+    }else{
+        if(pool_cnt == 0)
+            return eh_error_to_ptr(EH_RET_INVALID_PARAM);
+        block_size = (max_payload_size + sizeof(void*) - 1) & ~(sizeof(void*) - 1);
+    }
+    size = sizeof(eh_signal_queue_t) + sizeof(struct eh_signal_queue_entry) * capacity + block_size * pool_cnt;
+    sq = eh_malloc(size);
+    if(sq == NULL)
+        return eh_error_to_ptr(EH_RET_MALLOC_ERROR);
+    eh_event_cb_trigger_init(&sq->trigger);
+    eh_event_init(&sq->event);
+    eh_event_cb_slot_init(&sq->dispatch_slot, _eh_signal_queue_dispatch, sq);
+    eh_event_cb_connect(&sq->trigger, &sq->dispatch_slot);
+    eh_list_head_init(&sq->slot_head);
+    sq->entries = (struct eh_signal_queue_entry *)(sq + 1);
+    sq->capacity = capacity;
+    sq->r = 0;
+    sq->cnt = 0;
+    sq->max_payload_size = max_payload_size;
+    sq->dropped = 0;
+    sq->pool_free = NULL;
+    sq->batch_cnt = 0;
+    pool = (uint8_t*)(sq->entries + capacity);
+    for(i = 0; i < pool_cnt; i++){
+        *(void**)(pool + block_size * i) = sq->pool_free;
+        sq->pool_free = pool + block_size * i;
+    }
+    return sq;
+}
+
+void eh_signal_queue_destroy(eh_signal_queue_t *sq){
+    eh_event_cb_slot_t *slot, *n;
+    eh_event_cb_unregister(&sq->event);
+    eh_list_for_each_entry_safe(slot, n, &sq->slot_head, cb_node)
+        eh_event_cb_disconnect(slot);
+    eh_event_cb_trigger_clean(&sq->trigger);
+    eh_event_clean(&sq->event);
+    eh_free(sq);
+}
+
+void eh_signal_queue_set_mode(eh_signal_queue_t *sq, enum eh_event_cb_mode mode){
+    eh_event_cb_trigger_set_mode(&sq->trigger, mode);
+}
+
+int eh_signal_queue_register_lane(eh_signal_queue_t *sq, int lane){
+    int ret;
+    eh_param_assert(sq);
+    ret = eh_event_cb_register_lane(&sq->event, &sq->trigger, lane);
+    /* 注销期间入队的负载不会再触发事件，注册后补一次通知 */
+    if(ret == EH_RET_OK && sq->cnt)
+        eh_event_notify(&sq->event);
+    return ret;
+}
+
+int eh_signal_queue_unregister(eh_signal_queue_t *sq){
+    eh_param_assert(sq);
+    return eh_event_cb_unregister(&sq->event);
+}
+
+int eh_signal_queue_slot_connect(eh_signal_queue_t *sq, eh_signal_slot_t *slot){
+    eh_param_assert(sq);
+    eh_param_assert(slot);
+    if(!eh_list_empty(&slot->cb_node))
+        return EH_RET_BUSY;
+    eh_list_add_tail(&slot->cb_node, &sq->slot_head);
+    return EH_RET_OK;
+}
+
+int eh_signal_queue_notify(eh_signal_queue_t *sq, const void *payload, uint32_t len){
+    struct eh_signal_queue_entry *entry;
+    eh_save_state_t state;
+    uint8_t *buf;
+    bool was_empty;
+
+    eh_param_assert(sq);
+    if(len > sq->max_payload_size || (len && payload == NULL))
+        return EH_RET_INVALID_PARAM;
+    state = eh_enter_critical();
+    if(sq->cnt == sq->capacity)
+        goto busy;
+    entry = eh_signal_queue_entry(sq, sq->r + sq->cnt);
+    if(len > EH_SIGNAL_QUEUE_INLINE_SIZE){
+        if(sq->pool_free == NULL)
+            goto busy;
+        entry->pool_buf = sq->pool_free;
+        sq->pool_free = *(void**)sq->pool_free;
+        buf = entry->pool_buf;
+    }else{
+        buf = entry->inline_buf;
+    }
+    if(len)
+        memcpy(buf, payload, len);
+    entry->len = len;
+    was_empty = sq->cnt == 0;
+    sq->cnt++;
+    eh_exit_critical(state);
+    if(!was_empty)
+        return EH_RET_OK;
+    return eh_event_cb_notify(&sq->event, &sq->trigger);
+busy:
+    sq->dropped++;
+    eh_exit_critical(state);
+    return EH_RET_BUSY;
+}
+
+int eh_signal_queue_batch(eh_signal_queue_t *sq, const eh_signal_payload_t **payloads){
+    *payloads = sq->batch;
+    return sq->batch_cnt;
+}
+
+uint32_t eh_signal_queue_dropped(eh_signal_queue_t *sq){
+    return sq->dropped;
+}
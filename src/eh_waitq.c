@@ -0,0 +1,183 @@
+/**
+ * @file eh_waitq.c
+ * @brief 带键值的等待队列实现，等待者以事件接收器的形式挂在队列的事件上，
+ *    唤醒者在临界区内完成匹配，将匹配的接收器移到交接链表后再唤醒对应任务，
+ *    等待者运行时自己离开交接链表，在此之前清除队列会将其标记为错误
+ * @author simon.xiaoapeng (simon.xiaoapeng@gmail.com)
+ * @version 1.0
+ * @date 2024-08-12
+ * 
+ * @copyright Copyright (c) 2024  simon.xiaoapeng@gmail.com
+ * 
+ * @par 修改日志:
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "eh.h"
+#include "eh_error.h"
+#include "eh_event.h"
+#include "eh_platform.h"
+#include "eh_interior.h"
+#include "eh_timer.h"
+#include "eh_waitq.h"
+
+struct eh_waitq_waiter{
+    struct eh_event_receptor            receptor;
+    uintptr_t                           key;
+    bool                                (*match)(void *match_arg, uintptr_t key);
+    void                                *match_arg;
+    void                                *value;
+};
+
+static bool _eh_waitq_waiter_is_match(struct eh_waitq_waiter *waiter, uintptr_t key){
+    if(key == EH_WAITQ_KEY_ANY)
+        return true;
+    if(waiter->match)
+        return waiter->match(waiter->match_arg, key);
+    return waiter->key == key;
+}
+
+static int __async__ _eh_waitq_wait(eh_waitq_t *wq, struct eh_waitq_waiter *waiter, 
+        bool (*condition)(void *arg), void *arg, void **value, eh_sclock_t timeout){
+    eh_save_state_t state;
+    eh_timer_event_t timeout_timer;
+    struct eh_event_receptor receptor_timer;
+    int ret;
+
+    if(timeout == 0){
+        if(condition){
+            state = eh_enter_critical();
+            ret = condition(arg) ? EH_RET_OK : EH_RET_TIMEOUT;
+            eh_exit_critical(state);
+            return ret;
+        }
+        return EH_RET_TIMEOUT;
+    }
+
+    eh_event_receptor_init(&waiter->receptor, eh_task_get_current());
+    waiter->value = NULL;
+
+    eh_event_receptor_init(&receptor_timer, eh_task_get_current());
+    if(!eh_time_is_forever(timeout)){
+        eh_timer_init(&timeout_timer);
+        eh_timer_config_interval(&timeout_timer, timeout);
+        /* timer没有start前，可以无锁add */
+        eh_event_add_receptor_no_lock(eh_timer_to_event(&timeout_timer), &receptor_timer);
+        eh_timer_start(&timeout_timer);
+    }
+
+    state = eh_enter_critical();
+    /* 与加入队列在同一个临界区内检查，避免唤醒者在两者之间错过本等待者 */
+    if(condition && condition(arg)){
+        waiter->value = NULL;
+        ret = EH_RET_OK;
+        goto unlock_out;
+    }
+    eh_event_add_receptor_no_lock(&wq->event, &waiter->receptor);
+    eh_exit_critical(state);
+
+    for(;;){
+        state = eh_enter_critical();
+        /* 队列已被清除时即使已经移交了所有权也返回错误，否则唤醒者已经移交了所有权，即使同时超时也视为成功 */
+        if(waiter->receptor.flags){
+            ret = !waiter->receptor.error && waiter->receptor.trigger ? EH_RET_OK : EH_RET_EVENT_ERROR;
+            goto unlock_out;
+        }
+        if(receptor_timer.flags){
+            ret = receptor_timer.trigger ? EH_RET_TIMEOUT : EH_RET_EVENT_ERROR;
+            goto unlock_out;
+        }
+        eh_task_set_current_state(EH_TASK_STATE_WAIT);
+        eh_exit_critical(state);
+
+        __await__ eh_task_next();
+    }
+
+unlock_out:
+    eh_event_remove_receptor_no_lock(&waiter->receptor);
+    eh_exit_critical(state);
+
+    if(!eh_time_is_forever(timeout)){
+        eh_timer_stop(&timeout_timer);
+        eh_event_remove_receptor_no_lock(&receptor_timer);
+    }
+    if(ret == EH_RET_OK && value)
+        *value = waiter->value;
+    return ret;
+}
+
+int __async__ eh_waitq_wait_match(eh_waitq_t *wq, bool (*match)(void *match_arg, uintptr_t key),
+        void *match_arg, void **value, eh_sclock_t timeout){
+    struct eh_waitq_waiter waiter;
+    eh_param_assert(wq);
+    eh_param_assert(match);
+    waiter.key = 0;
+    waiter.match = match;
+    waiter.match_arg = match_arg;
+    return __await__ _eh_waitq_wait(wq, &waiter, NULL, NULL, value, timeout);
+}
+
+int __async__ eh_waitq_wait(eh_waitq_t *wq, uintptr_t key, void **value, eh_sclock_t timeout){
+    struct eh_waitq_waiter waiter;
+    eh_param_assert(wq);
+    waiter.key = key;
+    waiter.match = NULL;
+    waiter.match_arg = NULL;
+    return __await__ _eh_waitq_wait(wq, &waiter, NULL, NULL, value, timeout);
+}
+
+int __async__ eh_waitq_wait_condition(eh_waitq_t *wq, uintptr_t key, bool (*condition)(void *arg), 
+        void *arg, void **value, eh_sclock_t timeout){
+    struct eh_waitq_waiter waiter;
+    eh_param_assert(wq);
+    eh_param_assert(condition);
+    waiter.key = key;
+    waiter.match = NULL;
+    waiter.match_arg = NULL;
+    return __await__ _eh_waitq_wait(wq, &waiter, condition, arg, value, timeout);
+}
+
+int eh_waitq_wake(eh_waitq_t *wq, uintptr_t key, int num, void *value){
+    eh_save_state_t state;
+    struct eh_event_receptor *pos, *n;
+    struct eh_waitq_waiter *waiter;
+    int cnt = 0;
+    if(wq == NULL || num == 0)
+        return 0;
+    state = eh_enter_critical();
+    eh_list_for_each_entry_safe(pos, n, &wq->event.receptor_list_head, list_node){
+        waiter = eh_container_of(pos, struct eh_waitq_waiter, receptor);
+        if(!_eh_waitq_waiter_is_match(waiter, key))
+            continue;
+        waiter->value = value;
+        pos->trigger = 1;
+        eh_list_move_tail(&pos->list_node, &wq->handoff_list_head);
+        eh_task_wake_up(pos->wakeup_task);
+        if(++cnt == num)
+            break;
+    }
+    eh_exit_critical(state);
+    return cnt;
+}
+
+void eh_waitq_clean(eh_waitq_t *wq){
+    eh_save_state_t state;
+    struct eh_event_receptor *pos, *n;
+    state = eh_enter_critical();
+    eh_list_for_each_entry_safe(pos, n, &wq->handoff_list_head, list_node){
+        pos->error = 1;
+        eh_event_remove_receptor_no_lock(pos);
+    }
+    eh_exit_critical(state);
+    eh_event_clean(&wq->event);
+}
+
+bool eh_waitq_has_waiter(eh_waitq_t *wq){
+    eh_save_state_t state;
+    bool ret;
+    state = eh_enter_critical();
+    ret = !eh_list_empty(&wq->event.receptor_list_head);
+    eh_exit_critical(state);
+    return ret;
+}
@@ -0,0 +1,155 @@
+/**
+ * @file eh_mpmc_queue.c
+ * @brief 多生产者多消费者无锁有界队列实现
+ *        槽位序号seq的含义:
+ *          seq == pos          槽位空闲，可被位置为pos的生产者占用
+ *          seq == pos + 1      槽位已写入，可被位置为pos的消费者读取
+ *          seq == pos + size   槽位已读出，留给下一圈的生产者
+ *        等待的协程在检查队列前增加waiters，生产者在发布槽位后检查waiters，不为0时才进行事件通知，
+ *        发布和检查均使用顺序一致性，等待者要么看到新发布的槽位，要么生产者看到等待者，保证不会丢失唤醒
+ * @author simon.xiaoapeng (simon.xiaoapeng@gmail.com)
+ * @version 1.0
+ * @date 2024-08-06
+ * 
+ * @copyright Copyright (c) 2024  simon.xiaoapeng@gmail.com
+ * 
+ * @par 修改日志:
+ */
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "eh.h"
+#include "eh_types.h"
+#include "eh_error.h"
+#include "eh_mem.h"
+#include "eh_event.h"
+#include "eh_mpmc_queue.h"
+
+#define EH_MPMC_QUEUE_CACHE_LINE_SIZE       64
+
+struct eh_mpmc_queue_slot{
+    atomic_uint                 seq;
+    uint8_t                     data[] __attribute__((aligned(sizeof(void*))));
+};
+
+struct eh_mpmc_queue{
+    eh_event_t                  not_empty_event;
+    uint8_t                     *slots;
+    uint32_t                    mask;
+    uint32_t                    elem_size;
+    uint32_t                    slot_size;
+    atomic_uint                 waiters;            /* 正在eh_mpmc_queue_pop_wait中的协程数 */
+    uint8_t                     pad0[EH_MPMC_QUEUE_CACHE_LINE_SIZE];
+    atomic_uint                 enqueue_pos;
+    uint8_t                     pad1[EH_MPMC_QUEUE_CACHE_LINE_SIZE - sizeof(atomic_uint)];
+    atomic_uint                 dequeue_pos;
+    uint8_t                     pad2[EH_MPMC_QUEUE_CACHE_LINE_SIZE - sizeof(atomic_uint)];
+};
+
+struct eh_mpmc_queue_pop_arg{
+    eh_mpmc_queue_t             *queue;
+    void                        *elem;
+};
+
+#define eh_mpmc_queue_slot(queue, pos)                                                          \
+    ((struct eh_mpmc_queue_slot *)((queue)->slots + (size_t)((pos) & (queue)->mask) * (queue)->slot_size))
+
+eh_mpmc_queue_t* eh_mpmc_queue_create(uint32_t slot_cnt, uint32_t elem_size){
+    eh_mpmc_queue_t *queue;
+    uint32_t slot_size;
+    if(slot_cnt < 2 || (slot_cnt & (slot_cnt - 1)) || elem_size == 0)
+        return eh_error_to_ptr(EH_RET_INVALID_PARAM);
+    slot_size = (uint32_t)((sizeof(struct eh_mpmc_queue_slot) + elem_size + sizeof(void*) - 1) & ~(sizeof(void*) - 1));
+    queue = eh_malloc(sizeof(eh_mpmc_queue_t) + (size_t)slot_size * slot_cnt);
+    if(queue == NULL)
+        return eh_error_to_ptr(EH_RET_MALLOC_ERROR);
+    eh_event_init(&queue->not_empty_event);
+    queue->slots = (uint8_t*)(queue + 1);
+    queue->mask = slot_cnt - 1;
+    queue->elem_size = elem_size;
+    queue->slot_size = slot_size;
+    for(uint32_t i = 0; i < slot_cnt; i++)
+        atomic_init(&eh_mpmc_queue_slot(queue, i)->seq, i);
+    atomic_init(&queue->enqueue_pos, 0);
+    atomic_init(&queue->dequeue_pos, 0);
+    atomic_init(&queue->waiters, 0);
+    return queue;
+}
+
+void eh_mpmc_queue_destroy(eh_mpmc_queue_t *queue){
+    eh_event_clean(&queue->not_empty_event);
+    eh_free(queue);
+}
+
+int eh_mpmc_queue_push(eh_mpmc_queue_t *queue, const void *elem){
+    struct eh_mpmc_queue_slot *slot;
+    uint32_t pos, seq;
+    int32_t diff;
+
+    pos = atomic_load_explicit(&queue->enqueue_pos, memory_order_relaxed);
+    for(;;){
+        slot = eh_mpmc_queue_slot(queue, pos);
+        seq = atomic_load(&slot->seq);
+        diff = (int32_t)(seq - pos);
+        if(diff == 0){
+            if(atomic_compare_exchange_weak(&queue->enqueue_pos, &pos, pos + 1))
+                break;
+        }else if(diff < 0){
+            return EH_RET_BUSY;
+        }else{
+            pos = atomic_load_explicit(&queue->enqueue_pos, memory_order_relaxed);
+        }
+    }
+    memcpy(slot->data, elem, queue->elem_size);
+    atomic_store(&slot->seq, pos + 1);
+
+    /* 只看消费位置会漏掉唤醒: 之前的元素还没被其他消费者取走时，等待者可能已经在睡眠 */
+    if(atomic_load(&queue->waiters))
+        eh_event_notify(&queue->not_empty_event);
+    return EH_RET_OK;
+}
+
+int eh_mpmc_queue_pop(eh_mpmc_queue_t *queue, void *elem){
+    struct eh_mpmc_queue_slot *slot;
+    uint32_t pos, seq;
+    int32_t diff;
+
+    pos = atomic_load_explicit(&queue->dequeue_pos, memory_order_relaxed);
+    for(;;){
+        slot = eh_mpmc_queue_slot(queue, pos);
+        seq = atomic_load(&slot->seq);
+        diff = (int32_t)(seq - (pos + 1));
+        if(diff == 0){
+            if(atomic_compare_exchange_weak(&queue->dequeue_pos, &pos, pos + 1))
+                break;
+        }else if(diff < 0){
+            return EH_RET_TIMEOUT;
+        }else{
+            pos = atomic_load_explicit(&queue->dequeue_pos, memory_order_relaxed);
+        }
+    }
+    memcpy(elem, slot->data, queue->elem_size);
+    atomic_store_explicit(&slot->seq, pos + queue->mask + 1, memory_order_release);
+    return EH_RET_OK;
+}
+
+static bool condition_pop(void *arg){
+    struct eh_mpmc_queue_pop_arg *pop_arg = (struct eh_mpmc_queue_pop_arg *)arg;
+    return eh_mpmc_queue_pop(pop_arg->queue, pop_arg->elem) == EH_RET_OK;
+}
+
+int __async__ eh_mpmc_queue_pop_wait(eh_mpmc_queue_t *queue, void *elem, eh_sclock_t timeout){
+    struct eh_mpmc_queue_pop_arg pop_arg = {
+        .queue = queue,
+        .elem = elem,
+    };
+    int ret;
+    atomic_fetch_add(&queue->waiters, 1);
+    ret = __await__ eh_event_wait_condition_timeout(&queue->not_empty_event, &pop_arg, condition_pop, timeout);
+    /* EH_RET_EVENT_ERROR说明队列已被销毁，不能再访问 */
+    if(ret != EH_RET_EVENT_ERROR)
+        atomic_fetch_sub(&queue->waiters, 1);
+    return ret;
+}
@@ -0,0 +1,169 @@
+/**
+ * @file eh_msgring.c
+ * @brief 基于eh_ringbuf的消息环实现
+ *        每条消息由4字节长度头和消息内容组成，整体按EH_MSGRING_ALIGN对齐，
+ *        当环尾部的连续空间放不下一条消息时，写入填充标记将尾部空间作废，从环头部开始写，
+ *        因为整体对齐，尾部剩余空间要么为0，要么一定能放下一个填充标记
+ * @author simon.xiaoapeng (simon.xiaoapeng@gmail.com)
+ * @version 1.0
+ * @date 2024-08-04
+ * 
+ * @copyright Copyright (c) 2024  simon.xiaoapeng@gmail.com
+ * 
+ * @par 修改日志:
+ */
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "eh_types.h"
+#include "eh_error.h"
+#include "eh_mem.h"
+#include "eh_ringbuf.h"
+#include "eh_msgring.h"
+
+#define EH_MSGRING_HEAD_SIZE                ((int32_t)sizeof(uint32_t))
+#define EH_MSGRING_PAD_MARK                 0xFFFFFFFFU
+#define eh_msgring_record_size(len)         ((EH_MSGRING_HEAD_SIZE + (len) + (EH_MSGRING_ALIGN - 1)) & ~(EH_MSGRING_ALIGN - 1))
+
+eh_static_assert(EH_MSGRING_HEAD_SIZE <= EH_MSGRING_ALIGN, "msgring head must fit in one align unit");
+
+static inline uint32_t _eh_msgring_head_get(const uint8_t *head){
+    uint32_t val;
+    memcpy(&val, head, sizeof(val));
+    return val;
+}
+
+static inline void _eh_msgring_head_set(uint8_t *head, uint32_t val){
+    memcpy(head, &val, sizeof(val));
+}
+
+eh_msgring_t* eh_msgring_create(int32_t size, uint8_t *static_buf_or_null){
+    eh_msgring_t *msgring;
+    eh_ringbuf_t *ringbuf;
+    if(size < 2 * EH_MSGRING_ALIGN || size % EH_MSGRING_ALIGN)
+        return eh_error_to_ptr(EH_RET_INVALID_PARAM);
+    msgring = eh_malloc(sizeof(eh_msgring_t));
+    if(msgring == NULL)
+        return eh_error_to_ptr(EH_RET_MALLOC_ERROR);
+    ringbuf = eh_ringbuf_create(size, static_buf_or_null);
+    if(eh_ptr_to_error(ringbuf) < 0){
+        eh_free(msgring);
+        return (eh_msgring_t*)ringbuf;
+    }
+    msgring->ringbuf = ringbuf;
+    msgring->reserve_size = 0;
+    return msgring;
+}
+
+void eh_msgring_destroy(eh_msgring_t *msgring){
+    eh_ringbuf_destroy(msgring->ringbuf);
+    eh_free(msgring);
+}
+
+uint8_t* eh_msgring_push_reserve(eh_msgring_t *msgring, int32_t len){
+    eh_ringbuf_span_t span[2];
+    int32_t record_size;
+    uint8_t *head;
+    int cnt;
+
+    if(len < 0 || len > eh_msgring_msg_max_size(msgring))
+        return NULL;
+    record_size = eh_msgring_record_size(len);
+    cnt = eh_ringbuf_free_span(msgring->ringbuf, span);
+    if(cnt == 0)
+        return NULL;
+    if(span[0].len >= record_size){
+        head = span[0].buf;
+        msgring->reserve_size = record_size;
+    }else{
+        /* 尾部放不下，作废尾部空间，从头部开始写 */
+        if(cnt < 2 || span[1].len < record_size)
+            return NULL;
+        _eh_msgring_head_set(span[0].buf, EH_MSGRING_PAD_MARK);
+        head = span[1].buf;
+        msgring->reserve_size = span[0].len + record_size;
+    }
+    _eh_msgring_head_set(head, (uint32_t)len);
+    return head + EH_MSGRING_HEAD_SIZE;
+}
+
+int eh_msgring_push_commit(eh_msgring_t *msgring){
+    if(msgring->reserve_size == 0)
+        return EH_RET_INVALID_STATE;
+    eh_ringbuf_write_skip(msgring->ringbuf, msgring->reserve_size);
+    msgring->reserve_size = 0;
+    return EH_RET_OK;
+}
+
+int eh_msgring_push(eh_msgring_t *msgring, const void *msg, int32_t len){
+    uint8_t *buf = eh_msgring_push_reserve(msgring, len);
+    if(buf == NULL)
+        return len < 0 || len > eh_msgring_msg_max_size(msgring) ? EH_RET_INVALID_PARAM : EH_RET_BUSY;
+    memcpy(buf, msg, (size_t)len);
+    return eh_msgring_push_commit(msgring);
+}
+
+/**
+ * @brief                   从读位置开始遍历消息
+ * @param  msgs             为NULL时只统计字节数
+ * @param  cnt              最多遍历的消息个数
+ * @param  bytes            输出参数，遍历过的字节数(含填充)
+ * @return int              遍历到的消息个数
+ */
+static int _eh_msgring_walk(eh_msgring_t *msgring, eh_msgring_msg_t *msgs, int cnt, int32_t *bytes){
+    eh_ringbuf_span_t span[2];
+    int span_cnt, span_i = 0, n = 0;
+    int32_t offset = 0, sum = 0;
+    uint32_t head;
+
+    span_cnt = eh_ringbuf_used_span(msgring->ringbuf, span);
+    while(n < cnt && span_i < span_cnt){
+        if(offset >= span[span_i].len){
+            span_i++;
+            offset = 0;
+            continue;
+        }
+        head = _eh_msgring_head_get(span[span_i].buf + offset);
+        if(head == EH_MSGRING_PAD_MARK){
+            sum += span[span_i].len - offset;
+            span_i++;
+            offset = 0;
+            continue;
+        }
+        if(msgs){
+            msgs[n].buf = span[span_i].buf + offset + EH_MSGRING_HEAD_SIZE;
+            msgs[n].len = (int32_t)head;
+        }
+        offset += eh_msgring_record_size((int32_t)head);
+        sum += eh_msgring_record_size((int32_t)head);
+        n++;
+    }
+    *bytes = sum;
+    return n;
+}
+
+int eh_msgring_peek_batch(eh_msgring_t *msgring, eh_msgring_msg_t *msgs, int max_cnt){
+    int32_t bytes;
+    return _eh_msgring_walk(msgring, msgs, max_cnt, &bytes);
+}
+
+int eh_msgring_pop_batch(eh_msgring_t *msgring, int cnt){
+    int32_t bytes;
+    int n;
+    n = _eh_msgring_walk(msgring, NULL, cnt, &bytes);
+    if(bytes)
+        eh_ringbuf_read_skip(msgring->ringbuf, bytes);
+    return n;
+}
+
+int32_t eh_msgring_read(eh_msgring_t *msgring, uint8_t *buf, int32_t buf_size){
+    eh_msgring_msg_t msg;
+    if(eh_msgring_peek_batch(msgring, &msg, 1) == 0)
+        return EH_RET_TIMEOUT;
+    if(msg.len > buf_size)
+        return EH_RET_INVALID_PARAM;
+    memcpy(buf, msg.buf, (size_t)msg.len);
+    eh_msgring_pop_batch(msgring, 1);
+    return msg.len;
+}
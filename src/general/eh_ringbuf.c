@@ -133,6 +133,43 @@ const uint8_t* eh_ringbuf_peek(eh_ringbuf_t *ringbuf, int32_t offset, uint8_t *b
     }
 }
 
+int32_t eh_ringbuf_write_skip(eh_ringbuf_t *ringbuf, int32_t len){
+    int32_t free_size = eh_ringbuf_free_size(ringbuf);
+    int32_t wl;
+    wl = len > free_size ? free_size : len;
+    if(wl <= 0) return 0;
+    eh_memory_order_release_barrier();
+    ringbuf->w = eh_ringbuf_fix(ringbuf, ringbuf->w + (uint32_t)wl);
+    return wl;
+}
+
+static int _eh_ringbuf_span(eh_ringbuf_t *ringbuf, uint32_t pos, int32_t len, eh_ringbuf_span_t span[2]){
+    int32_t first_max;
+    if(len <= 0) return 0;
+    pos = pos % (uint32_t)ringbuf->size;
+    first_max = ringbuf->size - (int32_t)pos;
+    span[0].buf = ringbuf->buf + pos;
+    if(len <= first_max){
+        span[0].len = len;
+        return 1;
+    }
+    span[0].len = first_max;
+    span[1].buf = ringbuf->buf;
+    span[1].len = len - first_max;
+    return 2;
+}
+
+int eh_ringbuf_used_span(eh_ringbuf_t *ringbuf, eh_ringbuf_span_t span[2]){
+    int32_t size = eh_ringbuf_size(ringbuf);
+    eh_memory_order_acquire_barrier();
+    return _eh_ringbuf_span(ringbuf, ringbuf->r, size, span);
+}
+
+int eh_ringbuf_free_span(eh_ringbuf_t *ringbuf, eh_ringbuf_span_t span[2]){
+    int32_t free_size = eh_ringbuf_free_size(ringbuf);
+    return _eh_ringbuf_span(ringbuf, ringbuf->w, free_size, span);
+}
+
 void eh_ringbuf_clear(eh_ringbuf_t *ringbuf){
     eh_memory_order_release_barrier();
     ringbuf->r = ringbuf->w;
@@ -0,0 +1,76 @@
+/**
+ * @file eh_mpmc_queue.h
+ * @brief 多生产者多消费者无锁有界队列(Vyukov bounded queue)，每个槽位带有序号，
+ *        入队出队不需要进入全局临界区，可用于多个线程之间的数据交换，
+ *        协程消费者可使用 eh_mpmc_queue_pop_wait 进行等待，
+ *        只有存在等待的协程时生产者才会走事件唤醒路径
+ * @author simon.xiaoapeng (simon.xiaoapeng@gmail.com)
+ * @version 1.0
+ * @date 2024-08-06
+ * 
+ * @copyright Copyright (c) 2024  simon.xiaoapeng@gmail.com
+ * 
+ * @par 修改日志:
+ */
+#ifndef _EH_MPMC_QUEUE_H_
+#define _EH_MPMC_QUEUE_H_
+
+#include <stdint.h>
+#include "eh_co.h"
+#include "eh_types.h"
+
+#ifdef __cplusplus
+#if __cplusplus
+extern "C"{
+#endif
+#endif /* __cplusplus */
+
+typedef struct eh_mpmc_queue eh_mpmc_queue_t;
+
+/**
+ * @brief                           创建队列
+ * @param  slot_cnt                 槽位个数，必须为2的幂
+ * @param  elem_size                每个元素的大小
+ * @return eh_mpmc_queue_t*         返回值请使用eh_ptr_to_error来判断是否创建成功
+ */
+extern eh_mpmc_queue_t* eh_mpmc_queue_create(uint32_t slot_cnt, uint32_t elem_size);
+
+/**
+ * @brief                           销毁队列，会唤醒所有等待中的协程(返回EH_RET_EVENT_ERROR)
+ * @param  queue                    队列指针
+ */
+extern void eh_mpmc_queue_destroy(eh_mpmc_queue_t *queue);
+
+/**
+ * @brief                           元素入队，任意线程均可调用
+ * @param  queue                    队列指针
+ * @param  elem                     元素指针，将拷贝elem_size字节
+ * @return int                      成功返回EH_RET_OK，队列已满返回EH_RET_BUSY
+ */
+extern __safety int eh_mpmc_queue_push(eh_mpmc_queue_t *queue, const void *elem);
+
+/**
+ * @brief                           元素出队，不进行等待，任意线程均可调用
+ * @param  queue                    队列指针
+ * @param  elem                     元素输出指针
+ * @return int                      成功返回EH_RET_OK，队列为空返回EH_RET_TIMEOUT
+ */
+extern __safety int eh_mpmc_queue_pop(eh_mpmc_queue_t *queue, void *elem);
+
+/**
+ * @brief                           协程中等待并出队一个元素
+ * @param  queue                    队列指针
+ * @param  elem                     元素输出指针
+ * @param  timeout                  超时时间，0为不等待，EH_TIME_FOREVER为永久等待
+ * @return int                      见eh_error.h
+ */
+extern int __async__ eh_mpmc_queue_pop_wait(eh_mpmc_queue_t *queue, void *elem, eh_sclock_t timeout);
+
+#ifdef __cplusplus
+#if __cplusplus
+}
+#endif
+#endif /* __cplusplus */
+
+
+#endif // _EH_MPMC_QUEUE_H_
@@ -0,0 +1,153 @@
+/**
+ * @file eh_msgring.h
+ * @brief 基于eh_ringbuf的消息环，以长度前缀的形式存放变长消息，
+ *        消息永远不会在绕回处被拆分，读写两端均可原地(0拷贝)访问消息，
+ *        线程约束与eh_ringbuf一致，单读单写无锁
+ * @author simon.xiaoapeng (simon.xiaoapeng@gmail.com)
+ * @version 1.0
+ * @date 2024-08-04
+ * 
+ * @copyright Copyright (c) 2024  simon.xiaoapeng@gmail.com
+ * 
+ * @par 修改日志:
+ */
+#ifndef _EH_MSGRING_H_
+#define _EH_MSGRING_H_
+
+#include <stdint.h>
+#include "eh_ringbuf.h"
+
+#ifdef __cplusplus
+#if __cplusplus
+extern "C"{
+#endif
+#endif /* __cplusplus */
+
+/* 每条消息的头部大小和对齐粒度，环的大小必须是它的整数倍 */
+#define EH_MSGRING_ALIGN                    4
+
+typedef struct eh_msgring{
+    eh_ringbuf_t    *ringbuf;
+    int32_t         reserve_size;           /* eh_msgring_push_reserve 预留的字节数(含填充) */
+}eh_msgring_t;
+
+typedef struct eh_msgring_msg{
+    const uint8_t   *buf;                   /* 指向环内部的消息内容 */
+    int32_t         len;
+}eh_msgring_msg_t;
+
+/**
+ * @brief                           创建消息环
+ * @param  size                     环的大小，必须为EH_MSGRING_ALIGN的整数倍
+ * @param  static_buf_or_null       静态缓冲区指针，如果为NULL则动态分配内存
+ * @return eh_msgring_t*            返回值请使用eh_ptr_to_error来判断是否创建成功
+ */
+extern eh_msgring_t* eh_msgring_create(int32_t size, uint8_t *static_buf_or_null);
+
+/**
+ * @brief                           销毁消息环
+ * @param  msgring                  消息环指针
+ */
+extern void eh_msgring_destroy(eh_msgring_t *msgring);
+
+/**
+ * @brief                           获取单条消息的长度上限，因为消息不会被拆分，读写位置也不会回到环头部，
+ *                                  环为空时尾部和头部的连续空间中较大的一段至少为环的一半，
+ *                                  所以上限为环的一半(含4字节头部)，不超过上限的消息在环读空后一定能写入
+ * @param  msgring                  消息环指针
+ * @return int32_t 
+ */
+static inline int32_t eh_msgring_msg_max_size(eh_msgring_t *msgring){
+    return ((eh_ringbuf_total_size(msgring->ringbuf) / 2) & ~(EH_MSGRING_ALIGN - 1)) - EH_MSGRING_ALIGN;
+}
+
+/**
+ * @brief                           消息环是否为空
+ * @param  msgring                  消息环指针
+ */
+static inline int eh_msgring_is_empty(eh_msgring_t *msgring){
+    return eh_ringbuf_size(msgring->ringbuf) == 0;
+}
+
+/**
+ * @brief                           在环内部预留一条消息的空间，写者填充后调用 eh_msgring_push_commit 提交
+ * @param  msgring                  消息环指针
+ * @param  len                      消息长度
+ * @return uint8_t*                 成功返回可写入的消息地址，空间不足返回NULL
+ */
+extern uint8_t* eh_msgring_push_reserve(eh_msgring_t *msgring, int32_t len);
+
+/**
+ * @brief                           提交 eh_msgring_push_reserve 预留的消息，提交后对读者可见
+ * @param  msgring                  消息环指针
+ * @return int                      见eh_error.h
+ */
+extern int eh_msgring_push_commit(eh_msgring_t *msgring);
+
+/**
+ * @brief                           写入一条完整消息
+ * @param  msgring                  消息环指针
+ * @param  msg                      消息内容
+ * @param  len                      消息长度
+ * @return int                      成功返回EH_RET_OK，空间不足返回EH_RET_BUSY
+ */
+extern int eh_msgring_push(eh_msgring_t *msgring, const void *msg, int32_t len);
+
+/**
+ * @brief                           原地(0拷贝)批量获取消息，不会将消息移出，处理完毕后调用 eh_msgring_pop_batch
+ * @param  msgring                  消息环指针
+ * @param  msgs                     输出参数，消息描述数组
+ * @param  max_cnt                  数组大小
+ * @return int                      返回获取到的消息个数
+ */
+extern int eh_msgring_peek_batch(eh_msgring_t *msgring, eh_msgring_msg_t *msgs, int max_cnt);
+
+/**
+ * @brief                           批量移出最前面的cnt条消息，只进行一次读指针更新
+ * @param  msgring                  消息环指针
+ * @param  cnt                      要移出的消息个数
+ * @return int                      返回实际移出的消息个数
+ */
+extern int eh_msgring_pop_batch(eh_msgring_t *msgring, int cnt);
+
+/**
+ * @brief                           原地(0拷贝)获取最前面的一条消息
+ * @param  msgring                  消息环指针
+ * @param  len                      输出参数，消息长度
+ * @return const uint8_t*           没有消息时返回NULL
+ */
+static inline const uint8_t* eh_msgring_peek(eh_msgring_t *msgring, int32_t *len){
+    eh_msgring_msg_t msg;
+    if(eh_msgring_peek_batch(msgring, &msg, 1) == 0)
+        return NULL;
+    *len = msg.len;
+    return msg.buf;
+}
+
+/**
+ * @brief                           移出最前面的一条消息
+ * @param  msgring                  消息环指针
+ * @return int                      返回实际移出的消息个数
+ */
+static inline int eh_msgring_pop(eh_msgring_t *msgring){
+    return eh_msgring_pop_batch(msgring, 1);
+}
+
+/**
+ * @brief                           读取并移出最前面的一条完整消息
+ * @param  msgring                  消息环指针
+ * @param  buf                      要读到的缓冲区指针
+ * @param  buf_size                 缓冲区大小
+ * @return int32_t                  成功返回消息长度，没有消息返回EH_RET_TIMEOUT，
+ *                                  缓冲区不足返回EH_RET_INVALID_PARAM且消息不会被移出
+ */
+extern int32_t eh_msgring_read(eh_msgring_t *msgring, uint8_t *buf, int32_t buf_size);
+
+#ifdef __cplusplus
+#if __cplusplus
+}
+#endif
+#endif /* __cplusplus */
+
+
+#endif // _EH_MSGRING_H_
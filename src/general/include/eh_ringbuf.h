@@ -27,6 +27,12 @@ typedef struct eh_ringbuf{
     uint8_t *buf;
 }eh_ringbuf_t;
 
+/* 环形缓冲区中的一段连续内存，绕回时一个区域最多被拆分为两段 */
+typedef struct eh_ringbuf_span{
+    uint8_t *buf;
+    int32_t  len;
+}eh_ringbuf_span_t;
+
 /**
  * @brief                           创建环形缓冲区
  * @param  size                     环形缓冲区大小,要求在正数范围内，因为使用镜像法缓冲区
@@ -104,6 +110,33 @@ extern int32_t eh_ringbuf_read_skip(eh_ringbuf_t *ringbuf, int32_t len);
 extern const uint8_t* eh_ringbuf_peek(eh_ringbuf_t *ringbuf, int32_t offset, uint8_t *buf, int32_t *len);
 
 
+/**
+ * @brief                           跳过写环形缓冲区，一般在直接填充 eh_ringbuf_free_span 返回的区域后调用，
+ *                                  用于提交写入的数据
+ * @param  ringbuf                  环形缓冲区指针
+ * @param  len                      要提交的长度
+ * @return int32_t                  返回提交成功的数量
+ */
+extern int32_t eh_ringbuf_write_skip(eh_ringbuf_t *ringbuf, int32_t len);
+
+/**
+ * @brief                           获取环形缓冲区已用区域(0拷贝)，读者侧使用，
+ *                                  处理完毕后使用 eh_ringbuf_read_skip 释放
+ * @param  ringbuf                  环形缓冲区指针
+ * @param  span                     输出参数，已用区域，按数据先后顺序排列
+ * @return int                      返回有效区域的个数(0~2)
+ */
+extern int eh_ringbuf_used_span(eh_ringbuf_t *ringbuf, eh_ringbuf_span_t span[2]);
+
+/**
+ * @brief                           获取环形缓冲区空闲区域(0拷贝)，写者侧使用，
+ *                                  填充完毕后使用 eh_ringbuf_write_skip 提交
+ * @param  ringbuf                  环形缓冲区指针
+ * @param  span                     输出参数，空闲区域，按写入先后顺序排列
+ * @return int                      返回有效区域的个数(0~2)
+ */
+extern int eh_ringbuf_free_span(eh_ringbuf_t *ringbuf, eh_ringbuf_span_t span[2]);
+
 /**
  * @brief                           清空环形缓冲区(单读写安全)
  * @param  ringbuf                  环形缓冲区指针
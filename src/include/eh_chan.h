@@ -0,0 +1,123 @@
+/**
+ * @file eh_chan.h
+ * @brief 通道的实现，类似于go语言的chan，用于任务之间传递定长的数据，
+ *    支持有缓冲和无缓冲(capacity为0，同步交接)两种模式，
+ *    当有任务在等待接收时，发送者直接将数据拷贝到接收者提供的内存中，不经过缓冲区，
+ *    eh_chan_select 可同时在多个通道上等待发送或接收。
+ *      使用限制: 此模块所有的函数都只能在协程上下文中使用
+ * @author simon.xiaoapeng (simon.xiaoapeng@gmail.com)
+ * @version 1.0
+ * @date 2024-08-08
+ * 
+ * @copyright Copyright (c) 2024  simon.xiaoapeng@gmail.com
+ * 
+ * @par 修改日志:
+ */
+
+#ifndef _EH_CHAN_H_
+#define _EH_CHAN_H_
+
+#include <stdint.h>
+#include "eh_types.h"
+#include "eh_error.h"
+
+typedef int* eh_chan_t;
+
+#ifdef __cplusplus
+#if __cplusplus
+extern "C"{
+#endif
+#endif /* __cplusplus */
+
+/* eh_chan_select 一次最多可以等待的case数量 */
+#define EH_CHAN_SELECT_CASE_MAX             8
+
+enum eh_chan_dir{
+    EH_CHAN_DIR_SEND,
+    EH_CHAN_DIR_RECV,
+};
+
+struct eh_chan_case{
+    eh_chan_t                           chan;
+    enum eh_chan_dir                    dir;
+    void                                *elem;      /* 发送时为数据来源，接收时为数据存放地址 */
+};
+
+/**
+ * @brief                   创建一个通道
+ * @param  elem_size        元素大小
+ * @param  capacity         缓冲区可容纳的元素个数，为0时为无缓冲通道，发送者会一直等待到接收者取走数据
+ * @return eh_chan_t        返回值请使用eh_ptr_to_error来判断是否创建成功
+ */
+extern eh_chan_t eh_chan_create(uint32_t elem_size, uint32_t capacity);
+
+/**
+ * @brief                   按类型创建一个通道
+ */
+#define eh_chan_create_type(type, capacity)     eh_chan_create(sizeof(type), capacity)
+
+/**
+ * @brief                   销毁通道，正在等待的任务将返回EH_RET_EVENT_ERROR
+ * @param  chan             通道句柄
+ */
+extern void eh_chan_destroy(eh_chan_t chan);
+
+/**
+ * @brief                   关闭通道，关闭后发送将返回EH_RET_INVALID_STATE，
+ *                          缓冲区中剩余的数据依然可以被接收，取完后接收也返回EH_RET_INVALID_STATE
+ * @param  chan             通道句柄
+ */
+extern void eh_chan_close(eh_chan_t chan);
+
+/**
+ * @brief                   同时等待多个通道的发送或接收，只会有一个case被执行
+ * @param  cases            case数组
+ * @param  case_cnt         case个数，最多EH_CHAN_SELECT_CASE_MAX个
+ * @param  timeout          超时时间，0为不等待，EH_TIME_FOREVER为永久等待
+ * @return int              成功返回被执行的case下标，失败返回负数错误码,
+ *                          若某个case因为通道关闭而结束，返回EH_RET_INVALID_STATE
+ */
+extern int __async__ eh_chan_select(struct eh_chan_case *cases, int case_cnt, eh_sclock_t timeout);
+
+/**
+ * @brief                   发送一个元素
+ * @param  chan             通道句柄
+ * @param  elem             元素指针，拷贝elem_size字节
+ * @param  timeout          超时时间，0为不等待，EH_TIME_FOREVER为永久等待
+ * @return int              见eh_error.h
+ */
+static inline int __async__ eh_chan_send(eh_chan_t chan, const void *elem, eh_sclock_t timeout){
+    struct eh_chan_case chan_case = {
+        .chan = chan,
+        .dir = EH_CHAN_DIR_SEND,
+        .elem = (void*)elem,
+    };
+    int ret = __await__ eh_chan_select(&chan_case, 1, timeout);
+    return ret < 0 ? ret : EH_RET_OK;
+}
+
+/**
+ * @brief                   接收一个元素
+ * @param  chan             通道句柄
+ * @param  elem             元素存放地址
+ * @param  timeout          超时时间，0为不等待，EH_TIME_FOREVER为永久等待
+ * @return int              见eh_error.h
+ */
+static inline int __async__ eh_chan_recv(eh_chan_t chan, void *elem, eh_sclock_t timeout){
+    struct eh_chan_case chan_case = {
+        .chan = chan,
+        .dir = EH_CHAN_DIR_RECV,
+        .elem = elem,
+    };
+    int ret = __await__ eh_chan_select(&chan_case, 1, timeout);
+    return ret < 0 ? ret : EH_RET_OK;
+}
+
+#ifdef __cplusplus
+#if __cplusplus
+}
+#endif
+#endif /* __cplusplus */
+
+
+#endif // _EH_CHAN_H_
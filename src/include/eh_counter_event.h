@@ -0,0 +1,113 @@
+/**
+ * @file eh_counter_event.h
+ * @brief 计数事件，类似linux的eventfd，
+ *   普通事件没有记忆，等待前发生的通知会丢失，计数事件用一个原子计数器记住所有通知，
+ *   等待方可一次性取走全部计数，突发通知时只需一次唤醒
+ * @author simon.xiaoapeng (simon.xiaoapeng@gmail.com)
+ * @version 1.0
+ * @date 2024-08-15
+ *
+ * @copyright Copyright (c) 2024  simon.xiaoapeng@gmail.com
+ *
+ * @par 修改日志:
+ */
+#ifndef _EH_COUNTER_EVENT_H_
+#define _EH_COUNTER_EVENT_H_
+
+#include "eh_types.h"
+#include "eh_event.h"
+
+#ifdef __cplusplus
+#if __cplusplus
+extern "C"{
+#endif
+#endif /* __cplusplus */
+
+typedef struct eh_counter_event eh_counter_event_t;
+
+struct eh_counter_event {
+    eh_event_t                      event;
+    uint32_t                        count;                      /* 未被取走的计数，只能通过原子操作访问 */
+};
+
+#define EH_COUNTER_EVENT_TAKE_ALL       0xFFFFFFFFU             /* 取走全部计数 */
+
+#define EH_COUNTER_EVENT_INIT(ce, init_count) {                                 \
+        .event = EH_EVENT_INIT(ce.event),                                       \
+        .count = (init_count),                                                  \
+    }
+
+/**
+ * @brief                           定义并初始化一个计数事件（.c中使用）
+ * @param  ce_name                  计数事件名称
+ */
+#define EH_DEFINE_COUNTER_EVENT(ce_name) eh_counter_event_t ce_name =           \
+    EH_COUNTER_EVENT_INIT(ce_name, 0)
+
+/**
+ * @brief                           计数事件初始化
+ * @param  ce                       计数事件实例指针
+ * @param  init_count               初始计数
+ * @return int                      见eh_error.h
+ */
+extern __safety int eh_counter_event_init(eh_counter_event_t *ce, uint32_t init_count);
+
+/**
+ * @brief                           唤醒所有等待的任务(返回EH_RET_EVENT_ERROR)，释放实例前调用
+ * @param  ce                       计数事件实例指针
+ */
+extern __safety void eh_counter_event_clean(eh_counter_event_t *ce);
+
+/**
+ * @brief                           增加计数，可在任意线程调用，
+ *                                  只有计数从0变为非0时才会通知事件，计数未被取走前的后续增加不会产生额外唤醒
+ * @param  ce                       计数事件实例指针
+ * @param  n                        增加的计数
+ * @return int                      成功返回EH_RET_OK，计数将溢出时返回EH_RET_BUSY且计数不变
+ */
+extern __safety int eh_counter_event_add(eh_counter_event_t *ce, uint32_t n);
+
+/**
+ * @brief                           非阻塞地取走最多max个计数
+ * @param  ce                       计数事件实例指针
+ * @param  max                      最多取走的计数，EH_COUNTER_EVENT_TAKE_ALL为全部取走，为1时即信号量语义
+ * @return uint32_t                 实际取走的计数，0表示没有计数
+ */
+extern __safety uint32_t eh_counter_event_try_take(eh_counter_event_t *ce, uint32_t max);
+
+/**
+ * @brief                           等待计数非0并取走最多max个计数，
+ *                                  与eh_event_wait_timeout不同，调用前产生的通知不会丢失
+ * @param  ce                       计数事件实例指针
+ * @param  max                      最多取走的计数，EH_COUNTER_EVENT_TAKE_ALL为全部取走
+ * @param  count                    取走的计数，可为NULL
+ * @param  timeout                  超时时间，0为不等待，EH_TIME_FOREVER为永不超时
+ * @return int                      成功返回EH_RET_OK，超时返回EH_RET_TIMEOUT，
+ *                                  等待过程中被clean返回EH_RET_EVENT_ERROR
+ */
+extern int __async__ eh_counter_event_take(eh_counter_event_t *ce, uint32_t max, uint32_t *count, eh_sclock_t timeout);
+
+/**
+ * @brief                           读取当前计数，不取走
+ * @param  ce                       计数事件实例指针
+ * @return uint32_t
+ */
+static inline uint32_t eh_counter_event_pending(eh_counter_event_t *ce){
+    return __atomic_load_n(&ce->count, __ATOMIC_ACQUIRE);
+}
+
+/**
+ * @brief                           获取计数事件内部的事件，可用于epoll监听，
+ *                                  事件只在计数从0变为非0时触发，epoll唤醒后应取走全部计数，
+ *                                  否则剩余计数不会再次触发epoll
+ */
+#define eh_counter_event_to_event(ce)       (&(ce)->event)
+
+#ifdef __cplusplus
+#if __cplusplus
+}
+#endif
+#endif /* __cplusplus */
+
+
+#endif // _EH_COUNTER_EVENT_H_
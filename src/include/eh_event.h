@@ -14,6 +14,7 @@
 
 #include "eh_types.h"
 #include "eh_list.h"
+#include "eh_rbtree.h"
 
 #ifdef __cplusplus
 #if __cplusplus
@@ -25,9 +26,16 @@ typedef struct eh_event                     eh_event_t;
 typedef struct eh_event_type                eh_event_type_t;
 typedef int*                                eh_epoll_t;
 typedef struct eh_epoll_slot                eh_epoll_slot_t;
+typedef struct eh_event_epoll_receptor      eh_epoll_node_t;
 
 
 
+/* epoll注册模式，可以组合使用 */
+#define EH_EPOLLET                      0x00000000              /* 边沿触发(默认)，事件多次发生在被读取前只投递一次 */
+#define EH_EPOLLLT                      0x00000001              /* 水平触发，投递后只要level_condition仍为真就在每次wait时重新投递 */
+#define EH_EPOLLONESHOT                 0x00000002              /* 投递一次后自动解除监听，需调用rearm重新监听 */
+#define EH_EPOLLEXCLUSIVE               0x00000004              /* 多个epoll以此模式监听同一事件时，每次通知只唤醒其中一个 */
+
 enum EH_EPOLL_AFFAIR{
     EH_EPOLL_AFFAIR_EVENT_TRIGGER,
     EH_EPOLL_AFFAIR_ERROR,
@@ -41,6 +49,32 @@ struct eh_event{
     struct eh_list_head                 receptor_list_head;    /* 事件产生时的受体链表 */
 };
 
+/* 事件接收器，成员仅供内部使用  */
+struct eh_event_receptor{
+    struct eh_list_head                 list_node;
+    struct eh_task                      *wakeup_task;           /* 被唤醒的任务            */
+    union{
+        uint32_t                            flags;
+        struct{
+            uint32_t                     trigger:1;
+            uint32_t                     error:1;
+        };
+    };
+    struct eh_epoll                     *epoll;
+};
+
+/* epoll注册节点，可由用户提供存储(见eh_epoll_add_node)，成员仅供内部使用 */
+struct eh_event_epoll_receptor{
+    struct eh_rbtree_node               rb_node;                /* 仅eh_epoll_add_event添加的节点挂在epoll的树上 */
+    struct eh_list_head                 pending_list_node;
+    struct eh_list_head                 epoll_list_node;
+    eh_event_t                          *event;
+    void                                *userdata;
+    bool                                (*level_condition)(void *userdata);
+    uint32_t                            mode;                   /* EH_EPOLLLT等模式 */
+    struct eh_event_receptor            receptor;
+};
+
 struct eh_epoll_slot{
     eh_event_t                          *event;
     void                                *userdata;
@@ -151,7 +185,63 @@ extern int eh_epoll_add_event(eh_epoll_t epoll, eh_event_t *e, void *userdata);
 extern int eh_epoll_del_event(eh_epoll_t epoll,eh_event_t *e);
 
 /**
- * @brief                   epoll事件等待
+ * @brief                   以指定模式为epoll添加一个被监视事件
+ * @param  epoll            epoll句柄
+ * @param  e                事件句柄
+ * @param  userdata         当事件发生时，可将userdata通过wait传递出来
+ * @param  mode             EH_EPOLLET/EH_EPOLLLT/EH_EPOLLONESHOT/EH_EPOLLEXCLUSIVE的组合
+ * @param  level_condition  EH_EPOLLLT模式下判断事件是否仍然就绪，参数为userdata，在临界区内调用，禁止任何形式的await函数，
+ *                          EH_EPOLLLT模式下不能为NULL，其他模式忽略
+ * @return int
+ */
+extern int eh_epoll_add_event_mode(eh_epoll_t epoll, eh_event_t *e, void *userdata, 
+    uint32_t mode, bool (*level_condition)(void *userdata));
+
+/**
+ * @brief                   重新监听EH_EPOLLONESHOT模式投递后被解除的事件
+ * @param  epoll            epoll句柄
+ * @param  e                事件句柄
+ * @return int
+ */
+extern int eh_epoll_rearm_event(eh_epoll_t epoll, eh_event_t *e);
+
+/**
+ * @brief                   使用用户提供的节点为epoll添加一个被监视事件，
+ *                          与eh_epoll_add_event不同，不申请内存也不进行查找，适合频繁添加删除的场景，
+ *                          同一事件可以用不同的节点重复添加，节点在删除前不能释放或重复添加
+ * @param  epoll            epoll句柄
+ * @param  node             用户提供的节点存储，无需初始化
+ * @param  e                事件句柄
+ * @param  userdata         当事件发生时，可将userdata通过wait传递出来
+ * @return int
+ */
+extern __safety int eh_epoll_add_node(eh_epoll_t epoll, eh_epoll_node_t *node, eh_event_t *e, void *userdata);
+
+/**
+ * @brief                   以指定模式使用用户提供的节点为epoll添加一个被监视事件，参数含义见eh_epoll_add_event_mode
+ */
+extern __safety int eh_epoll_add_node_mode(eh_epoll_t epoll, eh_epoll_node_t *node, eh_event_t *e, void *userdata, 
+    uint32_t mode, bool (*level_condition)(void *userdata));
+
+/**
+ * @brief                   重新监听EH_EPOLLONESHOT模式投递后被解除的节点
+ * @param  epoll            epoll句柄
+ * @param  node             节点
+ * @return int
+ */
+extern __safety int eh_epoll_rearm_node(eh_epoll_t epoll, eh_epoll_node_t *node);
+
+/**
+ * @brief                   删除eh_epoll_add_node添加的节点，O(1)，删除后节点可重新使用
+ * @param  epoll            epoll句柄
+ * @param  node             节点
+ * @return int              节点不属于该epoll时返回EH_RET_INVALID_PARAM
+ */
+extern __safety int eh_epoll_del_node(eh_epoll_t epoll, eh_epoll_node_t *node);
+
+/**
+ * @brief                   epoll事件等待，多个任务可以同时等待同一个epoll，
+ *                          每个新的待处理事件只唤醒一个空闲等待者，按等待先后分配
  * @param  epoll            epoll句柄
  * @param  epool_slot       epoll事件等待槽
  * @param  slot_size        epoll事件等待槽大小
@@ -14,15 +14,34 @@
 #ifndef _EH_EVENT_CB_H_
 #define _EH_EVENT_CB_H_
 
+#include "eh_config.h"
+
 #ifdef __cplusplus
 #if __cplusplus
 extern "C"{
 #endif
 #endif /* __cplusplus */
 
+/**
+ * 槽函数调度通道数，0号通道优先级最高，见eh_event_cb_register_lane
+ */
+#if defined(EH_CONFIG_EVENT_CALLBACK_LANE_CNT) && (EH_CONFIG_EVENT_CALLBACK_LANE_CNT > 0)
+#define EH_EVENT_CB_LANE_CNT            EH_CONFIG_EVENT_CALLBACK_LANE_CNT
+#else
+#define EH_EVENT_CB_LANE_CNT            1
+#endif
+
 typedef struct eh_event_cb_slot eh_event_cb_slot_t;
 typedef struct eh_event_cb_trigger eh_event_cb_trigger_t;
 
+/* 槽函数的调用方式 */
+enum eh_event_cb_mode{
+    EH_EVENT_CB_MODE_TASK,              /* 默认，在event_cb任务中调用槽函数 */
+    EH_EVENT_CB_MODE_DEFERRED,          /* 在调度器本轮循环结束时(eh_poll)调用槽函数，运行在进入调度的任务栈上，省去任务切换 */
+    EH_EVENT_CB_MODE_DIRECT,            /* 通过eh_event_cb_notify触发时在通知者的栈上立即调用槽函数，
+                                           其他方式(如定时器、其他线程)产生的事件按EH_EVENT_CB_MODE_DEFERRED处理 */
+};
+
 struct eh_event_cb_slot{
     void                    (*slot_function)(eh_event_t *e, void *slot_param);
     void                    *slot_param;
@@ -31,10 +50,12 @@ struct eh_event_cb_slot{
 
 struct eh_event_cb_trigger{
     struct eh_list_head     cb_head;
+    enum eh_event_cb_mode   mode;
 };
 
 #define EH_EVENT_CB_TRIGGER_INIT(trigger)   {               \
         .cb_head = EH_LIST_HEAD_INIT(trigger.cb_head),  \
+        .mode = EH_EVENT_CB_MODE_TASK,                  \
     }
 
 static inline void eh_event_cb_slot_init(eh_event_cb_slot_t *slot, 
@@ -46,11 +67,50 @@ static inline void eh_event_cb_slot_init(eh_event_cb_slot_t *slot,
 
 static inline void eh_event_cb_trigger_init(eh_event_cb_trigger_t *trigger){
     eh_list_head_init(&trigger->cb_head);
+    trigger->mode = EH_EVENT_CB_MODE_TASK;
+}
+
+/**
+ * @brief                   设置触发器槽函数的调用方式，需在eh_event_cb_register之前设置
+ *                           EH_EVENT_CB_MODE_DEFERRED和EH_EVENT_CB_MODE_DIRECT模式下槽函数不在独立的任务中运行，
+ *                           必须短小且禁止任何形式的await函数
+ * @param  trigger          触发器
+ * @param  mode             调用方式
+ */
+static inline void eh_event_cb_trigger_set_mode(eh_event_cb_trigger_t *trigger, enum eh_event_cb_mode mode){
+    trigger->mode = mode;
+}
+
+/**
+ * @brief                   立即调用所有EH_EVENT_CB_MODE_DEFERRED/EH_EVENT_CB_MODE_DIRECT模式下已触发的槽函数，
+ *                           只能在调度器所在线程调用
+ */
+extern void eh_event_cb_deferred_dispatch(void);
+
+/**
+ * @brief                   立即调用事件e所注册的EH_EVENT_CB_MODE_DEFERRED/EH_EVENT_CB_MODE_DIRECT触发器的槽函数(若已触发)，
+ *                           其他已触发的槽函数仍在本轮调度循环结束时调用，只能在调度器所在线程调用
+ * @param  e                注册触发器时的事件
+ */
+extern void eh_event_cb_direct_dispatch(eh_event_t *e);
+
+/**
+ * @brief                   通知事件，若触发器为EH_EVENT_CB_MODE_DIRECT模式，返回前此触发器的槽函数已在当前栈上执行完毕
+ *                           EH_EVENT_CB_MODE_DIRECT模式下只能在调度器所在线程调用，其他模式可在任意线程调用
+ * @param  e                注册触发器时的事件
+ * @param  trigger          触发器
+ * @return int 
+ */
+static inline int eh_event_cb_notify(eh_event_t *e, eh_event_cb_trigger_t *trigger){
+    int ret = eh_event_notify(e);
+    if(trigger->mode == EH_EVENT_CB_MODE_DIRECT)
+        eh_event_cb_direct_dispatch(e);
+    return ret;
 }
 
 
 /**
- * @brief                   注册一个事件触发器
+ * @brief                   注册一个事件触发器，使用0号通道
  *                           只有注册的的触发器才能进行槽函数的连接
  *                           注册事件触发器并不会影响事件触发器与槽函数的连接
  * @param  e                事件
@@ -59,6 +119,27 @@ static inline void eh_event_cb_trigger_init(eh_event_cb_trigger_t *trigger){
  */
 extern int eh_event_cb_register(eh_event_t *e, eh_event_cb_trigger_t *trigger);
 
+/**
+ * @brief                   注册一个事件触发器并指定其槽函数的调度通道(仅EH_EVENT_CB_MODE_TASK模式有效)
+ *                           每个通道有独立的任务和栈，编号越小优先级越高，0号通道为系统任务，被唤醒时优先运行，
+ *                           其他通道在更高优先级的通道有待处理事件时先让出，且每处理完一批事件就让出CPU，
+ *                           慢的槽函数放在低优先级通道中不会拖慢高优先级通道
+ * @param  e                事件
+ * @param  trigger          触发器
+ * @param  lane             通道号，0 ~ EH_EVENT_CB_LANE_CNT-1
+ * @return int 
+ */
+extern int eh_event_cb_register_lane(eh_event_t *e, eh_event_cb_trigger_t *trigger, int lane);
+
+/**
+ * @brief                   设置通道每批处理的事件个数，默认为EH_CONFIG_EVENT_CALLBACK_LANE_BATCH_SIZE(未定义时为8)
+ *                           通道任务正在等待时，新值在其下一次等待时生效
+ * @param  lane             通道号
+ * @param  batch_size       每批处理的事件个数 1~EH_CONFIG_EVENT_CALLBACK_LANE_BATCH_SIZE_MAX(未定义时为32)
+ * @return int 
+ */
+extern int eh_event_cb_lane_set_batch_size(int lane, int batch_size);
+
 /**
  * @brief                   注销一个事件触发器
  *                           注销事件触发器并不会影响事件触发器与槽函数的连接
@@ -42,20 +42,6 @@ struct eh{
     unsigned    long                     dispatch_cnt;                                          /* 调度次数 */
 };
 
-/* 事件接收器  */
-struct eh_event_receptor{
-    struct eh_list_head                 list_node;
-    struct eh_task                      *wakeup_task;           /* 被唤醒的任务            */
-    union{
-        uint32_t                            flags;
-        struct{
-            uint32_t                     trigger:1;
-            uint32_t                     error:1;
-        };
-    };
-    struct eh_epoll                     *epoll;
-};
-
 struct eh_task{
     const char                          *name;               
     struct eh_list_head                 task_list_node;          /* 任务链表,可被挂载到就绪，等待，完成等链表上 */
@@ -79,18 +65,12 @@ struct eh_task{
     
 };
 
-struct eh_event_epoll_receptor{
-    struct eh_rbtree_node               rb_node;
-    struct eh_list_head                 pending_list_node;
-    eh_event_t                          *event;
-    void                                *userdata;
-    struct eh_event_receptor            receptor;
-};
-
 struct eh_epoll{
     struct eh_list_head                 pending_list_head;
-    struct eh_rbtree_root               all_receptor_tree;
-    struct eh_task                      *wakeup_task;           /* 被唤醒的任务            */
+    struct eh_list_head                 all_receptor_list_head;   /* 所有注册的接收器 */
+    struct eh_rbtree_root               all_receptor_tree;        /* eh_epoll_add_event添加的接收器，以事件指针为键 */
+    struct eh_list_head                 waiter_list_head;       /* 空闲的等待任务，先进先出 */
+    bool                                idle_break;             /* 有待处理项而没有等待者时打断空闲，用于在eh_poll中检查的epoll */
 };
 
 extern eh_t _global_eh;
@@ -102,6 +82,13 @@ extern eh_t _global_eh;
  */
 extern void eh_timer_check(void);
 
+/**
+ * @brief                   不等待地只读取指定事件的就绪项，其他就绪项保持不变，
+ *                          只用于eh_epoll_add_event以默认模式添加的事件
+ * @return int              读到返回1，事件未就绪或未注册返回0
+ */
+extern int eh_epoll_pending_read_event(eh_epoll_t epoll, eh_event_t *e, eh_epoll_slot_t *epool_slot);
+
 /**
  * @brief  获取第一个定时器剩余时间
  * @return eh_sclock_t 
@@ -0,0 +1,57 @@
+/**
+ * @file eh_rwlock.h
+ * @brief 任务读写锁的实现，适用于读多写少的共享资源，多个读者可同时持有锁，
+ *    写者独占，可选择写者优先来避免写者饥饿。
+ *      使用限制: 此模块所有的函数都只能在协程上下文中使用，
+ *      也就是说，不要在中断上下文，或者其他线程上下文中调用本函数
+ * @author simon.xiaoapeng (simon.xiaoapeng@gmail.com)
+ * @version 1.0
+ * @date 2024-08-10
+ * 
+ * @copyright Copyright (c) 2024  simon.xiaoapeng@gmail.com
+ * 
+ * @par 修改日志:
+ */
+
+
+#ifndef _EH_RWLOCK_H_
+#define _EH_RWLOCK_H_
+
+typedef int* eh_rwlock_t;
+
+#ifdef __cplusplus
+#if __cplusplus
+extern "C"{
+#endif
+#endif /* __cplusplus */
+
+enum eh_rwlock_type {
+    EH_RWLOCK_TYPE_READER_PREFER,               /* 读者优先，有读者持有锁时新读者可直接进入 */
+    EH_RWLOCK_TYPE_WRITER_PREFER,               /* 写者优先，有写者在等待时新读者需要排队 */
+    EH_RWLOCK_TYPE_MAX
+};
+
+
+extern eh_rwlock_t eh_rwlock_create(enum eh_rwlock_type type);
+extern void eh_rwlock_destroy(eh_rwlock_t rwlock);
+extern int __async__ eh_rwlock_rdlock(eh_rwlock_t rwlock, eh_sclock_t timeout);
+extern int __async__ eh_rwlock_wrlock(eh_rwlock_t rwlock, eh_sclock_t timeout);
+
+/**
+ * @brief                   解锁，读锁和写锁均使用此函数解锁
+ *                          写锁释放时，若有读者在等待(写者优先时为没有写者在等待)，
+ *                          通过一次通知唤醒所有等待的读者，否则只唤醒一个写者
+ * @param  rwlock           读写锁句柄
+ * @return int              见eh_error.h
+ */
+extern int eh_rwlock_unlock(eh_rwlock_t rwlock);
+
+
+#ifdef __cplusplus
+#if __cplusplus
+}
+#endif
+#endif /* __cplusplus */
+
+
+#endif // _EH_RWLOCK_H_
@@ -101,12 +101,24 @@ typedef eh_event_cb_slot_t eh_signal_slot_t;
         eh_event_init(&(signal)->event);                                                \
     }while(0)
 
+/**
+ * @brief 设置信号槽函数的调用方式(enum eh_event_cb_mode)，需在注册前设置
+ */
+#define eh_signal_set_mode(signal, mode)                                                \
+    eh_event_cb_trigger_set_mode(&(signal)->trigger, mode)
+
 /**
  * @brief 信号注册，只有注册的信号才能正常回调槽函数
  */
 #define eh_signal_register(signal)                                                      \
     eh_event_cb_register((&(signal)->event), &(signal)->trigger)
 
+/**
+ * @brief 信号注册并指定槽函数的调度通道，见eh_event_cb_register_lane
+ */
+#define eh_signal_register_lane(signal, lane)                                           \
+    eh_event_cb_register_lane((&(signal)->event), &(signal)->trigger, lane)
+
 /**
  * @brief 信号注销，注销后无法再回调槽函数
  */
@@ -157,10 +169,11 @@ typedef eh_event_cb_slot_t eh_signal_slot_t;
     eh_event_cb_disconnect(slot)
 
 /**
- * @brief 触发信号
+ * @brief 触发信号，EH_EVENT_CB_MODE_DIRECT模式的信号返回前槽函数已执行完毕，只能在调度器所在线程调用，
+ *        EH_EVENT_CB_MODE_TASK/EH_EVENT_CB_MODE_DEFERRED模式的信号可在任意线程调用
  */
 #define eh_signal_notify(signal)                                                        \
-    eh_event_notify((&(signal)->event))
+    eh_event_cb_notify((&(signal)->event), &(signal)->trigger)
 
 
 #ifdef __cplusplus
@@ -0,0 +1,138 @@
+/**
+ * @file eh_signal_queue.h
+ * @brief 带负载的排队信号，普通信号在分发前的多次触发会合并为一次槽函数调用，
+ *    排队信号为每次触发保存一份负载，放入有界队列中，槽函数按批次取得全部负载，不会丢失中间值。
+ *    不超过EH_SIGNAL_QUEUE_INLINE_SIZE的负载直接存放在队列项中，
+ *    更大的负载从创建时分配的内存块池中分配，队列满或内存块耗尽时触发失败并计入丢弃计数。
+ *    可在任意线程中调用eh_signal_queue_notify。
+ * @author simon.xiaoapeng (simon.xiaoapeng@gmail.com)
+ * @version 1.0
+ * @date 2024-08-18
+ *
+ * @copyright Copyright (c) 2024  simon.xiaoapeng@gmail.com
+ *
+ * @par 修改日志:
+ */
+
+#ifndef _EH_SIGNAL_QUEUE_H_
+#define _EH_SIGNAL_QUEUE_H_
+
+#include <stdint.h>
+#include "eh_config.h"
+#include "eh_types.h"
+#include "eh_event.h"
+#include "eh_event_cb.h"
+#include "eh_signal.h"
+
+#ifdef __cplusplus
+#if __cplusplus
+extern "C"{
+#endif
+#endif /* __cplusplus */
+
+/* 直接存放在队列项中的负载大小上限，超过的负载从内存块池中分配 */
+#if defined(EH_CONFIG_SIGNAL_QUEUE_INLINE_SIZE)
+#define EH_SIGNAL_QUEUE_INLINE_SIZE         EH_CONFIG_SIGNAL_QUEUE_INLINE_SIZE
+#else
+#define EH_SIGNAL_QUEUE_INLINE_SIZE         16
+#endif
+
+/* 每批交给槽函数的负载个数上限 */
+#if defined(EH_CONFIG_SIGNAL_QUEUE_BATCH_SIZE)
+#define EH_SIGNAL_QUEUE_BATCH_SIZE          EH_CONFIG_SIGNAL_QUEUE_BATCH_SIZE
+#else
+#define EH_SIGNAL_QUEUE_BATCH_SIZE          16
+#endif
+
+typedef struct eh_signal_queue eh_signal_queue_t;
+
+typedef struct eh_signal_payload{
+    const void                      *buf;
+    uint32_t                        len;
+}eh_signal_payload_t;
+
+/**
+ * @brief                           创建排队信号
+ * @param  capacity                 队列可容纳的负载个数
+ * @param  max_payload_size         单个负载的最大长度
+ * @param  pool_cnt                 大于EH_SIGNAL_QUEUE_INLINE_SIZE的负载可同时存在的个数，
+ *                                  max_payload_size不超过EH_SIGNAL_QUEUE_INLINE_SIZE时忽略
+ * @return eh_signal_queue_t*       返回值请使用eh_ptr_to_error来判断是否创建成功
+ */
+extern eh_signal_queue_t* eh_signal_queue_create(uint32_t capacity, uint32_t max_payload_size, uint32_t pool_cnt);
+
+/**
+ * @brief                           销毁排队信号，会先注销并断开所有槽
+ * @param  sq                       排队信号
+ */
+extern void eh_signal_queue_destroy(eh_signal_queue_t *sq);
+
+/**
+ * @brief                           设置槽函数的调用方式(enum eh_event_cb_mode)，需在注册前设置
+ */
+extern void eh_signal_queue_set_mode(eh_signal_queue_t *sq, enum eh_event_cb_mode mode);
+
+/**
+ * @brief                           排队信号注册，见eh_event_cb_register_lane
+ * @param  sq                       排队信号
+ * @param  lane                     通道号
+ * @return int                      见eh_error.h
+ */
+extern int eh_signal_queue_register_lane(eh_signal_queue_t *sq, int lane);
+
+/**
+ * @brief                           排队信号注册，使用0号通道
+ */
+#define eh_signal_queue_register(sq)    eh_signal_queue_register_lane(sq, 0)
+
+/**
+ * @brief                           排队信号注销，已入队的负载保留到再次注册后分发
+ * @param  sq                       排队信号
+ * @return int                      见eh_error.h
+ */
+extern int eh_signal_queue_unregister(eh_signal_queue_t *sq);
+
+/**
+ * @brief                           连接排队信号和槽，槽函数中使用eh_signal_queue_batch获取本批负载，
+ *                                  断开使用eh_signal_slot_disconnect
+ * @param  sq                       排队信号
+ * @param  slot                     槽
+ * @return int                      槽已连接时返回EH_RET_BUSY
+ */
+extern int eh_signal_queue_slot_connect(eh_signal_queue_t *sq, eh_signal_slot_t *slot);
+
+/**
+ * @brief                           复制一份负载入队并触发信号，可在任意线程调用，
+ *                                  EH_EVENT_CB_MODE_DIRECT模式下只能在调度器所在线程调用
+ * @param  sq                       排队信号
+ * @param  payload                  负载
+ * @param  len                      负载长度，不能超过max_payload_size
+ * @return int                      成功返回EH_RET_OK，队列满或内存块耗尽返回EH_RET_BUSY，
+ *                                  长度超出返回EH_RET_INVALID_PARAM
+ */
+extern __safety int eh_signal_queue_notify(eh_signal_queue_t *sq, const void *payload, uint32_t len);
+
+/**
+ * @brief                           获取本批负载，只能在该排队信号的槽函数中调用，
+ *                                  同一批负载会依次交给所有连接的槽，槽函数返回后负载被释放
+ * @param  sq                       排队信号
+ * @param  payloads                 输出参数，负载数组，最多EH_SIGNAL_QUEUE_BATCH_SIZE个
+ * @return int                      负载个数
+ */
+extern int eh_signal_queue_batch(eh_signal_queue_t *sq, const eh_signal_payload_t **payloads);
+
+/**
+ * @brief                           获取因队列满或内存块耗尽被丢弃的负载个数
+ * @param  sq                       排队信号
+ * @return uint32_t
+ */
+extern uint32_t eh_signal_queue_dropped(eh_signal_queue_t *sq);
+
+#ifdef __cplusplus
+#if __cplusplus
+}
+#endif
+#endif /* __cplusplus */
+
+
+#endif // _EH_SIGNAL_QUEUE_H_
@@ -0,0 +1,128 @@
+/**
+ * @file eh_waitq.h
+ * @brief 带键值的等待队列，每个等待者注册一个键值或匹配函数，
+ *    通知者只唤醒匹配的等待者，或按先后顺序唤醒指定个数的等待者并直接交接数据，
+ *    被唤醒的等待者无需再次检查条件，避免 eh_event_notify 唤醒全部任务后大部分任务又重新睡眠的问题
+ * @author simon.xiaoapeng (simon.xiaoapeng@gmail.com)
+ * @version 1.0
+ * @date 2024-08-12
+ * 
+ * @copyright Copyright (c) 2024  simon.xiaoapeng@gmail.com
+ * 
+ * @par 修改日志:
+ */
+#ifndef _EH_WAITQ_H_
+#define _EH_WAITQ_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "eh_types.h"
+#include "eh_event.h"
+
+#ifdef __cplusplus
+#if __cplusplus
+extern "C"{
+#endif
+#endif /* __cplusplus */
+
+typedef struct eh_waitq                     eh_waitq_t;
+
+/* 唤醒时使用此键值可匹配任意等待者 */
+#define EH_WAITQ_KEY_ANY                    ((uintptr_t)-1)
+
+/* 唤醒全部匹配的等待者 */
+#define EH_WAITQ_WAKE_ALL                   (-1)
+
+struct eh_waitq{
+    eh_event_t                          event;              /* 接收器链表上按先后顺序挂着等待者 */
+    struct eh_list_head                 handoff_list_head;  /* 已被唤醒但还未运行的等待者，清除时需改为错误 */
+};
+
+#define EH_WAITQ_INIT(wq) {                                                         \
+        .event = EH_EVENT_INIT(wq.event),                                           \
+        .handoff_list_head = EH_LIST_HEAD_INIT(wq.handoff_list_head),               \
+    }
+
+/**
+ * @brief                           定义并初始化一个等待队列
+ */
+#define EH_DEFINE_WAITQ(wq_name)    eh_waitq_t wq_name = EH_WAITQ_INIT(wq_name)
+
+/**
+ * @brief                           等待队列初始化
+ * @param  wq                       等待队列
+ */
+static inline __safety int eh_waitq_init(eh_waitq_t *wq){
+    eh_list_head_init(&wq->handoff_list_head);
+    return eh_event_init(&wq->event);
+}
+
+/**
+ * @brief                           唤醒全部等待者并返回EH_RET_EVENT_ERROR，释放等待队列前调用，
+ *                                  已被eh_waitq_wake唤醒但还未运行的等待者同样返回EH_RET_EVENT_ERROR
+ * @param  wq                       等待队列
+ */
+extern __safety void eh_waitq_clean(eh_waitq_t *wq);
+
+/**
+ * @brief                           使用匹配函数进行等待
+ * @param  wq                       等待队列
+ * @param  match                    匹配函数，在唤醒者的上下文中被调用(持有临界区)，禁止任何形式的await
+ * @param  match_arg                匹配函数的参数
+ * @param  value                    被唤醒时唤醒者交接的数据，可为NULL
+ * @param  timeout                  超时时间,EH_TIME_FOREVER为永不超时
+ * @return int                      见eh_error.h
+ */
+extern int __async__ eh_waitq_wait_match(eh_waitq_t *wq, bool (*match)(void *match_arg, uintptr_t key),
+        void *match_arg, void **value, eh_sclock_t timeout);
+
+/**
+ * @brief                           在指定键值上等待
+ * @param  wq                       等待队列
+ * @param  key                      键值
+ * @param  value                    被唤醒时唤醒者交接的数据，可为NULL
+ * @param  timeout                  超时时间,EH_TIME_FOREVER为永不超时
+ * @return int                      见eh_error.h
+ */
+extern int __async__ eh_waitq_wait(eh_waitq_t *wq, uintptr_t key, void **value, eh_sclock_t timeout);
+
+/**
+ * @brief                           在指定键值上等待，condition与加入队列在同一个临界区内被检查，
+ *                                  若返回true则直接返回EH_RET_OK(value被置为NULL)，用于实现无丢失唤醒的资源获取，
+ *                                  其他线程的唤醒者也需在临界区内更新condition依赖的资源
+ * @param  wq                       等待队列
+ * @param  key                      键值
+ * @param  condition                条件函数，禁止任何形式的await
+ * @param  arg                      condition的参数
+ * @param  value                    被唤醒时唤醒者交接的数据，可为NULL
+ * @param  timeout                  超时时间,EH_TIME_FOREVER为永不超时
+ * @return int                      见eh_error.h
+ */
+extern int __async__ eh_waitq_wait_condition(eh_waitq_t *wq, uintptr_t key, bool (*condition)(void *arg), 
+        void *arg, void **value, eh_sclock_t timeout);
+
+/**
+ * @brief                           按等待先后顺序唤醒匹配键值的等待者，并将value交给它们，
+ *                                  被唤醒的等待者直接从队列中移除，在它运行之前eh_waitq_clean仍会使其返回EH_RET_EVENT_ERROR
+ * @param  wq                       等待队列
+ * @param  key                      键值，EH_WAITQ_KEY_ANY匹配所有等待者
+ * @param  num                      最多唤醒个数，EH_WAITQ_WAKE_ALL为全部
+ * @param  value                    交接给等待者的数据
+ * @return int                      返回被唤醒的个数
+ */
+extern __safety int eh_waitq_wake(eh_waitq_t *wq, uintptr_t key, int num, void *value);
+
+/**
+ * @brief                           是否有等待者
+ * @param  wq                       等待队列
+ */
+extern __safety bool eh_waitq_has_waiter(eh_waitq_t *wq);
+
+#ifdef __cplusplus
+#if __cplusplus
+}
+#endif
+#endif /* __cplusplus */
+
+
+#endif // _EH_WAITQ_H_
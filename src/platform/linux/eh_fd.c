@@ -0,0 +1,613 @@
+/**
+ * @file eh_fd.c
+ * @brief linux下基于epoll_hub的异步文件描述符IO，
+ *    每个fd对应一个上下文，以fd为下标存放在按需扩大的表中，
+ *    就绪状态缓存在epoll_hub的action中，回调只负责通知上下文中的事件，
+ *    系统调用返回EAGAIN时清除对应的就绪状态后再等待，边沿触发不会丢失就绪通知。
+ *    已知被读空(写满)且之后没有新边沿的fd，再次读写时跳过必然返回EAGAIN的系统调用直接等待，
+ *    流式fd上读写的长度不足时同样说明缓冲区已被读空(写满)。
+ * @author simon.xiaoapeng (simon.xiaoapeng@gmail.com)
+ * @version 1.0
+ * @date 2024-08-20
+ *
+ * @copyright Copyright (c) 2024  simon.xiaoapeng@gmail.com
+ *
+ * @par 修改日志:
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include "eh.h"
+#include "eh_error.h"
+#include "eh_event.h"
+#include "eh_mem.h"
+#include "eh_platform.h"
+#include "eh_timer.h"
+#include "eh_module.h"
+#include "epoll_hub.h"
+#include "eh_fd.h"
+
+#define EH_FD_TABLE_MIN_SIZE        64
+
+struct eh_fd_ctx {
+    struct epoll_fd_action      action;             /* action.revents为已就绪且还未遇到EAGAIN的事件 */
+    eh_event_t                  event;
+    uint32_t                    drained;            /* 确认不可读写且之后还没有新边沿的事件 */
+    bool                        stream;             /* 管道或流式socket，读写长度不足说明已读空(写满) */
+    dev_t                       dev;                /* 注册时fd指向的文件，用于发现未经eh_close关闭后被复用的fd号 */
+    ino_t                       ino;
+};
+
+struct eh_fd_wait_ctx {
+    struct eh_fd_ctx            *ctx;
+    uint32_t                    events;
+};
+
+static struct {
+    struct eh_fd_ctx            **table;
+    int                         size;
+    uint64_t                    again_cnt;
+    uint64_t                    skip_cnt;
+}eh_fd;
+
+static void _eh_fd_callback(uint32_t events, void *arg){
+    struct eh_fd_ctx *ctx = (struct eh_fd_ctx *)arg;
+    if(events & (EPOLLERR | EPOLLHUP))
+        events |= EPOLLIN | EPOLLOUT;
+    if(events & EPOLLRDHUP)
+        events |= EPOLLIN;
+    events &= EPOLLIN | EPOLLOUT;
+    ctx->action.revents |= events;
+    ctx->drained &= ~events;
+    eh_event_notify(&ctx->event);
+}
+
+static int _eh_fd_table_grow(int fd){
+    struct eh_fd_ctx **table;
+    int size = eh_fd.size ? eh_fd.size : EH_FD_TABLE_MIN_SIZE;
+    while(size <= fd)
+        size *= 2;
+    table = eh_malloc(sizeof(struct eh_fd_ctx *) * (size_t)size);
+    if(table == NULL)
+        return EH_RET_MALLOC_ERROR;
+    memset(table, 0, sizeof(struct eh_fd_ctx *) * (size_t)size);
+    if(eh_fd.table){
+        memcpy(table, eh_fd.table, sizeof(struct eh_fd_ctx *) * (size_t)eh_fd.size);
+        eh_free(eh_fd.table);
+    }
+    eh_fd.table = table;
+    eh_fd.size = size;
+    return EH_RET_OK;
+}
+
+static struct eh_fd_ctx* _eh_fd_ctx(int fd){
+    if(fd < 0 || fd >= eh_fd.size)
+        return NULL;
+    return eh_fd.table[fd];
+}
+
+static bool _eh_fd_is_stream(int fd, const struct stat *st){
+    int type;
+    socklen_t optlen = sizeof(type);
+    if(S_ISFIFO(st->st_mode))
+        return true;
+    if(!S_ISSOCK(st->st_mode))
+        return false;
+    return getsockopt(fd, SOL_SOCKET, SO_TYPE, &type, &optlen) == 0 && type == SOCK_STREAM;
+}
+
+/**
+ * @brief                           设置为非阻塞并以边沿触发方式加入epoll_hub，清除所有缓存的就绪状态，
+ *                                  加入时已经就绪的fd会在下一次epoll_hub_poll中报告一次边沿
+ */
+static int _eh_fd_ctx_setup(int fd, struct eh_fd_ctx *ctx, const struct stat *st){
+    int flags;
+    flags = fcntl(fd, F_GETFL);
+    if(flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0)
+        return EH_RET_INVALID_PARAM;
+    ctx->action.revents = 0;
+    ctx->drained = 0;
+    ctx->stream = _eh_fd_is_stream(fd, st);
+    ctx->dev = st->st_dev;
+    ctx->ino = st->st_ino;
+    if(epoll_hub_add_fd(fd, EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET, &ctx->action) < 0)
+        return EH_RET_FAULT;
+    return EH_RET_OK;
+}
+
+/**
+ * @brief                           fd被直接close后内核已将其移出epoll，复用该fd号的新文件不会产生任何通知，
+ *                                  挂起等待前检查fd是否还指向注册时的文件，不是时为新文件重新注册，
+ *                                  只在即将挂起时检查，不影响直接成功的读写
+ */
+static int _eh_fd_revalidate(int fd, struct eh_fd_ctx *ctx){
+    struct stat st;
+    if(fstat(fd, &st) < 0)
+        return EH_RET_INVALID_PARAM;
+    if(st.st_dev == ctx->dev && st.st_ino == ctx->ino)
+        return EH_RET_OK;
+    /* 旧文件若还被dup的fd引用，其注册项仍指向同一个ctx，只会带来多余的唤醒 */
+    epoll_hub_del_fd(fd);
+    return _eh_fd_ctx_setup(fd, ctx, &st);
+}
+
+int eh_fd_register(int fd){
+    struct eh_fd_ctx *ctx;
+    struct stat st;
+    int ret;
+    if(fd < 0)
+        return EH_RET_INVALID_PARAM;
+    if(_eh_fd_ctx(fd))
+        return EH_RET_OK;
+    if(fd >= eh_fd.size){
+        ret = _eh_fd_table_grow(fd);
+        if(ret < 0)
+            return ret;
+    }
+    if(fstat(fd, &st) < 0)
+        return EH_RET_INVALID_PARAM;
+    ctx = eh_malloc(sizeof(struct eh_fd_ctx));
+    if(ctx == NULL)
+        return EH_RET_MALLOC_ERROR;
+    ctx->action.callback = _eh_fd_callback;
+    ctx->action.arg = ctx;
+    eh_event_init(&ctx->event);
+    ret = _eh_fd_ctx_setup(fd, ctx, &st);
+    if(ret < 0){
+        eh_event_clean(&ctx->event);
+        eh_free(ctx);
+        return ret;
+    }
+    eh_fd.table[fd] = ctx;
+    return EH_RET_OK;
+}
+
+void eh_fd_unregister(int fd){
+    struct eh_fd_ctx *ctx = _eh_fd_ctx(fd);
+    if(ctx == NULL)
+        return ;
+    eh_fd.table[fd] = NULL;
+    epoll_hub_del_fd(fd);
+    eh_event_clean(&ctx->event);
+    eh_free(ctx);
+}
+
+static bool _eh_fd_is_ready(void *arg){
+    struct eh_fd_wait_ctx *wait_ctx = (struct eh_fd_wait_ctx *)arg;
+    return (wait_ctx->ctx->action.revents & wait_ctx->events) != 0;
+}
+
+int __async__ eh_fd_wait(int fd, uint32_t events, eh_sclock_t timeout){
+    struct eh_fd_wait_ctx wait_ctx;
+    int ret;
+    events &= EPOLLIN | EPOLLOUT;
+    if(events == 0)
+        return EH_RET_INVALID_PARAM;
+    ret = eh_fd_register(fd);
+    if(ret < 0)
+        return ret;
+    wait_ctx.ctx = _eh_fd_ctx(fd);
+    ret = _eh_fd_revalidate(fd, wait_ctx.ctx);
+    if(ret < 0)
+        return ret;
+    wait_ctx.events = events;
+    ret = __await__ eh_event_wait_condition_timeout(&wait_ctx.ctx->event, &wait_ctx, _eh_fd_is_ready, timeout);
+    if(ret < 0)
+        return ret;
+    return (int)(wait_ctx.ctx->action.revents & events);
+}
+
+/**
+ * @brief                           将eh_fd_register/eh_fd_wait的返回值转换为errno
+ */
+static int _eh_fd_errno(int ret){
+    if(ret == EH_RET_TIMEOUT)
+        return ETIMEDOUT;
+    if(ret == EH_RET_MALLOC_ERROR)
+        return ENOMEM;
+    /* epoll_ctl失败，如fd不支持epoll(普通文件) */
+    if(ret == EH_RET_FAULT)
+        return EINVAL;
+    return EBADF;
+}
+
+/**
+ * @brief                           系统调用返回EAGAIN后调用，清除就绪状态并等待，
+ *                                  timeout为0时直接以EAGAIN失败，否则最多等待到deadline
+ * @return int                      可以重试返回0，否则返回-1并设置errno
+ */
+static int __async__ _eh_fd_wait_again(int fd, uint32_t event, eh_sclock_t timeout, eh_clock_t deadline){
+    struct eh_fd_ctx *ctx;
+    eh_clock_t now;
+    int ret;
+    if(timeout == 0){
+        errno = EAGAIN;
+        return -1;
+    }
+    ret = eh_fd_register(fd);
+    if(ret < 0){
+        errno = _eh_fd_errno(ret);
+        return -1;
+    }
+    ctx = _eh_fd_ctx(fd);
+    ctx->action.revents &= ~event;
+    ctx->drained |= event;
+    if(!eh_time_is_forever(timeout)){
+        now = eh_get_clock_monotonic_time();
+        timeout = (eh_sclock_t)(deadline - now);
+        if(timeout <= 0){
+            errno = ETIMEDOUT;
+            return -1;
+        }
+    }
+    ret = __await__ eh_fd_wait(fd, event, timeout);
+    if(ret >= 0)
+        return 0;
+    errno = _eh_fd_errno(ret);
+    return -1;
+}
+
+/**
+ * @brief                           fd已知不可读写时跳过系统调用，
+ *                                  timeout为0时不会等待，依然尝试一次系统调用
+ */
+static bool _eh_fd_skip(int fd, uint32_t event, eh_sclock_t timeout){
+    struct eh_fd_ctx *ctx;
+    if(timeout == 0)
+        return false;
+    ctx = _eh_fd_ctx(fd);
+    if(ctx == NULL || !(ctx->drained & event))
+        return false;
+    eh_fd.skip_cnt++;
+    return true;
+}
+
+/**
+ * @brief                           流式fd上读写的长度不足，说明缓冲区已被读空(写满)，
+ *                                  之后到来的数据(空间)会产生新的边沿
+ */
+static void _eh_fd_short(int fd, uint32_t event, ssize_t ret, size_t len){
+    struct eh_fd_ctx *ctx;
+    if(ret <= 0 || (size_t)ret >= len)
+        return ;
+    ctx = _eh_fd_ctx(fd);
+    if(ctx == NULL || !ctx->stream)
+        return ;
+    ctx->action.revents &= ~event;
+    ctx->drained |= event;
+}
+
+/**
+ * @brief                           非阻塞的recvmmsg在接收队列取空时才会提前返回，
+ *                                  收到的报文数不足说明已读空，与fd类型无关
+ */
+static void _eh_fd_short_batch(int fd, int ret, unsigned int vlen){
+    struct eh_fd_ctx *ctx;
+    if(ret <= 0 || (unsigned int)ret >= vlen)
+        return ;
+    ctx = _eh_fd_ctx(fd);
+    if(ctx == NULL)
+        return ;
+    ctx->action.revents &= ~(uint32_t)EPOLLIN;
+    ctx->drained |= EPOLLIN;
+}
+
+#define eh_fd_deadline(timeout)                                                 \
+    (eh_time_is_forever(timeout) ? 0 : eh_get_clock_monotonic_time() + (eh_clock_t)(timeout))
+
+ssize_t __async__ eh_read(int fd, void *buf, size_t len, eh_sclock_t timeout){
+    eh_clock_t deadline = eh_fd_deadline(timeout);
+    ssize_t ret;
+    for(;;){
+        if(!_eh_fd_skip(fd, EPOLLIN, timeout)){
+            ret = read(fd, buf, len);
+            if(ret >= 0){
+                _eh_fd_short(fd, EPOLLIN, ret, len);
+                return ret;
+            }
+            if(errno != EAGAIN)
+                return ret;
+            eh_fd.again_cnt++;
+        }
+        if(__await__ _eh_fd_wait_again(fd, EPOLLIN, timeout, deadline) < 0)
+            return -1;
+    }
+}
+
+ssize_t __async__ eh_write(int fd, const void *buf, size_t len, eh_sclock_t timeout){
+    eh_clock_t deadline = eh_fd_deadline(timeout);
+    ssize_t ret;
+    for(;;){
+        if(!_eh_fd_skip(fd, EPOLLOUT, timeout)){
+            ret = write(fd, buf, len);
+            if(ret >= 0){
+                _eh_fd_short(fd, EPOLLOUT, ret, len);
+                return ret;
+            }
+            if(errno != EAGAIN)
+                return ret;
+            eh_fd.again_cnt++;
+        }
+        if(__await__ _eh_fd_wait_again(fd, EPOLLOUT, timeout, deadline) < 0)
+            return -1;
+    }
+}
+
+static size_t _eh_iov_len(const struct iovec *iov, int iovcnt){
+    size_t len = 0;
+    for(int i = 0; i < iovcnt; i++)
+        len += iov[i].iov_len;
+    return len;
+}
+
+ssize_t __async__ eh_readv(int fd, const struct iovec *iov, int iovcnt, eh_sclock_t timeout){
+    eh_clock_t deadline = eh_fd_deadline(timeout);
+    ssize_t ret;
+    for(;;){
+        if(!_eh_fd_skip(fd, EPOLLIN, timeout)){
+            ret = readv(fd, iov, iovcnt);
+            if(ret >= 0){
+                _eh_fd_short(fd, EPOLLIN, ret, _eh_iov_len(iov, iovcnt));
+                return ret;
+            }
+            if(errno != EAGAIN)
+                return ret;
+            eh_fd.again_cnt++;
+        }
+        if(__await__ _eh_fd_wait_again(fd, EPOLLIN, timeout, deadline) < 0)
+            return -1;
+    }
+}
+
+ssize_t __async__ eh_writev(int fd, const struct iovec *iov, int iovcnt, eh_sclock_t timeout){
+    eh_clock_t deadline = eh_fd_deadline(timeout);
+    ssize_t ret;
+    for(;;){
+        if(!_eh_fd_skip(fd, EPOLLOUT, timeout)){
+            ret = writev(fd, iov, iovcnt);
+            if(ret >= 0){
+                _eh_fd_short(fd, EPOLLOUT, ret, _eh_iov_len(iov, iovcnt));
+                return ret;
+            }
+            if(errno != EAGAIN)
+                return ret;
+            eh_fd.again_cnt++;
+        }
+        if(__await__ _eh_fd_wait_again(fd, EPOLLOUT, timeout, deadline) < 0)
+            return -1;
+    }
+}
+
+ssize_t __async__ eh_recv(int fd, void *buf, size_t len, int flags, eh_sclock_t timeout){
+    eh_clock_t deadline = eh_fd_deadline(timeout);
+    ssize_t ret;
+    for(;;){
+        if(!_eh_fd_skip(fd, EPOLLIN, timeout)){
+            ret = recv(fd, buf, len, flags);
+            if(ret >= 0){
+                if(!(flags & MSG_PEEK))
+                    _eh_fd_short(fd, EPOLLIN, ret, len);
+                return ret;
+            }
+            if(errno != EAGAIN)
+                return ret;
+            eh_fd.again_cnt++;
+        }
+        if(__await__ _eh_fd_wait_again(fd, EPOLLIN, timeout, deadline) < 0)
+            return -1;
+    }
+}
+
+ssize_t __async__ eh_send(int fd, const void *buf, size_t len, int flags, eh_sclock_t timeout){
+    eh_clock_t deadline = eh_fd_deadline(timeout);
+    ssize_t ret;
+    for(;;){
+        if(!_eh_fd_skip(fd, EPOLLOUT, timeout)){
+            ret = send(fd, buf, len, flags | MSG_NOSIGNAL);
+            if(ret >= 0){
+                _eh_fd_short(fd, EPOLLOUT, ret, len);
+                return ret;
+            }
+            if(errno != EAGAIN)
+                return ret;
+            eh_fd.again_cnt++;
+        }
+        if(__await__ _eh_fd_wait_again(fd, EPOLLOUT, timeout, deadline) < 0)
+            return -1;
+    }
+}
+
+int __async__ eh_recvmmsg(int fd, struct mmsghdr *msgvec, unsigned int vlen, int flags, eh_sclock_t timeout){
+    eh_clock_t deadline = eh_fd_deadline(timeout);
+    int ret;
+    for(;;){
+        if(!_eh_fd_skip(fd, EPOLLIN, timeout)){
+            ret = recvmmsg(fd, msgvec, vlen, flags, NULL);
+            if(ret >= 0){
+                if(!(flags & MSG_PEEK))
+                    _eh_fd_short_batch(fd, ret, vlen);
+                return ret;
+            }
+            if(errno != EAGAIN)
+                return ret;
+            eh_fd.again_cnt++;
+        }
+        if(__await__ _eh_fd_wait_again(fd, EPOLLIN, timeout, deadline) < 0)
+            return -1;
+    }
+}
+
+int __async__ eh_sendmmsg(int fd, struct mmsghdr *msgvec, unsigned int vlen, int flags, eh_sclock_t timeout){
+    eh_clock_t deadline = eh_fd_deadline(timeout);
+    int ret;
+    /* sendmmsg在某个报文出错时也会提前返回，发送数不足不能说明缓冲区已满 */
+    for(;;){
+        if(!_eh_fd_skip(fd, EPOLLOUT, timeout)){
+            ret = sendmmsg(fd, msgvec, vlen, flags | MSG_NOSIGNAL);
+            if(ret >= 0 || errno != EAGAIN)
+                return ret;
+            eh_fd.again_cnt++;
+        }
+        if(__await__ _eh_fd_wait_again(fd, EPOLLOUT, timeout, deadline) < 0)
+            return -1;
+    }
+}
+
+ssize_t __async__ eh_sendfile(int out_fd, int in_fd, off_t *offset, size_t count, eh_sclock_t timeout){
+    eh_clock_t deadline = eh_fd_deadline(timeout);
+    ssize_t ret;
+    /* in_fd必须支持mmap(普通文件)，不会返回EAGAIN，只需要等待out_fd可写 */
+    for(;;){
+        if(!_eh_fd_skip(out_fd, EPOLLOUT, timeout)){
+            ret = sendfile(out_fd, in_fd, offset, count);
+            if(ret >= 0 || errno != EAGAIN)
+                return ret;
+            eh_fd.again_cnt++;
+        }
+        if(__await__ _eh_fd_wait_again(out_fd, EPOLLOUT, timeout, deadline) < 0)
+            return -1;
+    }
+}
+
+/**
+ * @brief                           splice/tee返回EAGAIN时不能区分是哪一端造成的，
+ *                                  用一次不等待的poll找出还未就绪的一端再等待它，
+ *                                  两端都已就绪(如管道剩余空间不足一页)时让出一次CPU后重试，已到deadline时以ETIMEDOUT失败，
+ *                                  普通文件始终就绪，不会被等待
+ * @return int                      可以重试返回0，否则返回-1并设置errno
+ */
+static int __async__ _eh_fd_wait_pair_again(int fd_in, int fd_out, eh_sclock_t timeout, eh_clock_t deadline){
+    struct pollfd pfd[2] = {
+        {.fd = fd_in, .events = POLLIN},
+        {.fd = fd_out, .events = POLLOUT},
+    };
+    if(timeout == 0){
+        errno = EAGAIN;
+        return -1;
+    }
+    if(poll(pfd, 2, 0) < 0)
+        return -1;
+    if(!(pfd[0].revents & (POLLIN | POLLERR | POLLHUP)))
+        return __await__ _eh_fd_wait_again(fd_in, EPOLLIN, timeout, deadline);
+    if(!(pfd[1].revents & (POLLOUT | POLLERR | POLLHUP)))
+        return __await__ _eh_fd_wait_again(fd_out, EPOLLOUT, timeout, deadline);
+    /* 两端一直就绪却一直EAGAIN时不会进入等待，需要在这里检查是否超时 */
+    if(!eh_time_is_forever(timeout) && (eh_sclock_t)(deadline - eh_get_clock_monotonic_time()) <= 0){
+        errno = ETIMEDOUT;
+        return -1;
+    }
+    __await__ eh_task_yield();
+    return 0;
+}
+
+ssize_t __async__ eh_splice(int fd_in, off_t *off_in, int fd_out, off_t *off_out, size_t len, unsigned int flags, eh_sclock_t timeout){
+    eh_clock_t deadline = eh_fd_deadline(timeout);
+    ssize_t ret;
+    for(;;){
+        ret = splice(fd_in, off_in, fd_out, off_out, len, flags | SPLICE_F_NONBLOCK);
+        if(ret >= 0 || errno != EAGAIN)
+            return ret;
+        eh_fd.again_cnt++;
+        if(__await__ _eh_fd_wait_pair_again(fd_in, fd_out, timeout, deadline) < 0)
+            return -1;
+    }
+}
+
+ssize_t __async__ eh_tee(int fd_in, int fd_out, size_t len, unsigned int flags, eh_sclock_t timeout){
+    eh_clock_t deadline = eh_fd_deadline(timeout);
+    ssize_t ret;
+    for(;;){
+        ret = tee(fd_in, fd_out, len, flags | SPLICE_F_NONBLOCK);
+        if(ret >= 0 || errno != EAGAIN)
+            return ret;
+        eh_fd.again_cnt++;
+        if(__await__ _eh_fd_wait_pair_again(fd_in, fd_out, timeout, deadline) < 0)
+            return -1;
+    }
+}
+
+int __async__ eh_accept(int fd, struct sockaddr *addr, socklen_t *addrlen, eh_sclock_t timeout){
+    eh_clock_t deadline = eh_fd_deadline(timeout);
+    int ret, err;
+    for(;;){
+        if(!_eh_fd_skip(fd, EPOLLIN, timeout)){
+            ret = accept4(fd, addr, addrlen, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if(ret >= 0){
+                err = eh_fd_register(ret);
+                if(err < 0){
+                    close(ret);
+                    errno = _eh_fd_errno(err);
+                    return -1;
+                }
+                return ret;
+            }
+            if(errno != EAGAIN)
+                return ret;
+            eh_fd.again_cnt++;
+        }
+        if(__await__ _eh_fd_wait_again(fd, EPOLLIN, timeout, deadline) < 0)
+            return -1;
+    }
+}
+
+int __async__ eh_connect(int fd, const struct sockaddr *addr, socklen_t addrlen, eh_sclock_t timeout){
+    eh_clock_t deadline = eh_fd_deadline(timeout);
+    socklen_t optlen = sizeof(int);
+    int err;
+    err = eh_fd_register(fd);
+    if(err < 0){
+        errno = _eh_fd_errno(err);
+        return -1;
+    }
+    if(connect(fd, addr, addrlen) == 0)
+        return 0;
+    if(errno != EINPROGRESS)
+        return -1;
+    /* 连接完成(或失败)时产生可写的边沿，不能使用之前缓存的就绪状态 */
+    if(__await__ _eh_fd_wait_again(fd, EPOLLOUT, timeout, deadline) < 0)
+        return -1;
+    if(getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &optlen) < 0)
+        return -1;
+    if(err){
+        errno = err;
+        return -1;
+    }
+    return 0;
+}
+
+void eh_fd_stat(uint64_t *again_cnt, uint64_t *skip_cnt){
+    if(again_cnt)
+        *again_cnt = eh_fd.again_cnt;
+    if(skip_cnt)
+        *skip_cnt = eh_fd.skip_cnt;
+}
+
+int eh_close(int fd){
+    eh_fd_unregister(fd);
+    return close(fd);
+}
+
+static int __init eh_fd_init(void){
+    eh_fd.table = NULL;
+    eh_fd.size = 0;
+    eh_fd.again_cnt = 0;
+    eh_fd.skip_cnt = 0;
+    return EH_RET_OK;
+}
+
+static void __exit eh_fd_exit(void){
+    for(int fd = 0; fd < eh_fd.size; fd++)
+        eh_fd_unregister(fd);
+    eh_free(eh_fd.table);
+    eh_fd.table = NULL;
+    eh_fd.size = 0;
+}
+
+eh_interior_module_export(eh_fd_init, eh_fd_exit);
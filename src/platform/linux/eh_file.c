@@ -0,0 +1,334 @@
+/**
+ * @file eh_file.c
+ * @brief linux下普通文件的异步IO，
+ *    所有IO都带有显式的偏移(pread/pwrite语义)，文件位置由eh_file自己维护，
+ *    _eh_file_io_*在io_uring后端下直接提交到环上，否则通过eh_offload_call在线程池中执行。
+ *    预读缓冲区保存[ra_off, ra_off + ra_len)的文件内容，只有读的起点等于上一次读的终点时才使用，
+ *    写缓冲区保存[wb_off, wb_off + wb_len)等待写出的内容，任何读之前先写出写缓冲区，任何写都会使预读缓冲区失效。
+ * @author simon.xiaoapeng (simon.xiaoapeng@gmail.com)
+ * @version 1.0
+ * @date 2024-09-06
+ *
+ * @copyright Copyright (c) 2024  simon.xiaoapeng@gmail.com
+ *
+ * @par 修改日志:
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include "eh.h"
+#include "eh_error.h"
+#include "eh_mem.h"
+#include "eh_file.h"
+#if defined(EH_CONFIG_LINUX_IO_URING)
+#include <linux/io_uring.h>
+#include "eh_uring.h"
+#else
+#include "eh_offload.h"
+#endif
+
+/* 单次IO的最大长度，io_uring的sqe长度字段为32位 */
+#define EH_FILE_IO_MAX_LEN              (1U << 30)
+
+struct eh_file{
+    int                             fd;
+    bool                            append;
+    off_t                           pos;
+    off_t                           ra_next;            /* 上一次读的终点，用于判断顺序读 */
+    uint8_t                         *ra_buf;
+    size_t                          ra_size;
+    off_t                           ra_off;
+    size_t                          ra_len;
+    uint8_t                         *wb_buf;
+    size_t                          wb_size;
+    off_t                           wb_off;
+    size_t                          wb_len;
+    struct eh_file_stat             stat;
+};
+
+#if defined(EH_CONFIG_LINUX_IO_URING)
+
+static ssize_t __async__ _eh_file_io_read(int fd, void *buf, size_t len, off_t offset){
+    return __await__ eh_uring_read(fd, buf, len, (int64_t)offset, EH_TIME_FOREVER);
+}
+
+static ssize_t __async__ _eh_file_io_write(int fd, const void *buf, size_t len, off_t offset){
+    return __await__ eh_uring_write(fd, buf, len, (int64_t)offset, EH_TIME_FOREVER);
+}
+
+static int __async__ _eh_file_io_fsync(int fd){
+    return __await__ eh_uring_fsync(fd, 0, EH_TIME_FOREVER);
+}
+
+static int __async__ _eh_file_io_open(const char *path, int flags, mode_t mode){
+    return __await__ eh_uring_openat(AT_FDCWD, path, flags, mode, EH_TIME_FOREVER);
+}
+
+#else
+
+struct eh_file_io{
+    int                             fd;
+    void                            *buf;
+    size_t                          len;
+    off_t                           offset;
+    const char                      *path;
+    int                             flags;
+    mode_t                          mode;
+};
+
+static intptr_t _eh_file_job_read(void *arg){
+    struct eh_file_io *io = (struct eh_file_io *)arg;
+    return pread(io->fd, io->buf, io->len, io->offset);
+}
+
+static intptr_t _eh_file_job_write(void *arg){
+    struct eh_file_io *io = (struct eh_file_io *)arg;
+    return pwrite(io->fd, io->buf, io->len, io->offset);
+}
+
+static intptr_t _eh_file_job_fsync(void *arg){
+    struct eh_file_io *io = (struct eh_file_io *)arg;
+    return fsync(io->fd);
+}
+
+static intptr_t _eh_file_job_open(void *arg){
+    struct eh_file_io *io = (struct eh_file_io *)arg;
+    return open(io->path, io->flags, io->mode);
+}
+
+/**
+ * @brief                           在线程池中执行，io在栈上，永久等待保证执行期间一直有效
+ */
+static intptr_t __async__ _eh_file_offload(intptr_t (*fn)(void *arg), struct eh_file_io *io){
+    intptr_t result;
+    if(__await__ eh_offload_call(fn, io, &result) < 0){
+        errno = ENOMEM;
+        return -1;
+    }
+    return result;
+}
+
+static ssize_t __async__ _eh_file_io_read(int fd, void *buf, size_t len, off_t offset){
+    struct eh_file_io io = {.fd = fd, .buf = buf, .len = len, .offset = offset};
+    return (ssize_t)__await__ _eh_file_offload(_eh_file_job_read, &io);
+}
+
+static ssize_t __async__ _eh_file_io_write(int fd, const void *buf, size_t len, off_t offset){
+    struct eh_file_io io = {.fd = fd, .buf = (void *)buf, .len = len, .offset = offset};
+    return (ssize_t)__await__ _eh_file_offload(_eh_file_job_write, &io);
+}
+
+static int __async__ _eh_file_io_fsync(int fd){
+    struct eh_file_io io = {.fd = fd};
+    return (int)__await__ _eh_file_offload(_eh_file_job_fsync, &io);
+}
+
+static int __async__ _eh_file_io_open(const char *path, int flags, mode_t mode){
+    struct eh_file_io io = {.path = path, .flags = flags, .mode = mode};
+    return (int)__await__ _eh_file_offload(_eh_file_job_open, &io);
+}
+
+#endif
+
+eh_file_t* __async__ eh_file_open(const char *path, int flags, mode_t mode){
+    eh_file_t *file;
+    int fd;
+    if(path == NULL)
+        return eh_error_to_ptr(EH_RET_INVALID_PARAM);
+    fd = __await__ _eh_file_io_open(path, flags | O_CLOEXEC, mode);
+    if(fd < 0)
+        return eh_error_to_ptr(EH_RET_FAULT);
+    file = eh_malloc(sizeof(eh_file_t));
+    if(file == NULL){
+        close(fd);
+        errno = ENOMEM;
+        return eh_error_to_ptr(EH_RET_MALLOC_ERROR);
+    }
+    memset(file, 0, sizeof(eh_file_t));
+    file->fd = fd;
+    file->append = (flags & O_APPEND) != 0;
+    return file;
+}
+
+int eh_file_set_readahead(eh_file_t *file, size_t size){
+    uint8_t *buf = NULL;
+    if(size > EH_FILE_IO_MAX_LEN)
+        return EH_RET_INVALID_PARAM;
+    if(size){
+        buf = eh_malloc(size);
+        if(buf == NULL)
+            return EH_RET_MALLOC_ERROR;
+    }
+    eh_free(file->ra_buf);
+    file->ra_buf = buf;
+    file->ra_size = size;
+    file->ra_len = 0;
+    return EH_RET_OK;
+}
+
+int eh_file_set_write_coalesce(eh_file_t *file, size_t size){
+    uint8_t *buf = NULL;
+    if(size > EH_FILE_IO_MAX_LEN)
+        return EH_RET_INVALID_PARAM;
+    if(file->wb_len)
+        return EH_RET_BUSY;
+    if(size){
+        buf = eh_malloc(size);
+        if(buf == NULL)
+            return EH_RET_MALLOC_ERROR;
+    }
+    eh_free(file->wb_buf);
+    file->wb_buf = buf;
+    file->wb_size = size;
+    return EH_RET_OK;
+}
+
+/**
+ * @brief                           写出全部数据，短写时继续写剩余部分
+ */
+static ssize_t __async__ _eh_file_write_all(eh_file_t *file, const uint8_t *buf, size_t len, off_t offset){
+    size_t done = 0;
+    ssize_t ret;
+    while(done < len){
+        ret = __await__ _eh_file_io_write(file->fd, buf + done, len - done > EH_FILE_IO_MAX_LEN ? EH_FILE_IO_MAX_LEN : len - done, offset + (off_t)done);
+        file->stat.write_io++;
+        if(ret < 0)
+            return done ? (ssize_t)done : -1;
+        if(ret == 0)
+            break;
+        done += (size_t)ret;
+    }
+    return (ssize_t)done;
+}
+
+int __async__ eh_file_flush(eh_file_t *file){
+    ssize_t ret;
+    if(file->wb_len == 0)
+        return 0;
+    ret = __await__ _eh_file_write_all(file, file->wb_buf, file->wb_len, file->wb_off);
+    if(ret < 0)
+        return -1;
+    /* 部分写出时剩余的数据移到缓冲区头部，下次继续 */
+    if((size_t)ret < file->wb_len){
+        memmove(file->wb_buf, file->wb_buf + ret, file->wb_len - (size_t)ret);
+        file->wb_off += (off_t)ret;
+        file->wb_len -= (size_t)ret;
+        errno = EIO;
+        return -1;
+    }
+    file->wb_len = 0;
+    return 0;
+}
+
+ssize_t __async__ eh_file_pread(eh_file_t *file, void *buf, size_t len, off_t offset){
+    uint8_t *out = (uint8_t *)buf;
+    uint64_t read_io = file->stat.read_io;
+    size_t done = 0, n;
+    bool sequential;
+    ssize_t ret;
+
+    if(__await__ eh_file_flush(file) < 0)
+        return -1;
+    if(len > EH_FILE_IO_MAX_LEN)
+        len = EH_FILE_IO_MAX_LEN;
+    sequential = offset == file->ra_next;
+    file->ra_next = offset + (off_t)len;
+    if(file->ra_size == 0 || len >= file->ra_size || (!sequential && (offset < file->ra_off || offset >= file->ra_off + (off_t)file->ra_len))){
+        ret = __await__ _eh_file_io_read(file->fd, buf, len, offset);
+        file->stat.read_io++;
+        return ret;
+    }
+    while(done < len){
+        if(offset >= file->ra_off && offset < file->ra_off + (off_t)file->ra_len){
+            n = (size_t)(file->ra_off + (off_t)file->ra_len - offset);
+            if(n > len - done)
+                n = len - done;
+            memcpy(out + done, file->ra_buf + (offset - file->ra_off), n);
+            done += n;
+            offset += (off_t)n;
+            continue;
+        }
+        ret = __await__ _eh_file_io_read(file->fd, file->ra_buf, file->ra_size, offset);
+        file->stat.read_io++;
+        if(ret < 0){
+            file->ra_len = 0;
+            return done ? (ssize_t)done : -1;
+        }
+        file->ra_off = offset;
+        file->ra_len = (size_t)ret;
+        if(ret == 0)
+            break;
+    }
+    if(done && read_io == file->stat.read_io)
+        file->stat.readahead_hit++;
+    return (ssize_t)done;
+}
+
+ssize_t __async__ eh_file_pwrite(eh_file_t *file, const void *buf, size_t len, off_t offset){
+    bool adjacent;
+    file->ra_len = 0;
+    if(len > EH_FILE_IO_MAX_LEN)
+        len = EH_FILE_IO_MAX_LEN;
+    if(file->wb_size && len < file->wb_size){
+        /* 以O_APPEND打开时所有写都追加到末尾，总是相邻 */
+        adjacent = file->wb_len == 0 || file->append || offset == file->wb_off + (off_t)file->wb_len;
+        if(!adjacent || file->wb_len + len > file->wb_size){
+            if(__await__ eh_file_flush(file) < 0)
+                return -1;
+        }
+        if(file->wb_len == 0)
+            file->wb_off = offset;
+        else
+            file->stat.write_merged++;
+        memcpy(file->wb_buf + file->wb_len, buf, len);
+        file->wb_len += len;
+        return (ssize_t)len;
+    }
+    if(__await__ eh_file_flush(file) < 0)
+        return -1;
+    return __await__ _eh_file_write_all(file, (const uint8_t *)buf, len, offset);
+}
+
+ssize_t __async__ eh_file_read(eh_file_t *file, void *buf, size_t len){
+    ssize_t ret = __await__ eh_file_pread(file, buf, len, file->pos);
+    if(ret > 0)
+        file->pos += ret;
+    return ret;
+}
+
+ssize_t __async__ eh_file_write(eh_file_t *file, const void *buf, size_t len){
+    ssize_t ret = __await__ eh_file_pwrite(file, buf, len, file->pos);
+    if(ret > 0)
+        file->pos += ret;
+    return ret;
+}
+
+void eh_file_seek(eh_file_t *file, off_t offset){
+    file->pos = offset;
+}
+
+int __async__ eh_file_fsync(eh_file_t *file){
+    if(__await__ eh_file_flush(file) < 0)
+        return -1;
+    return __await__ _eh_file_io_fsync(file->fd);
+}
+
+int __async__ eh_file_close(eh_file_t *file){
+    int ret = __await__ eh_file_flush(file);
+    int err = errno;
+    if(close(file->fd) < 0 && ret == 0){
+        ret = -1;
+        err = errno;
+    }
+    eh_free(file->ra_buf);
+    eh_free(file->wb_buf);
+    eh_free(file);
+    errno = err;
+    return ret;
+}
+
+void eh_file_get_stat(eh_file_t *file, struct eh_file_stat *stat){
+    *stat = file->stat;
+}
@@ -0,0 +1,273 @@
+/**
+ * @file eh_offload.c
+ * @brief linux下阻塞调用的线程池，
+ *    提交的任务放入等待链表由工作线程取出执行，执行完成后放入完成链表，两个链表由同一个pthread互斥锁保护，
+ *    完成链表由空变为非空的那个工作线程负责eh_event_notify，
+ *    EH_EVENT_CB_MODE_DEFERRED模式的槽函数在调度器线程中取走整个完成链表并逐个唤醒等待者。
+ * @author simon.xiaoapeng (simon.xiaoapeng@gmail.com)
+ * @version 1.0
+ * @date 2024-08-30
+ *
+ * @copyright Copyright (c) 2024  simon.xiaoapeng@gmail.com
+ *
+ * @par 修改日志:
+ */
+
+#include <errno.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <signal.h>
+#include "eh.h"
+#include "eh_error.h"
+#include "eh_event.h"
+#include "eh_event_cb.h"
+#include "eh_list.h"
+#include "eh_mem.h"
+#include "eh_module.h"
+#include "eh_offload.h"
+
+enum eh_offload_state{
+    EH_OFFLOAD_STATE_QUEUED,
+    EH_OFFLOAD_STATE_DONE,
+};
+
+struct eh_offload{
+    struct eh_list_head             node;
+    intptr_t                        (*fn)(void *arg);
+    void                            *arg;
+    intptr_t                        result;
+    int                             err;
+    enum eh_offload_state           state;              /* 只在调度器线程中读写 */
+    bool                            detached;
+    eh_event_t                      event;
+};
+
+static struct {
+    pthread_mutex_t                 lock;
+    pthread_cond_t                  cond;
+    pthread_t                       threads[EH_OFFLOAD_THREAD_CNT];
+    bool                            started;
+    bool                            stop;
+    struct eh_list_head             pending_list;
+    struct eh_list_head             done_list;
+    eh_event_t                      done_event;
+    eh_event_cb_trigger_t           trigger;
+    eh_event_cb_slot_t              slot;
+    uint64_t                        completed;
+    uint64_t                        wakeups;
+}eh_offload;
+
+static void _eh_offload_free(eh_offload_t *job){
+    eh_event_clean(&job->event);
+    eh_free(job);
+}
+
+static void* _eh_offload_thread(void *arg){
+    eh_offload_t *job;
+    bool notify;
+    (void)arg;
+    pthread_mutex_lock(&eh_offload.lock);
+    for(;;){
+        while(!eh_offload.stop && eh_list_empty(&eh_offload.pending_list))
+            pthread_cond_wait(&eh_offload.cond, &eh_offload.lock);
+        if(eh_offload.stop)
+            break;
+        job = eh_list_entry(eh_offload.pending_list.next, eh_offload_t, node);
+        eh_list_del(&job->node);
+        pthread_mutex_unlock(&eh_offload.lock);
+
+        errno = 0;
+        job->result = job->fn(job->arg);
+        job->err = errno;
+
+        pthread_mutex_lock(&eh_offload.lock);
+        notify = eh_list_empty(&eh_offload.done_list);
+        eh_list_add_tail(&job->node, &eh_offload.done_list);
+        if(notify){
+            eh_offload.wakeups++;
+            pthread_mutex_unlock(&eh_offload.lock);
+            eh_event_notify(&eh_offload.done_event);
+            pthread_mutex_lock(&eh_offload.lock);
+        }
+    }
+    pthread_mutex_unlock(&eh_offload.lock);
+    return NULL;
+}
+
+static void _eh_offload_dispatch(eh_event_t *e, void *slot_param){
+    struct eh_list_head done_list;
+    eh_offload_t *job, *n;
+    (void)e;
+    (void)slot_param;
+    eh_list_head_init(&done_list);
+    pthread_mutex_lock(&eh_offload.lock);
+    eh_list_splice_init(&eh_offload.done_list, &done_list);
+    pthread_mutex_unlock(&eh_offload.lock);
+    eh_list_for_each_entry_safe(job, n, &done_list, node){
+        eh_list_del_init(&job->node);
+        eh_offload.completed++;
+        if(job->detached){
+            _eh_offload_free(job);
+            continue;
+        }
+        job->state = EH_OFFLOAD_STATE_DONE;
+        eh_event_notify(&job->event);
+    }
+}
+
+static int _eh_offload_start(void){
+    sigset_t set, old_set;
+    int i, ret;
+    /* 工作线程屏蔽所有信号，信号只投递到调度器所在线程(见eh_posix_signal) */
+    sigfillset(&set);
+    pthread_sigmask(SIG_SETMASK, &set, &old_set);
+    for(i = 0; i < EH_OFFLOAD_THREAD_CNT; i++){
+        ret = pthread_create(&eh_offload.threads[i], NULL, _eh_offload_thread, NULL);
+        if(ret != 0)
+            break;
+    }
+    pthread_sigmask(SIG_SETMASK, &old_set, NULL);
+    if(ret != 0)
+        goto error;
+    eh_offload.started = true;
+    return EH_RET_OK;
+error:
+    pthread_mutex_lock(&eh_offload.lock);
+    eh_offload.stop = true;
+    pthread_cond_broadcast(&eh_offload.cond);
+    pthread_mutex_unlock(&eh_offload.lock);
+    while(i--)
+        pthread_join(eh_offload.threads[i], NULL);
+    eh_offload.stop = false;
+    return EH_RET_FAULT;
+}
+
+eh_offload_t* eh_offload_submit(intptr_t (*fn)(void *arg), void *arg){
+    eh_offload_t *job;
+    int ret;
+    if(fn == NULL)
+        return eh_error_to_ptr(EH_RET_INVALID_PARAM);
+    if(!eh_offload.started){
+        ret = _eh_offload_start();
+        if(ret < 0)
+            return eh_error_to_ptr((intptr_t)ret);
+    }
+    job = eh_malloc(sizeof(eh_offload_t));
+    if(job == NULL)
+        return eh_error_to_ptr(EH_RET_MALLOC_ERROR);
+    job->fn = fn;
+    job->arg = arg;
+    job->result = 0;
+    job->err = 0;
+    job->state = EH_OFFLOAD_STATE_QUEUED;
+    job->detached = false;
+    eh_event_init(&job->event);
+    pthread_mutex_lock(&eh_offload.lock);
+    eh_list_add_tail(&job->node, &eh_offload.pending_list);
+    pthread_cond_signal(&eh_offload.cond);
+    pthread_mutex_unlock(&eh_offload.lock);
+    return job;
+}
+
+static bool _eh_offload_is_done(void *arg){
+    eh_offload_t *job = (eh_offload_t *)arg;
+    return job->state == EH_OFFLOAD_STATE_DONE;
+}
+
+int __async__ eh_offload_wait(eh_offload_t *job, intptr_t *result, eh_sclock_t timeout){
+    int ret;
+    eh_param_assert(job);
+    ret = __await__ eh_event_wait_condition_timeout(&job->event, job, _eh_offload_is_done, timeout);
+    if(ret < 0)
+        return ret;
+    if(result)
+        *result = job->result;
+    errno = job->err;
+    _eh_offload_free(job);
+    return EH_RET_OK;
+}
+
+void eh_offload_detach(eh_offload_t *job){
+    if(job->state == EH_OFFLOAD_STATE_DONE){
+        _eh_offload_free(job);
+        return ;
+    }
+    job->detached = true;
+}
+
+int __async__ eh_offload_call(intptr_t (*fn)(void *arg), void *arg, intptr_t *result){
+    eh_offload_t *job = eh_offload_submit(fn, arg);
+    int ret = eh_ptr_to_error(job);
+    if(ret < 0)
+        return ret;
+    return __await__ eh_offload_wait(job, result, EH_TIME_FOREVER);
+}
+
+void eh_offload_stat(uint64_t *completed, uint64_t *wakeups){
+    if(completed)
+        *completed = eh_offload.completed;
+    if(wakeups){
+        pthread_mutex_lock(&eh_offload.lock);
+        *wakeups = eh_offload.wakeups;
+        pthread_mutex_unlock(&eh_offload.lock);
+    }
+}
+
+static int __init eh_offload_init(void){
+    int ret;
+    eh_offload.started = false;
+    eh_offload.stop = false;
+    eh_offload.completed = 0;
+    eh_offload.wakeups = 0;
+    eh_list_head_init(&eh_offload.pending_list);
+    eh_list_head_init(&eh_offload.done_list);
+    if(pthread_mutex_init(&eh_offload.lock, NULL) != 0)
+        return EH_RET_FAULT;
+    if(pthread_cond_init(&eh_offload.cond, NULL) != 0){
+        ret = EH_RET_FAULT;
+        goto cond_init_error;
+    }
+    eh_event_init(&eh_offload.done_event);
+    eh_event_cb_trigger_init(&eh_offload.trigger);
+    /* 槽函数只唤醒等待者，不需要独立的任务栈 */
+    eh_event_cb_trigger_set_mode(&eh_offload.trigger, EH_EVENT_CB_MODE_DEFERRED);
+    eh_event_cb_slot_init(&eh_offload.slot, _eh_offload_dispatch, NULL);
+    eh_event_cb_connect(&eh_offload.trigger, &eh_offload.slot);
+    ret = eh_event_cb_register(&eh_offload.done_event, &eh_offload.trigger);
+    if(ret < 0)
+        goto register_error;
+    return EH_RET_OK;
+register_error:
+    eh_event_cb_disconnect(&eh_offload.slot);
+    eh_event_cb_trigger_clean(&eh_offload.trigger);
+    eh_event_clean(&eh_offload.done_event);
+    pthread_cond_destroy(&eh_offload.cond);
+cond_init_error:
+    pthread_mutex_destroy(&eh_offload.lock);
+    return ret;
+}
+
+static void __exit eh_offload_exit(void){
+    eh_offload_t *job, *n;
+    if(eh_offload.started){
+        pthread_mutex_lock(&eh_offload.lock);
+        eh_offload.stop = true;
+        pthread_cond_broadcast(&eh_offload.cond);
+        pthread_mutex_unlock(&eh_offload.lock);
+        for(int i = 0; i < EH_OFFLOAD_THREAD_CNT; i++)
+            pthread_join(eh_offload.threads[i], NULL);
+    }
+    /* 还没有执行或还没有被取走的任务，其等待者已经不存在 */
+    eh_list_for_each_entry_safe(job, n, &eh_offload.pending_list, node)
+        _eh_offload_free(job);
+    eh_list_for_each_entry_safe(job, n, &eh_offload.done_list, node)
+        _eh_offload_free(job);
+    eh_event_cb_unregister(&eh_offload.done_event);
+    eh_event_cb_disconnect(&eh_offload.slot);
+    eh_event_cb_trigger_clean(&eh_offload.trigger);
+    eh_event_clean(&eh_offload.done_event);
+    pthread_cond_destroy(&eh_offload.cond);
+    pthread_mutex_destroy(&eh_offload.lock);
+}
+
+eh_module_export(eh_offload_init, eh_offload_exit);
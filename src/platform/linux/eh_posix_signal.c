@@ -0,0 +1,226 @@
+/**
+ * @file eh_posix_signal.c
+ * @brief linux下基于signalfd的POSIX信号事件，
+ *    signalfd在第一次接管信号时创建，之后接管/释放信号只更新它的信号集，
+ *    每个被接管的信号对应一个描述，包含事件和siginfo环形队列，以信号值为下标存放，
+ *    signalfd可读时循环批量读取直到读空，读取期间收到信号的描述只通知一次。
+ * @author simon.xiaoapeng (simon.xiaoapeng@gmail.com)
+ * @version 1.0
+ * @date 2024-09-02
+ *
+ * @copyright Copyright (c) 2024  simon.xiaoapeng@gmail.com
+ *
+ * @par 修改日志:
+ */
+
+#include <errno.h>
+#include <signal.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include "eh.h"
+#include "eh_error.h"
+#include "eh_event.h"
+#include "eh_mem.h"
+#include "eh_module.h"
+#include "epoll_hub.h"
+#include "eh_posix_signal.h"
+
+/* 一次read最多读取的siginfo数 */
+#define EH_POSIX_SIGNAL_READ_BATCH          16
+
+struct eh_posix_signal{
+    eh_event_t                      event;
+    int                             head;
+    int                             cnt;
+    bool                            pending;            /* 本次读取中已收到，读取结束后通知 */
+    uint64_t                        dropped;
+    struct signalfd_siginfo         queue[EH_POSIX_SIGNAL_QUEUE_SIZE];
+};
+
+static struct {
+    int                             fd;
+    sigset_t                        mask;
+    struct epoll_fd_action          action;
+    struct eh_posix_signal          *table[_NSIG];
+}eh_posix_signal;
+
+static bool _eh_posix_signal_is_valid(int signo){
+    return signo > 0 && signo < _NSIG && signo != SIGKILL && signo != SIGSTOP;
+}
+
+static void _eh_posix_signal_push(struct eh_posix_signal *sig, const struct signalfd_siginfo *info){
+    if(sig->cnt == EH_POSIX_SIGNAL_QUEUE_SIZE){
+        sig->dropped++;
+    }else{
+        sig->queue[(sig->head + sig->cnt) % EH_POSIX_SIGNAL_QUEUE_SIZE] = *info;
+        sig->cnt++;
+    }
+    sig->pending = true;
+}
+
+static void _eh_posix_signal_callback(uint32_t events, void *arg){
+    struct signalfd_siginfo infos[EH_POSIX_SIGNAL_READ_BATCH];
+    struct eh_posix_signal *sig;
+    ssize_t n;
+    int cnt;
+    (void)events;
+    (void)arg;
+    do{
+        n = read(eh_posix_signal.fd, infos, sizeof(infos));
+        if(n <= 0)
+            break;
+        cnt = (int)((size_t)n / sizeof(struct signalfd_siginfo));
+        for(int i = 0; i < cnt; i++){
+            if(infos[i].ssi_signo >= _NSIG)
+                continue;
+            sig = eh_posix_signal.table[infos[i].ssi_signo];
+            if(sig)
+                _eh_posix_signal_push(sig, &infos[i]);
+        }
+    }while(cnt == EH_POSIX_SIGNAL_READ_BATCH);
+
+    for(int signo = 1; signo < _NSIG; signo++){
+        sig = eh_posix_signal.table[signo];
+        if(sig == NULL || !sig->pending)
+            continue;
+        sig->pending = false;
+        eh_event_notify(&sig->event);
+    }
+}
+
+static int _eh_posix_signal_fd_open(void){
+    int fd;
+    sigemptyset(&eh_posix_signal.mask);
+    fd = signalfd(-1, &eh_posix_signal.mask, SFD_NONBLOCK | SFD_CLOEXEC);
+    if(fd < 0)
+        return EH_RET_FAULT;
+    eh_posix_signal.action.callback = _eh_posix_signal_callback;
+    eh_posix_signal.action.arg = NULL;
+    eh_posix_signal.action.revents = 0;
+    if(epoll_hub_add_fd(fd, EPOLLIN, &eh_posix_signal.action) < 0){
+        close(fd);
+        return EH_RET_FAULT;
+    }
+    eh_posix_signal.fd = fd;
+    return EH_RET_OK;
+}
+
+eh_event_t* eh_posix_signal_event(int signo){
+    struct eh_posix_signal *sig;
+    sigset_t set;
+    int ret;
+    if(!_eh_posix_signal_is_valid(signo))
+        return eh_error_to_ptr(EH_RET_INVALID_PARAM);
+    sig = eh_posix_signal.table[signo];
+    if(sig)
+        return &sig->event;
+    if(eh_posix_signal.fd < 0){
+        ret = _eh_posix_signal_fd_open();
+        if(ret < 0)
+            return eh_error_to_ptr((intptr_t)ret);
+    }
+    sig = eh_malloc(sizeof(struct eh_posix_signal));
+    if(sig == NULL)
+        return eh_error_to_ptr(EH_RET_MALLOC_ERROR);
+    memset(sig, 0, sizeof(struct eh_posix_signal));
+    eh_event_init(&sig->event);
+
+    /* 先阻塞再加入signalfd，中间到来的信号保持在未决状态，随后从signalfd读出 */
+    sigemptyset(&set);
+    sigaddset(&set, signo);
+    if(pthread_sigmask(SIG_BLOCK, &set, NULL) != 0)
+        goto error;
+    sigaddset(&eh_posix_signal.mask, signo);
+    if(signalfd(eh_posix_signal.fd, &eh_posix_signal.mask, 0) < 0){
+        sigdelset(&eh_posix_signal.mask, signo);
+        pthread_sigmask(SIG_UNBLOCK, &set, NULL);
+        goto error;
+    }
+    eh_posix_signal.table[signo] = sig;
+    return &sig->event;
+error:
+    eh_event_clean(&sig->event);
+    eh_free(sig);
+    return eh_error_to_ptr(EH_RET_FAULT);
+}
+
+int eh_posix_signal_read(int signo, struct signalfd_siginfo *info, int n){
+    struct eh_posix_signal *sig;
+    int i;
+    if(!_eh_posix_signal_is_valid(signo) || info == NULL || n < 0)
+        return EH_RET_INVALID_PARAM;
+    sig = eh_posix_signal.table[signo];
+    if(sig == NULL)
+        return EH_RET_INVALID_STATE;
+    for(i = 0; i < n && sig->cnt; i++){
+        info[i] = sig->queue[sig->head];
+        sig->head = (sig->head + 1) % EH_POSIX_SIGNAL_QUEUE_SIZE;
+        sig->cnt--;
+    }
+    return i;
+}
+
+static bool _eh_posix_signal_has_info(void *arg){
+    struct eh_posix_signal *sig = (struct eh_posix_signal *)arg;
+    return sig->cnt > 0;
+}
+
+int __async__ eh_posix_signal_wait(int signo, struct signalfd_siginfo *info, int n, eh_sclock_t timeout){
+    eh_event_t *e;
+    int ret;
+    if(info == NULL || n <= 0)
+        return EH_RET_INVALID_PARAM;
+    e = eh_posix_signal_event(signo);
+    ret = eh_ptr_to_error(e);
+    if(ret < 0)
+        return ret;
+    ret = __await__ eh_event_wait_condition_timeout(e, eh_posix_signal.table[signo], _eh_posix_signal_has_info, timeout);
+    if(ret < 0)
+        return ret;
+    return eh_posix_signal_read(signo, info, n);
+}
+
+uint64_t eh_posix_signal_dropped(int signo){
+    if(!_eh_posix_signal_is_valid(signo) || eh_posix_signal.table[signo] == NULL)
+        return 0;
+    return eh_posix_signal.table[signo]->dropped;
+}
+
+void eh_posix_signal_release(int signo){
+    struct eh_posix_signal *sig;
+    struct timespec ts = {0, 0};
+    sigset_t set;
+    if(!_eh_posix_signal_is_valid(signo) || eh_posix_signal.table[signo] == NULL)
+        return ;
+    sig = eh_posix_signal.table[signo];
+    eh_posix_signal.table[signo] = NULL;
+    sigdelset(&eh_posix_signal.mask, signo);
+    signalfd(eh_posix_signal.fd, &eh_posix_signal.mask, 0);
+    /* 未决的信号在解除阻塞时会按默认方式处理(如SIGTERM终止进程)，先将其取走 */
+    sigemptyset(&set);
+    sigaddset(&set, signo);
+    while(sigtimedwait(&set, NULL, &ts) == signo){}
+    pthread_sigmask(SIG_UNBLOCK, &set, NULL);
+    eh_event_clean(&sig->event);
+    eh_free(sig);
+}
+
+static int __init eh_posix_signal_init(void){
+    eh_posix_signal.fd = -1;
+    sigemptyset(&eh_posix_signal.mask);
+    memset(eh_posix_signal.table, 0, sizeof(eh_posix_signal.table));
+    return EH_RET_OK;
+}
+
+static void __exit eh_posix_signal_exit(void){
+    if(eh_posix_signal.fd < 0)
+        return ;
+    for(int signo = 1; signo < _NSIG; signo++)
+        eh_posix_signal_release(signo);
+    epoll_hub_del_fd(eh_posix_signal.fd);
+    close(eh_posix_signal.fd);
+    eh_posix_signal.fd = -1;
+}
+
+eh_module_export(eh_posix_signal_init, eh_posix_signal_exit);
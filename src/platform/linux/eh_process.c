@@ -0,0 +1,344 @@
+/**
+ * @file eh_process.c
+ * @brief linux下基于posix_spawn和pidfd的异步子进程，
+ *    pidfd以边沿触发方式加入epoll_hub，子进程退出时只报告一次可读，回调中标记退出并通知事件，
+ *    子进程在被waitpid回收之前一直是僵尸进程，所以创建后再取pidfd不会有竞争。
+ *    管道在当前进程一侧的描述符注册到eh_fd，环形缓冲区的读写直接把空闲/已用区域作为iovec交给readv/writev。
+ *    销毁还未回收的子进程时不在调度器线程中阻塞等待，发送SIGKILL后结构体留在孤儿链表中，
+ *    pidfd报告退出时在回调中回收并释放，没有pidfd时把waitpid交给eh_offload线程池。
+ * @author simon.xiaoapeng (simon.xiaoapeng@gmail.com)
+ * @version 1.0
+ * @date 2024-09-04
+ *
+ * @copyright Copyright (c) 2024  simon.xiaoapeng@gmail.com
+ *
+ * @par 修改日志:
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <spawn.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <sys/wait.h>
+#include "eh.h"
+#include "eh_error.h"
+#include "eh_event.h"
+#include "eh_list.h"
+#include "eh_mem.h"
+#include "eh_module.h"
+#include "epoll_hub.h"
+#include "eh_fd.h"
+#include "eh_offload.h"
+#include "eh_process.h"
+
+extern char **environ;
+
+struct eh_process{
+    pid_t                           pid;
+    int                             pidfd;
+    int                             fds[EH_PROCESS_STDIO_CNT];
+    bool                            exited;             /* pidfd已报告可读 */
+    bool                            reaped;             /* 已被waitpid回收，status有效 */
+    int                             status;
+    struct epoll_fd_action          action;
+    eh_event_t                      event;
+    struct eh_list_head             orphan_node;        /* 已销毁但还未回收的子进程 */
+};
+
+static struct eh_list_head          eh_process_orphan_list;
+
+void eh_process_config_init(struct eh_process_config *config, const char *path){
+    memset(config, 0, sizeof(struct eh_process_config));
+    config->path = path;
+}
+
+static void _eh_process_callback(uint32_t events, void *arg){
+    eh_process_t *process = (eh_process_t *)arg;
+    (void)events;
+    process->exited = true;
+    eh_event_notify(&process->event);
+}
+
+/**
+ * @brief                           创建管道并加入posix_spawn的文件操作，
+ *                                  pipe_fds[0]为当前进程一侧，pipe_fds[1]为子进程一侧
+ */
+static int _eh_process_pipe(posix_spawn_file_actions_t *actions, enum eh_process_stdio stdio, int pipe_fds[2]){
+    int fds[2];
+    if(pipe2(fds, O_CLOEXEC) < 0)
+        return EH_RET_FAULT;
+    /* stdin由当前进程写入，子进程读取，stdout/stderr方向相反 */
+    pipe_fds[0] = stdio == EH_PROCESS_STDIN ? fds[1] : fds[0];
+    pipe_fds[1] = stdio == EH_PROCESS_STDIN ? fds[0] : fds[1];
+    if(posix_spawn_file_actions_adddup2(actions, pipe_fds[1], (int)stdio) != 0){
+        close(fds[0]);
+        close(fds[1]);
+        return EH_RET_FAULT;
+    }
+    return EH_RET_OK;
+}
+
+eh_process_t* eh_process_spawn(const struct eh_process_config *config){
+    posix_spawn_file_actions_t actions;
+    eh_process_t *process;
+    int child_fds[EH_PROCESS_STDIO_CNT];
+    char *default_argv[2];
+    char *const *argv;
+    int pipe_fds[2];
+    int ret, i;
+
+    if(config == NULL || config->path == NULL)
+        return eh_error_to_ptr(EH_RET_INVALID_PARAM);
+    default_argv[0] = (char *)config->path;
+    default_argv[1] = NULL;
+    argv = config->argv ? config->argv : default_argv;
+    process = eh_malloc(sizeof(eh_process_t));
+    if(process == NULL)
+        return eh_error_to_ptr(EH_RET_MALLOC_ERROR);
+    memset(process, 0, sizeof(eh_process_t));
+    process->pidfd = -1;
+    for(i = 0; i < EH_PROCESS_STDIO_CNT; i++){
+        process->fds[i] = -1;
+        child_fds[i] = -1;
+    }
+    eh_event_init(&process->event);
+    if(posix_spawn_file_actions_init(&actions) != 0){
+        ret = EH_RET_FAULT;
+        goto actions_init_error;
+    }
+    for(i = 0; i < EH_PROCESS_STDIO_CNT; i++){
+        if(!config->pipe[i])
+            continue;
+        ret = _eh_process_pipe(&actions, (enum eh_process_stdio)i, pipe_fds);
+        if(ret < 0)
+            goto spawn_error;
+        process->fds[i] = pipe_fds[0];
+        child_fds[i] = pipe_fds[1];
+    }
+    if(config->search_path)
+        ret = posix_spawnp(&process->pid, config->path, &actions, NULL, argv, config->envp ? config->envp : environ);
+    else
+        ret = posix_spawn(&process->pid, config->path, &actions, NULL, argv, config->envp ? config->envp : environ);
+    if(ret != 0){
+        errno = ret;
+        ret = EH_RET_FAULT;
+        goto spawn_error;
+    }
+    posix_spawn_file_actions_destroy(&actions);
+    for(i = 0; i < EH_PROCESS_STDIO_CNT; i++){
+        if(child_fds[i] >= 0)
+            close(child_fds[i]);
+    }
+    for(i = 0; i < EH_PROCESS_STDIO_CNT; i++){
+        if(process->fds[i] < 0)
+            continue;
+        ret = eh_fd_register(process->fds[i]);
+        if(ret < 0)
+            goto spawned_error;
+    }
+
+    ret = EH_RET_FAULT;
+    process->pidfd = (int)syscall(SYS_pidfd_open, process->pid, 0);
+    if(process->pidfd < 0)
+        goto spawned_error;
+    process->action.callback = _eh_process_callback;
+    process->action.arg = process;
+    process->action.revents = 0;
+    /* 加入时子进程已经退出的，会在下一次epoll_hub_poll中报告 */
+    if(epoll_hub_add_fd(process->pidfd, EPOLLIN | EPOLLET, &process->action) < 0){
+        close(process->pidfd);
+        process->pidfd = -1;
+        goto spawned_error;
+    }
+    return process;
+spawned_error:
+    /* 管道无法异步读写或无法异步等待的子进程不能交给调用者，结束并回收 */
+    eh_process_destroy(process);
+    return eh_error_to_ptr((intptr_t)ret);
+spawn_error:
+    for(i = 0; i < EH_PROCESS_STDIO_CNT; i++){
+        if(child_fds[i] >= 0)
+            close(child_fds[i]);
+        if(process->fds[i] >= 0)
+            close(process->fds[i]);
+    }
+    posix_spawn_file_actions_destroy(&actions);
+actions_init_error:
+    eh_event_clean(&process->event);
+    eh_free(process);
+    return eh_error_to_ptr((intptr_t)ret);
+}
+
+pid_t eh_process_pid(eh_process_t *process){
+    return process->pid;
+}
+
+int eh_process_fd(eh_process_t *process, enum eh_process_stdio stdio){
+    if((unsigned int)stdio >= EH_PROCESS_STDIO_CNT)
+        return -1;
+    return process->fds[stdio];
+}
+
+static void _eh_iovec_from_span(const eh_ringbuf_span_t span[2], int cnt, struct iovec iov[2]){
+    for(int i = 0; i < cnt; i++){
+        iov[i].iov_base = span[i].buf;
+        iov[i].iov_len = (size_t)span[i].len;
+    }
+}
+
+ssize_t __async__ eh_process_read(eh_process_t *process, enum eh_process_stdio stdio,
+    eh_ringbuf_t *ringbuf, eh_sclock_t timeout){
+    eh_ringbuf_span_t span[2];
+    struct iovec iov[2];
+    ssize_t ret;
+    int cnt;
+
+    if(stdio != EH_PROCESS_STDOUT && stdio != EH_PROCESS_STDERR){
+        errno = EINVAL;
+        return -1;
+    }
+    if(process->fds[stdio] < 0){
+        errno = EBADF;
+        return -1;
+    }
+    cnt = eh_ringbuf_free_span(ringbuf, span);
+    if(cnt == 0){
+        errno = ENOBUFS;
+        return -1;
+    }
+    _eh_iovec_from_span(span, cnt, iov);
+    ret = __await__ eh_readv(process->fds[stdio], iov, cnt, timeout);
+    if(ret > 0)
+        eh_ringbuf_write_skip(ringbuf, (int32_t)ret);
+    return ret;
+}
+
+ssize_t __async__ eh_process_write(eh_process_t *process, eh_ringbuf_t *ringbuf, eh_sclock_t timeout){
+    eh_ringbuf_span_t span[2];
+    struct iovec iov[2];
+    ssize_t ret;
+    int cnt;
+
+    if(process->fds[EH_PROCESS_STDIN] < 0){
+        errno = EBADF;
+        return -1;
+    }
+    cnt = eh_ringbuf_used_span(ringbuf, span);
+    if(cnt == 0)
+        return 0;
+    _eh_iovec_from_span(span, cnt, iov);
+    ret = __await__ eh_writev(process->fds[EH_PROCESS_STDIN], iov, cnt, timeout);
+    if(ret > 0)
+        eh_ringbuf_read_skip(ringbuf, (int32_t)ret);
+    return ret;
+}
+
+void eh_process_close(eh_process_t *process, enum eh_process_stdio stdio){
+    if((unsigned int)stdio >= EH_PROCESS_STDIO_CNT || process->fds[stdio] < 0)
+        return ;
+    eh_close(process->fds[stdio]);
+    process->fds[stdio] = -1;
+}
+
+int eh_process_kill(eh_process_t *process, int signo){
+    if(process->reaped || process->pidfd < 0)
+        return EH_RET_INVALID_STATE;
+    if(syscall(SYS_pidfd_send_signal, process->pidfd, signo, NULL, 0) < 0)
+        return EH_RET_FAULT;
+    return EH_RET_OK;
+}
+
+static bool _eh_process_is_exited(void *arg){
+    eh_process_t *process = (eh_process_t *)arg;
+    return process->exited;
+}
+
+int __async__ eh_process_wait(eh_process_t *process, int *status, eh_sclock_t timeout){
+    int ret;
+    if(!process->reaped){
+        ret = __await__ eh_event_wait_condition_timeout(&process->event, process, _eh_process_is_exited, timeout);
+        if(ret < 0)
+            return ret;
+        if(waitpid(process->pid, &process->status, WNOHANG) != process->pid)
+            return EH_RET_FAULT;
+        process->reaped = true;
+    }
+    if(status)
+        *status = process->status;
+    return EH_RET_OK;
+}
+
+static void _eh_process_free(eh_process_t *process){
+    if(process->pidfd >= 0){
+        epoll_hub_del_fd(process->pidfd);
+        close(process->pidfd);
+    }
+    eh_free(process);
+}
+
+/**
+ * @brief                           孤儿子进程的pidfd报告退出，此时waitpid不会阻塞
+ */
+static void _eh_process_orphan_callback(uint32_t events, void *arg){
+    eh_process_t *process = (eh_process_t *)arg;
+    (void)events;
+    if(waitpid(process->pid, &process->status, WNOHANG) == 0)
+        return ;
+    eh_list_del(&process->orphan_node);
+    _eh_process_free(process);
+}
+
+static intptr_t _eh_process_job_reap(void *arg){
+    return waitpid((pid_t)(intptr_t)arg, NULL, 0);
+}
+
+void eh_process_destroy(eh_process_t *process){
+    eh_offload_t *job;
+    for(int i = 0; i < EH_PROCESS_STDIO_CNT; i++)
+        eh_process_close(process, (enum eh_process_stdio)i);
+    eh_event_clean(&process->event);
+    if(process->reaped || waitpid(process->pid, &process->status, WNOHANG) == process->pid){
+        _eh_process_free(process);
+        return ;
+    }
+    if(process->pidfd >= 0){
+        /* 通过pidfd发送信号，退出后由pidfd的回调回收，不会阻塞调度器(子进程可能处于不可中断的睡眠中) */
+        syscall(SYS_pidfd_send_signal, process->pidfd, SIGKILL, NULL, 0);
+        process->action.callback = _eh_process_orphan_callback;
+        eh_list_add_tail(&process->orphan_node, &eh_process_orphan_list);
+        if(process->exited)
+            _eh_process_orphan_callback(0, process);
+        return ;
+    }
+    /* 没有pidfd时无法得到退出通知，在线程池中阻塞回收，提交失败时只能在这里等待 */
+    kill(process->pid, SIGKILL);
+    job = eh_offload_submit(_eh_process_job_reap, (void *)(intptr_t)process->pid);
+    if(eh_ptr_to_error(job) < 0)
+        waitpid(process->pid, &process->status, 0);
+    else
+        eh_offload_detach(job);
+    eh_free(process);
+}
+
+static int __init eh_process_init(void){
+    eh_list_head_init(&eh_process_orphan_list);
+    return EH_RET_OK;
+}
+
+/* 退出时还没有回收的孤儿子进程，此时已经没有事件循环，只能阻塞回收 */
+static void __exit eh_process_exit(void){
+    eh_process_t *process, *n;
+    eh_list_for_each_entry_safe(process, n, &eh_process_orphan_list, orphan_node){
+        eh_list_del(&process->orphan_node);
+        waitpid(process->pid, &process->status, 0);
+        _eh_process_free(process);
+    }
+}
+
+eh_interior_module_export(eh_process_init, eh_process_exit);
@@ -0,0 +1,57 @@
+/**
+ * @file eh_ringbuf_fd.c
+ * @brief linux下环形缓冲区与文件描述符之间的分散/聚集IO
+ * @author simon.xiaoapeng (simon.xiaoapeng@gmail.com)
+ * @version 1.0
+ * @date 2024-08-03
+ * 
+ * @copyright Copyright (c) 2024  simon.xiaoapeng@gmail.com
+ * 
+ * @par 修改日志:
+ */
+
+#include <errno.h>
+#include <sys/uio.h>
+#include "eh_ringbuf.h"
+#include "eh_ringbuf_fd.h"
+
+static void _span_to_iovec(const eh_ringbuf_span_t span[2], int cnt, struct iovec iov[2]){
+    for(int i = 0; i < cnt; i++){
+        iov[i].iov_base = span[i].buf;
+        iov[i].iov_len = (size_t)span[i].len;
+    }
+}
+
+ssize_t eh_ringbuf_readv_fd(eh_ringbuf_t *ringbuf, int fd){
+    eh_ringbuf_span_t span[2];
+    struct iovec iov[2];
+    ssize_t ret;
+    int cnt;
+
+    cnt = eh_ringbuf_free_span(ringbuf, span);
+    if(cnt == 0){
+        errno = ENOBUFS;
+        return -1;
+    }
+    _span_to_iovec(span, cnt, iov);
+    ret = readv(fd, iov, cnt);
+    if(ret > 0)
+        eh_ringbuf_write_skip(ringbuf, (int32_t)ret);
+    return ret;
+}
+
+ssize_t eh_ringbuf_writev_fd(eh_ringbuf_t *ringbuf, int fd){
+    eh_ringbuf_span_t span[2];
+    struct iovec iov[2];
+    ssize_t ret;
+    int cnt;
+
+    cnt = eh_ringbuf_used_span(ringbuf, span);
+    if(cnt == 0)
+        return 0;
+    _span_to_iovec(span, cnt, iov);
+    ret = writev(fd, iov, cnt);
+    if(ret > 0)
+        eh_ringbuf_read_skip(ringbuf, (int32_t)ret);
+    return ret;
+}
@@ -0,0 +1,318 @@
+/**
+ * @file eh_tcp_server.c
+ * @brief linux下基于eh_fd的TCP服务端框架，
+ *    工作任务的描述在创建服务端时按max_conn一次分配，任务本身在需要时才创建，创建后一直保留到服务端销毁，
+ *    接收任务只有在存在空闲工作任务或还能创建新工作任务时才会accept。
+ * @author simon.xiaoapeng (simon.xiaoapeng@gmail.com)
+ * @version 1.0
+ * @date 2024-08-28
+ *
+ * @copyright Copyright (c) 2024  simon.xiaoapeng@gmail.com
+ *
+ * @par 修改日志:
+ */
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include "eh.h"
+#include "eh_error.h"
+#include "eh_event.h"
+#include "eh_list.h"
+#include "eh_mem.h"
+#include "eh_platform.h"
+#include "eh_sleep.h"
+#include "eh_timer.h"
+#include "eh_fd.h"
+#include "eh_tcp_server.h"
+
+#define EH_TCP_SERVER_DEFAULT_BACKLOG           128
+#define EH_TCP_SERVER_DEFAULT_ACCEPT_BATCH      16
+#define EH_TCP_SERVER_DEFAULT_MAX_CONN          256
+#define EH_TCP_SERVER_DEFAULT_STACK_SIZE        (16*1024)
+/* fd耗尽等accept暂时失败时的退避时间 */
+#define EH_TCP_SERVER_ACCEPT_RETRY_MSEC         10
+
+#if defined(EH_CONFIG_TCP_SERVER_LISTENER_STACK_SIZE)
+#define EH_TCP_SERVER_LISTENER_STACK_SIZE       EH_CONFIG_TCP_SERVER_LISTENER_STACK_SIZE
+#else
+#define EH_TCP_SERVER_LISTENER_STACK_SIZE       (8*1024)
+#endif
+
+struct eh_tcp_worker{
+    struct eh_list_head             node;
+    eh_tcp_server_t                 *server;
+    eh_task_t                       *task;
+    eh_event_t                      event;
+    int                             fd;                 /* 正在处理的连接，空闲时为-1 */
+};
+
+struct eh_tcp_listener{
+    eh_tcp_server_t                 *server;
+    eh_task_t                       *task;
+    int                             fd;
+};
+
+struct eh_tcp_server{
+    int                             (*handler)(int fd, void *arg);
+    void                            *arg;
+    int                             accept_batch;
+    int                             max_conn;
+    unsigned long                   stack_size;
+    bool                            stopping;
+    int                             listener_cnt;
+    bool                            listeners_joined;   /* 接收任务已全部回收，再次调用destroy时只等待工作任务 */
+    struct eh_tcp_listener          *listeners;
+    int                             worker_cnt;
+    int                             active;
+    struct eh_tcp_worker            *workers;
+    struct eh_list_head             idle_list;
+    eh_event_t                      idle_event;         /* 有工作任务空闲或服务端停止时通知 */
+    uint64_t                        accepted;
+};
+
+void eh_tcp_server_config_init(struct eh_tcp_server_config *config){
+    memset(config, 0, sizeof(struct eh_tcp_server_config));
+    config->backlog = EH_TCP_SERVER_DEFAULT_BACKLOG;
+    config->listener_cnt = 1;
+    config->accept_batch = EH_TCP_SERVER_DEFAULT_ACCEPT_BATCH;
+    config->max_conn = EH_TCP_SERVER_DEFAULT_MAX_CONN;
+    config->stack_size = EH_TCP_SERVER_DEFAULT_STACK_SIZE;
+}
+
+static bool _eh_tcp_worker_has_job(void *arg){
+    struct eh_tcp_worker *worker = (struct eh_tcp_worker *)arg;
+    return worker->fd >= 0 || worker->server->stopping;
+}
+
+static int _eh_tcp_worker_task(void *arg){
+    struct eh_tcp_worker *worker = (struct eh_tcp_worker *)arg;
+    eh_tcp_server_t *server = worker->server;
+    int ret;
+    for(;;){
+        ret = __await__ eh_event_wait_condition_timeout(&worker->event, worker, _eh_tcp_worker_has_job, EH_TIME_FOREVER);
+        if(ret < 0 || worker->fd < 0)
+            break;
+        __await__ server->handler(worker->fd, server->arg);
+        eh_close(worker->fd);
+        worker->fd = -1;
+        server->active--;
+        if(server->stopping)
+            break;
+        eh_list_add(&worker->node, &server->idle_list);
+        eh_event_notify(&server->idle_event);
+    }
+    return 0;
+}
+
+static bool _eh_tcp_server_has_capacity(void *arg){
+    eh_tcp_server_t *server = (eh_tcp_server_t *)arg;
+    return server->stopping || !eh_list_empty(&server->idle_list) || server->worker_cnt < server->max_conn;
+}
+
+/**
+ * @brief                           将连接交给空闲的工作任务，没有空闲任务时创建新的工作任务
+ */
+static int _eh_tcp_server_dispatch(eh_tcp_server_t *server, int fd){
+    struct eh_tcp_worker *worker;
+    eh_task_t *task;
+    if(!eh_list_empty(&server->idle_list)){
+        worker = eh_list_entry(server->idle_list.next, struct eh_tcp_worker, node);
+        eh_list_del_init(&worker->node);
+        worker->fd = fd;
+        server->active++;
+        eh_event_notify(&worker->event);
+        return EH_RET_OK;
+    }
+    if(server->worker_cnt >= server->max_conn)
+        return EH_RET_BUSY;
+    worker = &server->workers[server->worker_cnt];
+    worker->server = server;
+    worker->fd = fd;
+    eh_list_head_init(&worker->node);
+    eh_event_init(&worker->event);
+    task = eh_task_create("tcp_worker", 0, server->stack_size, worker, _eh_tcp_worker_task);
+    if(eh_ptr_to_error(task) < 0){
+        eh_event_clean(&worker->event);
+        return eh_ptr_to_error(task);
+    }
+    worker->task = task;
+    server->worker_cnt++;
+    server->active++;
+    return EH_RET_OK;
+}
+
+static int _eh_tcp_listener_task(void *arg){
+    struct eh_tcp_listener *listener = (struct eh_tcp_listener *)arg;
+    eh_tcp_server_t *server = listener->server;
+    int fd, ret;
+    while(!server->stopping){
+        ret = __await__ eh_event_wait_condition_timeout(&server->idle_event, server, _eh_tcp_server_has_capacity, EH_TIME_FOREVER);
+        if(ret < 0 || server->stopping)
+            break;
+        /* 第一个连接阻塞等待，之后只取已经在backlog中的连接 */
+        for(int n = 0; n < server->accept_batch && _eh_tcp_server_has_capacity(server) && !server->stopping; n++){
+            fd = __await__ eh_accept(listener->fd, NULL, NULL, n == 0 ? EH_TIME_FOREVER : 0);
+            if(fd < 0){
+                if(server->stopping || errno == EBADF)
+                    return 0;
+                if(errno == EMFILE || errno == ENFILE || errno == ENOMEM || errno == ENOBUFS)
+                    __await__ eh_usleep(EH_TCP_SERVER_ACCEPT_RETRY_MSEC * 1000);
+                break;
+            }
+            server->accepted++;
+            if(_eh_tcp_server_dispatch(server, fd) < 0)
+                eh_close(fd);
+        }
+        __await__ eh_task_yield();
+    }
+    return 0;
+}
+
+static int _eh_tcp_listener_open(const struct eh_tcp_server_config *config, const struct sockaddr *addr, socklen_t addrlen, bool reuseport){
+    int fd, on = 1;
+    fd = socket(addr->sa_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if(fd < 0)
+        return EH_RET_FAULT;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    if(reuseport && setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on)) < 0)
+        goto error;
+    if(bind(fd, addr, addrlen) < 0 || listen(fd, config->backlog) < 0)
+        goto error;
+    if(eh_fd_register(fd) < 0)
+        goto error;
+    return fd;
+error:
+    close(fd);
+    return EH_RET_FAULT;
+}
+
+static void _eh_tcp_server_free(eh_tcp_server_t *server){
+    eh_event_clean(&server->idle_event);
+    eh_free(server);
+}
+
+eh_tcp_server_t* eh_tcp_server_create(const struct eh_tcp_server_config *config){
+    eh_tcp_server_t *server;
+    struct sockaddr_storage addr;
+    socklen_t addrlen;
+    bool reuseport;
+    size_t size;
+    int ret, fd;
+
+    if( config == NULL || config->handler == NULL || config->addr == NULL ||
+        config->addrlen == 0 || config->addrlen > sizeof(addr) ||
+        config->listener_cnt <= 0 || config->accept_batch <= 0 || config->max_conn <= 0 )
+        return eh_error_to_ptr(EH_RET_INVALID_PARAM);
+
+    size = sizeof(eh_tcp_server_t) +
+        sizeof(struct eh_tcp_listener) * (size_t)config->listener_cnt +
+        sizeof(struct eh_tcp_worker) * (size_t)config->max_conn;
+    server = eh_malloc(size);
+    if(server == NULL)
+        return eh_error_to_ptr(EH_RET_MALLOC_ERROR);
+    memset(server, 0, size);
+    server->handler = config->handler;
+    server->arg = config->arg;
+    server->accept_batch = config->accept_batch;
+    server->max_conn = config->max_conn;
+    server->stack_size = config->stack_size ? config->stack_size : EH_TCP_SERVER_DEFAULT_STACK_SIZE;
+    server->listeners = (struct eh_tcp_listener *)(server + 1);
+    server->workers = (struct eh_tcp_worker *)(server->listeners + config->listener_cnt);
+    eh_list_head_init(&server->idle_list);
+    eh_event_init(&server->idle_event);
+
+    /* 端口为0时，第一个socket绑定后取得的端口给之后的socket使用 */
+    memcpy(&addr, config->addr, config->addrlen);
+    addrlen = config->addrlen;
+    reuseport = config->reuseport || config->listener_cnt > 1;
+    for(int i = 0; i < config->listener_cnt; i++){
+        fd = _eh_tcp_listener_open(config, (struct sockaddr *)&addr, addrlen, reuseport);
+        if(fd < 0){
+            ret = fd;
+            goto listener_error;
+        }
+        server->listeners[i].server = server;
+        server->listeners[i].fd = fd;
+        server->listener_cnt++;
+        if(i == 0){
+            addrlen = sizeof(addr);
+            getsockname(fd, (struct sockaddr *)&addr, &addrlen);
+        }
+    }
+    for(int i = 0; i < server->listener_cnt; i++){
+        server->listeners[i].task = eh_task_create("tcp_listener", 0, EH_TCP_SERVER_LISTENER_STACK_SIZE, &server->listeners[i], _eh_tcp_listener_task);
+        ret = eh_ptr_to_error(server->listeners[i].task);
+        if(ret < 0){
+            /* 已经启动的接收任务还没有运行过，直接回收 */
+            for(int j = 0; j < i; j++)
+                eh_task_destroy(server->listeners[j].task);
+            goto listener_error;
+        }
+    }
+    return server;
+listener_error:
+    for(int i = 0; i < server->listener_cnt; i++)
+        eh_close(server->listeners[i].fd);
+    _eh_tcp_server_free(server);
+    return eh_error_to_ptr((intptr_t)ret);
+}
+
+int eh_tcp_server_local_addr(eh_tcp_server_t *server, struct sockaddr *addr, socklen_t *addrlen){
+    if(getsockname(server->listeners[0].fd, addr, addrlen) < 0)
+        return EH_RET_FAULT;
+    return EH_RET_OK;
+}
+
+void eh_tcp_server_stat(eh_tcp_server_t *server, struct eh_tcp_server_stat *stat){
+    stat->accepted = server->accepted;
+    stat->active = server->active;
+    stat->workers = server->worker_cnt;
+}
+
+int __async__ eh_tcp_server_destroy(eh_tcp_server_t *server, eh_sclock_t timeout){
+    eh_clock_t deadline = eh_time_is_forever(timeout) ? 0 : eh_get_clock_monotonic_time() + (eh_clock_t)timeout;
+    struct eh_tcp_worker *worker;
+    eh_sclock_t remain = timeout;
+    int ret;
+
+    if(!server->listeners_joined){
+        server->stopping = true;
+        eh_event_notify(&server->idle_event);
+        /* 注销后等待在accept上的接收任务返回EBADF，接收任务只等待accept和空闲事件，一定会退出 */
+        for(int i = 0; i < server->listener_cnt; i++)
+            eh_fd_unregister(server->listeners[i].fd);
+        for(int i = 0; i < server->listener_cnt; i++){
+            __await__ eh_task_join(server->listeners[i].task, &ret, EH_TIME_FOREVER);
+            close(server->listeners[i].fd);
+        }
+        server->listeners_joined = true;
+    }
+    for(int i = 0; i < server->worker_cnt; i++){
+        worker = &server->workers[i];
+        if(worker->task == NULL)
+            continue;
+        if(worker->fd >= 0)
+            shutdown(worker->fd, SHUT_RDWR);
+        else
+            eh_event_notify(&worker->event);
+    }
+    for(int i = 0; i < server->worker_cnt; i++){
+        worker = &server->workers[i];
+        if(worker->task == NULL)
+            continue;
+        if(!eh_time_is_forever(timeout)){
+            remain = (eh_sclock_t)(deadline - eh_get_clock_monotonic_time());
+            if(remain < 0)
+                remain = 0;
+        }
+        /* handler挂起在连接以外的事件上时shutdown无法唤醒它，超时后保留服务端，由调用者稍后再次销毁 */
+        if(__await__ eh_task_join(worker->task, &ret, remain) < 0)
+            return EH_RET_TIMEOUT;
+        worker->task = NULL;
+        eh_event_clean(&worker->event);
+    }
+    _eh_tcp_server_free(server);
+    return EH_RET_OK;
+}
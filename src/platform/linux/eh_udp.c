@@ -0,0 +1,217 @@
+/**
+ * @file eh_udp.c
+ * @brief linux下批量收发UDP报文，
+ *    批次在创建时一次分配报文描述、mmsghdr、iovec、控制消息和数据区，收发时只重新填写头部，
+ *    GSO的分段长度通过每个报文的UDP_SEGMENT控制消息传递，GRO的分段长度从接收的控制消息中取出。
+ * @author simon.xiaoapeng (simon.xiaoapeng@gmail.com)
+ * @version 1.0
+ * @date 2024-08-26
+ *
+ * @copyright Copyright (c) 2024  simon.xiaoapeng@gmail.com
+ *
+ * @par 修改日志:
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <string.h>
+#include <netinet/in.h>
+#include <netinet/udp.h>
+#include "eh.h"
+#include "eh_error.h"
+#include "eh_event.h"
+#include "eh_mem.h"
+#include "eh_platform.h"
+#include "eh_timer.h"
+#include "eh_fd.h"
+#include "eh_udp.h"
+
+#ifndef SOL_UDP
+#define SOL_UDP                     17
+#endif
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT                 103
+#endif
+#ifndef UDP_GRO
+#define UDP_GRO                     104
+#endif
+
+/* UDP_SEGMENT为uint16_t，UDP_GRO为int，按较大的分配 */
+typedef union{
+    char                            buf[CMSG_SPACE(sizeof(int))];
+    struct cmsghdr                  align;
+}eh_udp_cmsg_t;
+
+struct eh_udp_batch{
+    int                             max_cnt;
+    int                             cnt;
+    size_t                          msg_size;
+    struct eh_udp_msg               *msgs;
+    struct mmsghdr                  *hdrs;
+    struct iovec                    *iovs;
+    eh_udp_cmsg_t                   *cmsgs;
+    uint8_t                         *data;
+};
+
+eh_udp_batch_t* eh_udp_batch_create(int max_cnt, size_t msg_size){
+    eh_udp_batch_t *batch;
+    size_t n, size;
+    if(max_cnt <= 0 || msg_size == 0)
+        return eh_error_to_ptr(EH_RET_INVALID_PARAM);
+    n = (size_t)max_cnt;
+    size = sizeof(eh_udp_batch_t) +
+        n * (sizeof(struct eh_udp_msg) + sizeof(struct mmsghdr) + sizeof(struct iovec) + sizeof(eh_udp_cmsg_t)) +
+        n * msg_size;
+    batch = eh_malloc(size);
+    if(batch == NULL)
+        return eh_error_to_ptr(EH_RET_MALLOC_ERROR);
+    batch->max_cnt = max_cnt;
+    batch->cnt = 0;
+    batch->msg_size = msg_size;
+    batch->msgs = (struct eh_udp_msg *)(batch + 1);
+    batch->hdrs = (struct mmsghdr *)(batch->msgs + n);
+    batch->iovs = (struct iovec *)(batch->hdrs + n);
+    batch->cmsgs = (eh_udp_cmsg_t *)(batch->iovs + n);
+    batch->data = (uint8_t *)(batch->cmsgs + n);
+    for(size_t i = 0; i < n; i++)
+        batch->msgs[i].data = batch->data + i * msg_size;
+    return batch;
+}
+
+void eh_udp_batch_destroy(eh_udp_batch_t *batch){
+    eh_free(batch);
+}
+
+void eh_udp_batch_clear(eh_udp_batch_t *batch){
+    batch->cnt = 0;
+}
+
+int eh_udp_batch_count(eh_udp_batch_t *batch){
+    return batch->cnt;
+}
+
+struct eh_udp_msg* eh_udp_batch_msg(eh_udp_batch_t *batch, int idx){
+    if(idx < 0 || idx >= batch->cnt)
+        return NULL;
+    return &batch->msgs[idx];
+}
+
+int eh_udp_batch_add(eh_udp_batch_t *batch, const void *data, size_t len,
+    const struct sockaddr *addr, socklen_t addrlen, uint16_t segment_size){
+    struct eh_udp_msg *msg;
+    if(len > batch->msg_size || addrlen > sizeof(struct sockaddr_storage))
+        return EH_RET_INVALID_PARAM;
+    if(batch->cnt >= batch->max_cnt)
+        return EH_RET_BUSY;
+    msg = &batch->msgs[batch->cnt];
+    memcpy(msg->data, data, len);
+    msg->len = len;
+    if(addr && addrlen){
+        memcpy(&msg->addr, addr, addrlen);
+        msg->addrlen = addrlen;
+    }else{
+        msg->addrlen = 0;
+    }
+    msg->segment_size = segment_size;
+    batch->cnt++;
+    return EH_RET_OK;
+}
+
+static uint16_t _eh_udp_gro_size(struct msghdr *hdr){
+    struct cmsghdr *cmsg;
+    int gro_size;
+    for(cmsg = CMSG_FIRSTHDR(hdr); cmsg; cmsg = CMSG_NXTHDR(hdr, cmsg)){
+        if(cmsg->cmsg_level == SOL_UDP && cmsg->cmsg_type == UDP_GRO){
+            memcpy(&gro_size, CMSG_DATA(cmsg), sizeof(gro_size));
+            return (uint16_t)gro_size;
+        }
+    }
+    return 0;
+}
+
+int __async__ eh_udp_recv_batch(int fd, eh_udp_batch_t *batch, eh_sclock_t timeout){
+    struct msghdr *hdr;
+    int ret;
+    batch->cnt = 0;
+    for(int i = 0; i < batch->max_cnt; i++){
+        hdr = &batch->hdrs[i].msg_hdr;
+        batch->iovs[i].iov_base = batch->msgs[i].data;
+        batch->iovs[i].iov_len = batch->msg_size;
+        hdr->msg_name = &batch->msgs[i].addr;
+        hdr->msg_namelen = sizeof(struct sockaddr_storage);
+        hdr->msg_iov = &batch->iovs[i];
+        hdr->msg_iovlen = 1;
+        hdr->msg_control = batch->cmsgs[i].buf;
+        hdr->msg_controllen = sizeof(eh_udp_cmsg_t);
+        hdr->msg_flags = 0;
+    }
+    ret = __await__ eh_recvmmsg(fd, batch->hdrs, (unsigned int)batch->max_cnt, 0, timeout);
+    if(ret <= 0)
+        return ret < 0 ? -1 : 0;
+    for(int i = 0; i < ret; i++){
+        hdr = &batch->hdrs[i].msg_hdr;
+        batch->msgs[i].len = batch->hdrs[i].msg_len;
+        batch->msgs[i].addrlen = hdr->msg_namelen;
+        batch->msgs[i].segment_size = hdr->msg_controllen ? _eh_udp_gro_size(hdr) : 0;
+    }
+    batch->cnt = ret;
+    return ret;
+}
+
+int __async__ eh_udp_send_batch(int fd, eh_udp_batch_t *batch, eh_sclock_t timeout){
+    eh_clock_t deadline = eh_time_is_forever(timeout) ? 0 : eh_get_clock_monotonic_time() + (eh_clock_t)timeout;
+    struct msghdr *hdr;
+    struct cmsghdr *cmsg;
+    int sent = 0, ret = 0;
+    for(int i = 0; i < batch->cnt; i++){
+        struct eh_udp_msg *msg = &batch->msgs[i];
+        hdr = &batch->hdrs[i].msg_hdr;
+        batch->iovs[i].iov_base = msg->data;
+        batch->iovs[i].iov_len = msg->len;
+        hdr->msg_name = msg->addrlen ? &msg->addr : NULL;
+        hdr->msg_namelen = msg->addrlen;
+        hdr->msg_iov = &batch->iovs[i];
+        hdr->msg_iovlen = 1;
+        hdr->msg_control = NULL;
+        hdr->msg_controllen = 0;
+        hdr->msg_flags = 0;
+        if(msg->segment_size){
+            hdr->msg_control = batch->cmsgs[i].buf;
+            hdr->msg_controllen = CMSG_SPACE(sizeof(uint16_t));
+            cmsg = CMSG_FIRSTHDR(hdr);
+            cmsg->cmsg_level = SOL_UDP;
+            cmsg->cmsg_type = UDP_SEGMENT;
+            cmsg->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+            memcpy(CMSG_DATA(cmsg), &msg->segment_size, sizeof(uint16_t));
+        }
+    }
+    while(sent < batch->cnt){
+        if(!eh_time_is_forever(timeout) && timeout != 0){
+            timeout = (eh_sclock_t)(deadline - eh_get_clock_monotonic_time());
+            if(timeout <= 0){
+                errno = ETIMEDOUT;
+                ret = -1;
+                break;
+            }
+        }
+        ret = __await__ eh_sendmmsg(fd, batch->hdrs + sent, (unsigned int)(batch->cnt - sent), 0, timeout);
+        if(ret < 0)
+            break;
+        sent += ret;
+    }
+    /* 未发出的报文移到批次头部，交换描述而不是复制，每个描述仍指向各自的数据区 */
+    for(int i = sent; i < batch->cnt; i++){
+        struct eh_udp_msg tmp = batch->msgs[i - sent];
+        batch->msgs[i - sent] = batch->msgs[i];
+        batch->msgs[i] = tmp;
+    }
+    batch->cnt -= sent;
+    return sent ? sent : ret;
+}
+
+int eh_udp_set_gro(int fd, bool enable){
+    int val = enable ? 1 : 0;
+    if(setsockopt(fd, SOL_UDP, UDP_GRO, &val, sizeof(val)) < 0)
+        return EH_RET_INVALID_STATE;
+    return EH_RET_OK;
+}
@@ -11,24 +11,51 @@
  */
 
 
+#include <errno.h>
+#include <stdbool.h>
+#include <stdlib.h>
 #include <unistd.h>
+#include <sys/syscall.h>
 #include <sys/timerfd.h>
+#include <sys/prctl.h>
 #include <sys/epoll.h>
 #include <sys/eventfd.h>
 #include "eh.h"
+#include "eh_platform.h"
 #include "eh_module.h"
 #include "epoll_hub.h"
 
-#define EPOLL_WAIT_MAX_EVENTS 1024
+/* 一次epoll_wait取回的事件数在[MIN, MAX]之间自适应，取满时翻倍，连续SHRINK_POLLS轮不足1/4时减半 */
+#define EPOLL_WAIT_MIN_EVENTS           32
+#define EPOLL_WAIT_MAX_EVENTS           4096
+#define EPOLL_WAIT_SHRINK_POLLS         256
+
+/* 回退到timerfd时，截止时间的变化不超过该值则不重新设置定时器 */
+#define EPOLL_HUB_DEADLINE_SLACK_USEC   20
 
 struct epoll_hub{
     int                         epoll_fd;
-    int                         timeout_fd;             /* 使用定时器的方式实现ns级别的超时 */
+    int                         timeout_fd;             /* 内核不支持epoll_pwait2时，使用定时器的方式实现us级别的超时 */
     int                         wait_break_fd;
+    bool                        use_pwait2;
+    bool                        timeout_armed;
+    eh_usec_t                   timeout_deadline;       /* timerfd当前设置的绝对截止时间 */
+    uint64_t                    wait_cnt;
+    uint64_t                    timer_set_cnt;
     struct epoll_fd_action      wait_break_fd_action;
-    struct epoll_event          wait_events[1024];
+    struct epoll_fd_action      timeout_fd_action;
+    struct epoll_event          *wait_events;
+    int                         wait_events_size;
+    int                         shrink_cnt;             /* 连续取回事件不足wait_events_size/4的轮数 */
 }epoll_hub;
 
+static void event_timeout_callback(uint32_t events, void *arg){
+    uint64_t expirations;
+    (void) events;
+    (void) arg;
+    if(read(epoll_hub.timeout_fd, &expirations, sizeof(expirations)) > 0)
+        epoll_hub.timeout_armed = false;
+}
 
 static void event_wait_break_callback(uint32_t events, void *arg){
     (void) events;
@@ -59,34 +86,113 @@ int epoll_hub_del_fd(int fd){
 }
 
 
-int epoll_hub_poll(eh_usec_t usec_timeout){
-    struct itimerspec timeout_spec = {0};
-    int epoll_parameter_timeout;
+static int _epoll_hub_wait_pwait2(eh_usec_t usec_timeout){
+#ifdef __NR_epoll_pwait2
+    struct timespec ts;
     int ret;
+    ts.tv_sec = (__time_t)(usec_timeout / 1000000);
+    ts.tv_nsec = (__syscall_slong_t)((usec_timeout % 1000000) * 1000);
+    ret = (int)syscall(__NR_epoll_pwait2, epoll_hub.epoll_fd, epoll_hub.wait_events, epoll_hub.wait_events_size, &ts, NULL, 0);
+    if(ret < 0 && errno == ENOSYS)
+        epoll_hub.use_pwait2 = false;
+    return ret;
+#else
+    (void)usec_timeout;
+    epoll_hub.use_pwait2 = false;
+    errno = ENOSYS;
+    return -1;
+#endif
+}
+
+/**
+ * @brief                   epoll_wait只有ms精度，使用timerfd提供us级别的超时，
+ *                          定时器以绝对时间设置，只有截止时间真正改变时才重新设置
+ */
+static int _epoll_hub_wait_timerfd(eh_usec_t usec_timeout){
+    struct itimerspec timeout_spec = {0};
+    eh_usec_t deadline;
     if(usec_timeout){
-        timeout_spec.it_value.tv_sec = (__time_t)(usec_timeout / 1000000);
-        timeout_spec.it_value.tv_nsec = (__syscall_slong_t)((usec_timeout % 1000000) * 1000);
-        epoll_parameter_timeout = -1;        
-    }else{
-        timeout_spec.it_value.tv_sec = 0;
-        timeout_spec.it_value.tv_nsec = 0;
-        epoll_parameter_timeout = 0;
+        deadline = (eh_usec_t)platform_get_clock_monotonic_time() + usec_timeout;
+        if( !epoll_hub.timeout_armed || 
+            deadline + EPOLL_HUB_DEADLINE_SLACK_USEC < epoll_hub.timeout_deadline ||
+            deadline > epoll_hub.timeout_deadline + EPOLL_HUB_DEADLINE_SLACK_USEC ){
+            timeout_spec.it_value.tv_sec = (__time_t)(deadline / 1000000);
+            timeout_spec.it_value.tv_nsec = (__syscall_slong_t)((deadline % 1000000) * 1000);
+            timerfd_settime(epoll_hub.timeout_fd, TFD_TIMER_ABSTIME, &timeout_spec, NULL);
+            epoll_hub.timer_set_cnt++;
+            epoll_hub.timeout_armed = true;
+            epoll_hub.timeout_deadline = deadline;
+        }
+    }
+    return epoll_wait(epoll_hub.epoll_fd,  epoll_hub.wait_events, epoll_hub.wait_events_size, usec_timeout ? -1 : 0);
+}
+
+static void _epoll_hub_resize(int size){
+    struct epoll_event *wait_events;
+    wait_events = realloc(epoll_hub.wait_events, sizeof(struct epoll_event) * (size_t)size);
+    /* 分配失败时保持原来的大小，下次再尝试 */
+    if(wait_events == NULL)
+        return ;
+    epoll_hub.wait_events = wait_events;
+    epoll_hub.wait_events_size = size;
+}
+
+/**
+ * @brief                   根据本轮取回的事件数调整下一轮的批量大小，
+ *                          取满说明还有事件留在内核中，立即扩大，
+ *                          缩小则需要连续多轮都用不到，避免突发流量下反复申请内存
+ */
+static void _epoll_hub_adjust_batch(int cnt){
+    if(cnt >= epoll_hub.wait_events_size){
+        epoll_hub.shrink_cnt = 0;
+        if(epoll_hub.wait_events_size < EPOLL_WAIT_MAX_EVENTS)
+            _epoll_hub_resize(epoll_hub.wait_events_size * 2);
+        return ;
     }
+    if(epoll_hub.wait_events_size <= EPOLL_WAIT_MIN_EVENTS || cnt > epoll_hub.wait_events_size / 4){
+        epoll_hub.shrink_cnt = 0;
+        return ;
+    }
+    if(++epoll_hub.shrink_cnt >= EPOLL_WAIT_SHRINK_POLLS){
+        epoll_hub.shrink_cnt = 0;
+        _epoll_hub_resize(epoll_hub.wait_events_size / 2);
+    }
+}
 
-    timerfd_settime(epoll_hub.timeout_fd, 0, &timeout_spec, NULL);
-    ret = epoll_wait(epoll_hub.epoll_fd,  epoll_hub.wait_events, EPOLL_WAIT_MAX_EVENTS, epoll_parameter_timeout);
-    if(ret <= 0) return  ret;
+int epoll_hub_poll(eh_usec_t usec_timeout){
+    int ret = -1;
+    epoll_hub.wait_cnt++;
+    if(epoll_hub.use_pwait2)
+        ret = _epoll_hub_wait_pwait2(usec_timeout);
+    if(!epoll_hub.use_pwait2)
+        ret = _epoll_hub_wait_timerfd(usec_timeout);
+    if(ret < 0) return  ret;
     for(int i = 0; i < ret; i++){
         struct epoll_event *event = &epoll_hub.wait_events[i];
         struct epoll_fd_action *action = event->data.ptr;
-        if(action && action->callback)
+        if(action == NULL)
+            continue;
+        action->revents |= event->events;
+        if(action->callback)
             action->callback(event->events, action->arg);
     }
+    _epoll_hub_adjust_batch(ret);
     
 
     return 0;
 }
 
+void epoll_hub_stat(uint64_t *wait_cnt, uint64_t *timer_set_cnt){
+    if(wait_cnt)
+        *wait_cnt = epoll_hub.wait_cnt;
+    if(timer_set_cnt)
+        *timer_set_cnt = epoll_hub.timer_set_cnt;
+}
+
+int epoll_hub_batch_size(void){
+    return epoll_hub.wait_events_size;
+}
+
 
 
 int __init epoll_hub_init(void){
@@ -95,6 +201,15 @@ int __init epoll_hub_init(void){
     if(ret < 0)
         return -1;
     epoll_hub.epoll_fd = ret;
+
+    epoll_hub.wait_events = NULL;
+    epoll_hub.wait_events_size = 0;
+    epoll_hub.shrink_cnt = 0;
+    _epoll_hub_resize(EPOLL_WAIT_MIN_EVENTS);
+    if(epoll_hub.wait_events == NULL){
+        ret = -1;
+        goto wait_events_alloc_error;
+    }
     
     ret = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
     if(ret < 0)
@@ -108,12 +223,33 @@ int __init epoll_hub_init(void){
 
     epoll_hub.wait_break_fd_action.arg = NULL;
     epoll_hub.wait_break_fd_action.callback = event_wait_break_callback;
+    epoll_hub.wait_break_fd_action.revents = 0;
 
     ret = epoll_hub_add_fd(epoll_hub.wait_break_fd, EPOLLIN, &epoll_hub.wait_break_fd_action);
     if(ret < 0)
         goto epoll_hub_add_fd_error;
 
-    ret = epoll_hub_add_fd(epoll_hub.timeout_fd, EPOLLIN, NULL);
+    epoll_hub.timeout_fd_action.arg = NULL;
+    epoll_hub.timeout_fd_action.callback = event_timeout_callback;
+    epoll_hub.timeout_fd_action.revents = 0;
+    epoll_hub.timeout_armed = false;
+    epoll_hub.timeout_deadline = 0;
+#if defined(EH_CONFIG_LINUX_EPOLL_HUB_PWAIT2)
+    epoll_hub.use_pwait2 = true;
+#else
+    epoll_hub.use_pwait2 = false;
+#endif
+#if defined(EH_CONFIG_LINUX_EPOLL_HUB_TIMERSLACK_NSEC)
+    /*
+     * 超时精度受调用线程timer slack(默认50us)的影响，timer slack是整个线程的属性，
+     * 会同时改变该线程上其他定时等待的唤醒方式，只在用户显式配置时才修改
+     */
+    prctl(PR_SET_TIMERSLACK, (unsigned long)(EH_CONFIG_LINUX_EPOLL_HUB_TIMERSLACK_NSEC), 0UL, 0UL, 0UL);
+#endif
+    epoll_hub.wait_cnt = 0;
+    epoll_hub.timer_set_cnt = 0;
+
+    ret = epoll_hub_add_fd(epoll_hub.timeout_fd, EPOLLIN, &epoll_hub.timeout_fd_action);
     if(ret < 0)
         goto epoll_hub_add_fd_error;
 
@@ -124,6 +260,9 @@ epoll_hub_add_fd_error:
 eventfd_error:
     close(epoll_hub.timeout_fd);
 timerfd_create_error:
+    free(epoll_hub.wait_events);
+    epoll_hub.wait_events = NULL;
+wait_events_alloc_error:
     close(epoll_hub.epoll_fd);
     return ret;
 }
@@ -131,4 +270,6 @@ timerfd_create_error:
 void __exit epoll_hub_exit(void){
     close(epoll_hub.epoll_fd);
     close(epoll_hub.timeout_fd);
+    free(epoll_hub.wait_events);
+    epoll_hub.wait_events = NULL;
 }
\ No newline at end of file
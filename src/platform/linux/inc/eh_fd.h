@@ -0,0 +1,125 @@
+/**
+ * @file eh_fd.h
+ * @brief linux下基于epoll_hub的异步文件描述符IO，
+ *    fd首次使用时被设置为非阻塞并以边沿触发方式加入epoll_hub，之后一直保持注册，不会为每次操作调用epoll_ctl，
+ *    读写类函数先直接进行非阻塞的系统调用，只有返回EAGAIN时才挂起当前任务等待fd就绪，
+ *    已知不可读写的fd(之前返回过EAGAIN或流式fd读写长度不足，且之后没有新的就绪通知)直接挂起，不再进行系统调用。
+ *      使用限制: 此模块所有的函数都只能在协程上下文中使用，
+ *               经过此模块使用(注册)的fd必须用eh_close关闭(或先eh_fd_unregister再close)，
+ *               直接close时fd的上下文会残留，复用该fd号的新文件在挂起等待前才会被发现并重新注册，
+ *               若旧文件还被dup出的其他fd引用，其就绪通知仍会唤醒新fd上的等待者
+ * @author simon.xiaoapeng (simon.xiaoapeng@gmail.com)
+ * @version 1.0
+ * @date 2024-08-20
+ *
+ * @copyright Copyright (c) 2024  simon.xiaoapeng@gmail.com
+ *
+ * @par 修改日志:
+ */
+
+#ifndef _EH_FD_H_
+#define _EH_FD_H_
+
+#include <stdint.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include "eh_types.h"
+
+struct mmsghdr;
+struct iovec;
+
+#ifdef __cplusplus
+#if __cplusplus
+extern "C"{
+#endif
+#endif /* __cplusplus */
+
+/**
+ * @brief                           将fd设置为非阻塞并加入epoll_hub，其他函数首次使用fd时会自动调用
+ * @param  fd                       文件描述符
+ * @return int                      见eh_error.h
+ */
+extern int eh_fd_register(int fd);
+
+/**
+ * @brief                           将fd从epoll_hub中移除，正在等待该fd的任务返回EH_RET_EVENT_ERROR
+ * @param  fd                       文件描述符
+ */
+extern void eh_fd_unregister(int fd);
+
+/**
+ * @brief                           等待fd就绪
+ * @param  fd                       文件描述符
+ * @param  events                   EPOLLIN和(或)EPOLLOUT
+ * @param  timeout                  超时时间，0为不等待，EH_TIME_FOREVER为永久等待
+ * @return int                      成功返回已就绪的事件(EPOLLIN/EPOLLOUT，出错或挂断时两者都会置位)，
+ *                                  失败返回见eh_error.h
+ */
+extern int __async__ eh_fd_wait(int fd, uint32_t events, eh_sclock_t timeout);
+
+/**
+ * 以下函数与同名的系统调用语义一致，fd暂时不可读写时挂起当前任务，
+ * 失败返回-1并设置errno，超时errno为ETIMEDOUT，等待期间fd被eh_fd_unregister时errno为EBADF
+ */
+extern ssize_t __async__ eh_read(int fd, void *buf, size_t len, eh_sclock_t timeout);
+extern ssize_t __async__ eh_write(int fd, const void *buf, size_t len, eh_sclock_t timeout);
+extern ssize_t __async__ eh_readv(int fd, const struct iovec *iov, int iovcnt, eh_sclock_t timeout);
+extern ssize_t __async__ eh_writev(int fd, const struct iovec *iov, int iovcnt, eh_sclock_t timeout);
+extern ssize_t __async__ eh_recv(int fd, void *buf, size_t len, int flags, eh_sclock_t timeout);
+extern ssize_t __async__ eh_send(int fd, const void *buf, size_t len, int flags, eh_sclock_t timeout);
+extern int __async__ eh_recvmmsg(int fd, struct mmsghdr *msgvec, unsigned int vlen, int flags, eh_sclock_t timeout);
+extern int __async__ eh_sendmmsg(int fd, struct mmsghdr *msgvec, unsigned int vlen, int flags, eh_sclock_t timeout);
+
+/**
+ * @brief                           零拷贝传输，数据在内核中从in_fd(普通文件)直接发送到out_fd，
+ *                                  out_fd暂时不可写时挂起当前任务，语义与sendfile一致
+ * @return ssize_t                  成功返回传输的字节数，失败返回-1并设置errno
+ */
+extern ssize_t __async__ eh_sendfile(int out_fd, int in_fd, off_t *offset, size_t count, eh_sclock_t timeout);
+
+/**
+ * @brief                           在两个fd之间移动数据(至少一端是管道)，语义与splice一致，
+ *                                  总是附加SPLICE_F_NONBLOCK，哪一端暂时不可读写就等待哪一端，
+ *                                  SPLICE_F_NONBLOCK只对管道生效，另一端的socket需要已经是非阻塞的(或已eh_fd_register)
+ * @return ssize_t                  成功返回移动的字节数(0代表fd_in已到结尾)，失败返回-1并设置errno
+ */
+extern ssize_t __async__ eh_splice(int fd_in, off_t *off_in, int fd_out, off_t *off_out, size_t len, unsigned int flags, eh_sclock_t timeout);
+
+/**
+ * @brief                           复制管道fd_in中的数据到管道fd_out，不消耗fd_in中的数据，
+ *                                  用于旁路监听/镜像，语义与tee一致
+ * @return ssize_t                  成功返回复制的字节数，失败返回-1并设置errno
+ */
+extern ssize_t __async__ eh_tee(int fd_in, int fd_out, size_t len, unsigned int flags, eh_sclock_t timeout);
+
+/**
+ * @brief                           接收连接，新的连接已设置为非阻塞并注册
+ * @return int                      成功返回新连接的fd，失败返回-1并设置errno
+ */
+extern int __async__ eh_accept(int fd, struct sockaddr *addr, socklen_t *addrlen, eh_sclock_t timeout);
+
+/**
+ * @brief                           发起连接并等待连接完成
+ * @return int                      成功返回0，失败返回-1并设置errno
+ */
+extern int __async__ eh_connect(int fd, const struct sockaddr *addr, socklen_t addrlen, eh_sclock_t timeout);
+
+/**
+ * @brief                           获取系统调用返回EAGAIN的次数和根据就绪状态缓存跳过的系统调用次数
+ */
+extern void eh_fd_stat(uint64_t *again_cnt, uint64_t *skip_cnt);
+
+/**
+ * @brief                           注销并关闭fd
+ */
+extern int eh_close(int fd);
+
+#ifdef __cplusplus
+#if __cplusplus
+}
+#endif
+#endif /* __cplusplus */
+
+
+#endif // _EH_FD_H_
@@ -0,0 +1,101 @@
+/**
+ * @file eh_file.h
+ * @brief linux下普通文件的异步IO，
+ *    普通文件不支持epoll，读写时会阻塞线程，此模块把实际的IO交给io_uring(EH_CONFIG_LINUX_IO_URING=ON时)
+ *    或eh_offload线程池执行，等待期间只挂起当前任务。
+ *    可选的顺序预读: 连续的顺序读从预读缓冲区中取数据，一次IO读入整个缓冲区，随机读不经过缓冲区。
+ *    可选的写合并: 相邻的小块写先放入写缓冲区，缓冲区满、写入不相邻、读、fsync或关闭时才一次写出。
+ *      使用限制: 此模块所有的函数都只能在协程上下文中使用，同一个文件同一时刻只能由一个任务操作，
+ *               写缓冲区中的数据在eh_file_flush之前对其他进程不可见
+ * @author simon.xiaoapeng (simon.xiaoapeng@gmail.com)
+ * @version 1.0
+ * @date 2024-09-06
+ *
+ * @copyright Copyright (c) 2024  simon.xiaoapeng@gmail.com
+ *
+ * @par 修改日志:
+ */
+
+#ifndef _EH_FILE_H_
+#define _EH_FILE_H_
+
+#include <stdint.h>
+#include <sys/types.h>
+#include "eh_types.h"
+
+#ifdef __cplusplus
+#if __cplusplus
+extern "C"{
+#endif
+#endif /* __cplusplus */
+
+typedef struct eh_file eh_file_t;
+
+struct eh_file_stat{
+    uint64_t                        read_io;            /* 实际提交的读IO次数 */
+    uint64_t                        write_io;           /* 实际提交的写IO次数 */
+    uint64_t                        readahead_hit;      /* 完全由预读缓冲区满足的读次数 */
+    uint64_t                        write_merged;       /* 被合并进写缓冲区的写次数 */
+};
+
+/**
+ * @brief                           打开文件，语义与open一致，总是附加O_CLOEXEC
+ * @return eh_file_t*               返回值请使用eh_ptr_to_error来判断是否成功，失败时errno为open的错误码
+ */
+extern eh_file_t* __async__ eh_file_open(const char *path, int flags, mode_t mode);
+
+/**
+ * @brief                           设置顺序预读缓冲区的大小，0为关闭(默认)
+ * @return int                      见eh_error.h
+ */
+extern int eh_file_set_readahead(eh_file_t *file, size_t size);
+
+/**
+ * @brief                           设置写合并缓冲区的大小，0为关闭(默认)，缩小或关闭前需先eh_file_flush
+ * @return int                      见eh_error.h，缓冲区中还有数据时返回EH_RET_BUSY
+ */
+extern int eh_file_set_write_coalesce(eh_file_t *file, size_t size);
+
+/**
+ * 以下函数与同名的系统调用语义一致，失败返回-1并设置errno，
+ * eh_file_read/eh_file_write使用并推进eh_file内部维护的文件位置，
+ * 以O_APPEND打开时写总是追加到文件末尾
+ */
+extern ssize_t __async__ eh_file_read(eh_file_t *file, void *buf, size_t len);
+extern ssize_t __async__ eh_file_write(eh_file_t *file, const void *buf, size_t len);
+extern ssize_t __async__ eh_file_pread(eh_file_t *file, void *buf, size_t len, off_t offset);
+extern ssize_t __async__ eh_file_pwrite(eh_file_t *file, const void *buf, size_t len, off_t offset);
+
+/**
+ * @brief                           设置eh_file_read/eh_file_write使用的文件位置
+ */
+extern void eh_file_seek(eh_file_t *file, off_t offset);
+
+/**
+ * @brief                           写出写缓冲区中的数据
+ * @return int                      成功返回0，失败返回-1并设置errno，未写出的数据保留在缓冲区中
+ */
+extern int __async__ eh_file_flush(eh_file_t *file);
+
+/**
+ * @brief                           写出写缓冲区中的数据后fsync
+ * @return int                      成功返回0，失败返回-1并设置errno
+ */
+extern int __async__ eh_file_fsync(eh_file_t *file);
+
+/**
+ * @brief                           写出写缓冲区中的数据后关闭文件，无论成功与否文件都被释放
+ * @return int                      成功返回0，失败返回-1并设置errno
+ */
+extern int __async__ eh_file_close(eh_file_t *file);
+
+extern void eh_file_get_stat(eh_file_t *file, struct eh_file_stat *stat);
+
+#ifdef __cplusplus
+#if __cplusplus
+}
+#endif
+#endif /* __cplusplus */
+
+
+#endif // _EH_FILE_H_
@@ -0,0 +1,81 @@
+/**
+ * @file eh_offload.h
+ * @brief linux下把会阻塞的调用(文件IO、fsync、getaddrinfo、压缩等)交给固定数量的线程执行，
+ *    调度器所在线程提交任务后挂起等待，不会阻塞其他协程。
+ *    线程完成的任务放入完成链表，只有链表由空变为非空时才通知调度器，
+ *    调度器被唤醒后一次取走全部完成的任务并唤醒对应的等待者。
+ *    线程池在第一次提交时创建。
+ *      使用限制: 此模块所有的函数都只能在调度器所在线程中调用，
+ *               fn在其他线程中运行，不能调用本库除__safety标记之外的任何函数
+ * @author simon.xiaoapeng (simon.xiaoapeng@gmail.com)
+ * @version 1.0
+ * @date 2024-08-30
+ *
+ * @copyright Copyright (c) 2024  simon.xiaoapeng@gmail.com
+ *
+ * @par 修改日志:
+ */
+
+#ifndef _EH_OFFLOAD_H_
+#define _EH_OFFLOAD_H_
+
+#include <stdint.h>
+#include "eh_types.h"
+
+#ifdef __cplusplus
+#if __cplusplus
+extern "C"{
+#endif
+#endif /* __cplusplus */
+
+/* 线程池中的线程数 */
+#if defined(EH_CONFIG_OFFLOAD_THREAD_CNT)
+#define EH_OFFLOAD_THREAD_CNT               EH_CONFIG_OFFLOAD_THREAD_CNT
+#else
+#define EH_OFFLOAD_THREAD_CNT               4
+#endif
+
+typedef struct eh_offload eh_offload_t;
+
+/**
+ * @brief                           提交一个在线程池中执行的函数
+ * @param  fn                       在其他线程中执行的函数，返回值通过eh_offload_wait取得
+ * @param  arg                      fn的参数
+ * @return eh_offload_t*            返回值请使用eh_ptr_to_error来判断是否提交成功
+ */
+extern eh_offload_t* eh_offload_submit(intptr_t (*fn)(void *arg), void *arg);
+
+/**
+ * @brief                           等待提交的函数执行完成，成功后任务被释放，
+ *                                  errno被设置为fn返回时工作线程中的errno
+ * @param  job                      eh_offload_submit的返回值
+ * @param  result                   fn的返回值，可为NULL
+ * @param  timeout                  超时时间，0为不等待，EH_TIME_FOREVER为永久等待
+ * @return int                      见eh_error.h，超时返回EH_RET_TIMEOUT，此时任务依然有效，可再次等待或者分离
+ */
+extern int __async__ eh_offload_wait(eh_offload_t *job, intptr_t *result, eh_sclock_t timeout);
+
+/**
+ * @brief                           不再等待任务，任务完成后自动释放
+ */
+extern void eh_offload_detach(eh_offload_t *job);
+
+/**
+ * @brief                           提交并等待完成
+ * @return int                      见eh_error.h
+ */
+extern int __async__ eh_offload_call(intptr_t (*fn)(void *arg), void *arg, intptr_t *result);
+
+/**
+ * @brief                           获取已完成的任务数和唤醒调度器的次数，用于观察完成通知的合并效果
+ */
+extern void eh_offload_stat(uint64_t *completed, uint64_t *wakeups);
+
+#ifdef __cplusplus
+#if __cplusplus
+}
+#endif
+#endif /* __cplusplus */
+
+
+#endif // _EH_OFFLOAD_H_
@@ -0,0 +1,85 @@
+/**
+ * @file eh_posix_signal.h
+ * @brief linux下将POSIX信号(SIGTERM、SIGHUP、SIGCHLD等)转换为eh事件，
+ *    所有被使用的信号共用一个signalfd，注册在epoll_hub中，信号到来时调度器被唤醒一次，
+ *    一次读出所有排队的siginfo，按信号分别放入各自的队列后通知对应的事件。
+ *    被使用的信号会在进程中被阻塞，不再按原有的处理方式处理。
+ *      使用限制: 此模块所有的函数都只能在调度器所在线程中调用，
+ *               信号屏蔽字只对调用线程和之后创建的线程生效，请在创建其他线程之前调用eh_posix_signal_event，
+ *               或在其他线程中自行阻塞这些信号，否则信号可能被投递到其他线程而不经过signalfd
+ * @author simon.xiaoapeng (simon.xiaoapeng@gmail.com)
+ * @version 1.0
+ * @date 2024-09-02
+ *
+ * @copyright Copyright (c) 2024  simon.xiaoapeng@gmail.com
+ *
+ * @par 修改日志:
+ */
+
+#ifndef _EH_POSIX_SIGNAL_H_
+#define _EH_POSIX_SIGNAL_H_
+
+#include <sys/signalfd.h>
+#include "eh_types.h"
+#include "eh_event.h"
+
+#ifdef __cplusplus
+#if __cplusplus
+extern "C"{
+#endif
+#endif /* __cplusplus */
+
+/* 每个信号最多缓存的siginfo数，队列满时新到的siginfo被丢弃，只保留事件通知 */
+#if defined(EH_CONFIG_POSIX_SIGNAL_QUEUE_SIZE)
+#define EH_POSIX_SIGNAL_QUEUE_SIZE          EH_CONFIG_POSIX_SIGNAL_QUEUE_SIZE
+#else
+#define EH_POSIX_SIGNAL_QUEUE_SIZE          16
+#endif
+
+/**
+ * @brief                           获取信号对应的事件，第一次调用时阻塞该信号并加入signalfd
+ *                                  可以直接使用eh_event_wait或将事件注册到eh_epoll/event_cb中
+ * @param  signo                    信号值，SIGKILL和SIGSTOP无法被接管
+ * @return eh_event_t*              返回值请使用eh_ptr_to_error来判断是否成功
+ */
+extern eh_event_t* eh_posix_signal_event(int signo);
+
+/**
+ * @brief                           取出已经收到的siginfo，不等待
+ * @param  signo                    信号值
+ * @param  info                     存放siginfo的数组
+ * @param  n                        数组的长度
+ * @return int                      成功返回取出的个数，信号未被接管返回EH_RET_INVALID_STATE
+ */
+extern int eh_posix_signal_read(int signo, struct signalfd_siginfo *info, int n);
+
+/**
+ * @brief                           等待信号到来并取出siginfo，第一次调用时会自动接管信号
+ * @param  signo                    信号值
+ * @param  info                     存放siginfo的数组
+ * @param  n                        数组的长度
+ * @param  timeout                  超时时间，0为不等待，EH_TIME_FOREVER为永久等待
+ * @return int                      成功返回取出的个数(>0)，见eh_error.h
+ */
+extern int __async__ eh_posix_signal_wait(int signo, struct signalfd_siginfo *info, int n, eh_sclock_t timeout);
+
+/**
+ * @brief                           获取因队列已满而丢弃的siginfo数
+ */
+extern uint64_t eh_posix_signal_dropped(int signo);
+
+/**
+ * @brief                           不再接管信号，丢弃还未被处理的该信号后解除阻塞，
+ *                                  等待该信号事件的任务将返回错误
+ * @param  signo                    信号值
+ */
+extern void eh_posix_signal_release(int signo);
+
+#ifdef __cplusplus
+#if __cplusplus
+}
+#endif
+#endif /* __cplusplus */
+
+
+#endif // _EH_POSIX_SIGNAL_H_
@@ -0,0 +1,125 @@
+/**
+ * @file eh_process.h
+ * @brief linux下的异步子进程，
+ *    通过posix_spawn创建子进程，子进程的pidfd注册在epoll_hub中，等待退出时只挂起当前任务，
+ *    不需要回收线程或阻塞的waitpid，标准输入输出可以选择接为非阻塞管道，配合环形缓冲区读写。
+ *      使用限制: 此模块所有的函数都只能在调度器所在线程中调用，需要linux >= 5.3 (pidfd_open)，
+ *               SIGCHLD不能设置为SIG_IGN(子进程会被内核自动回收)，
+ *               也不要在其他地方对这些子进程调用waitpid(-1, ...)
+ * @author simon.xiaoapeng (simon.xiaoapeng@gmail.com)
+ * @version 1.0
+ * @date 2024-09-04
+ *
+ * @copyright Copyright (c) 2024  simon.xiaoapeng@gmail.com
+ *
+ * @par 修改日志:
+ */
+
+#ifndef _EH_PROCESS_H_
+#define _EH_PROCESS_H_
+
+#include <stdbool.h>
+#include <sys/types.h>
+#include "eh_types.h"
+#include "eh_ringbuf.h"
+
+#ifdef __cplusplus
+#if __cplusplus
+extern "C"{
+#endif
+#endif /* __cplusplus */
+
+typedef struct eh_process eh_process_t;
+
+enum eh_process_stdio{
+    EH_PROCESS_STDIN,
+    EH_PROCESS_STDOUT,
+    EH_PROCESS_STDERR,
+    EH_PROCESS_STDIO_CNT,
+};
+
+struct eh_process_config{
+    const char                      *path;              /* 可执行文件，search_path为true时按PATH查找 */
+    char *const                     *argv;              /* 以NULL结尾，为NULL时使用{path, NULL} */
+    char *const                     *envp;              /* 以NULL结尾，为NULL时继承当前进程的环境变量 */
+    bool                            search_path;
+    bool                            pipe[EH_PROCESS_STDIO_CNT];     /* 为true时接为管道，否则继承当前进程的描述符 */
+};
+
+/**
+ * @brief                           初始化配置，不创建任何管道，继承当前进程的环境变量
+ */
+extern void eh_process_config_init(struct eh_process_config *config, const char *path);
+
+/**
+ * @brief                           创建子进程
+ * @param  config                   配置
+ * @return eh_process_t*            返回值请使用eh_ptr_to_error来判断是否成功
+ */
+extern eh_process_t* eh_process_spawn(const struct eh_process_config *config);
+
+/**
+ * @brief                           获取子进程的pid
+ */
+extern pid_t eh_process_pid(eh_process_t *process);
+
+/**
+ * @brief                           获取管道在当前进程中的描述符，已注册到eh_fd，可以直接使用eh_read/eh_write
+ * @return int                      没有接为管道或已关闭时返回-1
+ */
+extern int eh_process_fd(eh_process_t *process, enum eh_process_stdio stdio);
+
+/**
+ * @brief                           从子进程的stdout/stderr读取数据到环形缓冲区的空闲区域，
+ *                                  没有数据时挂起当前任务
+ * @param  process                  子进程
+ * @param  stdio                    EH_PROCESS_STDOUT或EH_PROCESS_STDERR
+ * @param  ringbuf                  环形缓冲区
+ * @param  timeout                  超时时间，0为不等待，EH_TIME_FOREVER为永久等待
+ * @return ssize_t                  成功返回读到的字节数(0代表子进程关闭了管道)，
+ *                                  失败返回-1并设置errno，缓冲区已满时errno为ENOBUFS，超时errno为ETIMEDOUT
+ */
+extern ssize_t __async__ eh_process_read(eh_process_t *process, enum eh_process_stdio stdio,
+    eh_ringbuf_t *ringbuf, eh_sclock_t timeout);
+
+/**
+ * @brief                           将环形缓冲区中的数据写入子进程的stdin，管道已满时挂起当前任务
+ * @return ssize_t                  成功返回写出的字节数，缓冲区为空时返回0，失败返回-1并设置errno
+ */
+extern ssize_t __async__ eh_process_write(eh_process_t *process, eh_ringbuf_t *ringbuf, eh_sclock_t timeout);
+
+/**
+ * @brief                           关闭当前进程一侧的管道，关闭stdin后子进程读到EOF
+ */
+extern void eh_process_close(eh_process_t *process, enum eh_process_stdio stdio);
+
+/**
+ * @brief                           向子进程发送信号，子进程已被回收时不会误发给复用了pid的其他进程
+ * @return int                      见eh_error.h
+ */
+extern int eh_process_kill(eh_process_t *process, int signo);
+
+/**
+ * @brief                           等待子进程退出并回收
+ * @param  process                  子进程
+ * @param  status                   waitpid格式的退出状态，使用WIFEXITED/WEXITSTATUS等宏解析，可为NULL
+ * @param  timeout                  超时时间，0为不等待，EH_TIME_FOREVER为永久等待
+ * @return int                      见eh_error.h，已回收的子进程可以重复获取退出状态
+ */
+extern int __async__ eh_process_wait(eh_process_t *process, int *status, eh_sclock_t timeout);
+
+/**
+ * @brief                           释放子进程，关闭所有管道，
+ *                                  子进程还未退出时发送SIGKILL后立即返回，不会阻塞调度器，
+ *                                  子进程退出后在事件循环中被回收，不会留下僵尸进程
+ */
+extern void eh_process_destroy(eh_process_t *process);
+
+#ifdef __cplusplus
+#if __cplusplus
+}
+#endif
+#endif /* __cplusplus */
+
+
+#endif // _EH_PROCESS_H_
@@ -0,0 +1,53 @@
+/**
+ * @file eh_ringbuf_fd.h
+ * @brief linux下环形缓冲区与文件描述符之间的分散/聚集IO，
+ *        直接在环形缓冲区的空闲/已用区域上进行readv/writev，省去中间缓冲区的拷贝
+ * @author simon.xiaoapeng (simon.xiaoapeng@gmail.com)
+ * @version 1.0
+ * @date 2024-08-03
+ * 
+ * @copyright Copyright (c) 2024  simon.xiaoapeng@gmail.com
+ * 
+ * @par 修改日志:
+ */
+
+#ifndef _EH_RINGBUF_FD_H_
+#define _EH_RINGBUF_FD_H_
+
+#include <sys/types.h>
+#include "eh_ringbuf.h"
+
+#ifdef __cplusplus
+#if __cplusplus
+extern "C"{
+#endif
+#endif /* __cplusplus */
+
+/**
+ * @brief                           从fd读取数据到环形缓冲区的空闲区域，一次readv系统调用
+ *                                  写者侧调用，与 eh_ringbuf_write 的线程约束一致
+ * @param  ringbuf                  环形缓冲区指针
+ * @param  fd                       文件描述符
+ * @return ssize_t                  成功返回读到的字节数(0代表对端关闭)，
+ *                                  失败返回-1并设置errno，缓冲区已满时errno为ENOBUFS
+ */
+extern ssize_t eh_ringbuf_readv_fd(eh_ringbuf_t *ringbuf, int fd);
+
+/**
+ * @brief                           将环形缓冲区中已有数据写入fd，一次writev系统调用
+ *                                  读者侧调用，与 eh_ringbuf_read 的线程约束一致
+ * @param  ringbuf                  环形缓冲区指针
+ * @param  fd                       文件描述符
+ * @return ssize_t                  成功返回写出的字节数，缓冲区为空时返回0，
+ *                                  失败返回-1并设置errno
+ */
+extern ssize_t eh_ringbuf_writev_fd(eh_ringbuf_t *ringbuf, int fd);
+
+#ifdef __cplusplus
+#if __cplusplus
+}
+#endif
+#endif /* __cplusplus */
+
+
+#endif // _EH_RINGBUF_FD_H_
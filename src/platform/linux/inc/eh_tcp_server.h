@@ -0,0 +1,102 @@
+/**
+ * @file eh_tcp_server.h
+ * @brief linux下基于eh_fd的TCP服务端框架，
+ *    每个监听socket由一个接收任务循环accept，新连接交给工作任务中的handler处理，
+ *    工作任务在handler返回后回到空闲池等待下一个连接，栈和任务结构被重复使用，
+ *    同时存在的工作任务数不超过max_conn，达到上限时接收任务暂停accept，连接留在内核的backlog中。
+ *    listener_cnt大于1或设置reuseport时所有监听socket使用SO_REUSEPORT绑定到同一个地址，
+ *    由内核在这些socket之间分配连接，多个进程各自运行一个服务端也可以用这种方式共享端口。
+ *      使用限制: 此模块所有的函数都只能在协程上下文中使用
+ * @author simon.xiaoapeng (simon.xiaoapeng@gmail.com)
+ * @version 1.0
+ * @date 2024-08-28
+ *
+ * @copyright Copyright (c) 2024  simon.xiaoapeng@gmail.com
+ *
+ * @par 修改日志:
+ */
+
+#ifndef _EH_TCP_SERVER_H_
+#define _EH_TCP_SERVER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include "eh_types.h"
+
+#ifdef __cplusplus
+#if __cplusplus
+extern "C"{
+#endif
+#endif /* __cplusplus */
+
+typedef struct eh_tcp_server eh_tcp_server_t;
+
+struct eh_tcp_server_config{
+    const struct sockaddr           *addr;              /* 监听地址，端口为0时由系统分配，所有监听socket共用同一个端口 */
+    socklen_t                       addrlen;
+    int                             backlog;            /* listen的backlog，默认128 */
+    int                             listener_cnt;       /* 监听socket个数，每个对应一个接收任务，默认1 */
+    bool                            reuseport;          /* listener_cnt为1时也设置SO_REUSEPORT，用于多进程共享端口 */
+    int                             accept_batch;       /* 接收任务每次被唤醒后最多连续accept的个数，之后让出CPU，默认16 */
+    int                             max_conn;           /* 工作任务数上限，即同时处理的连接数上限，默认256 */
+    unsigned long                   stack_size;         /* 工作任务的栈大小，默认16KB */
+    /**
+     * 连接处理函数，在工作任务中运行，返回后连接被关闭，
+     * fd已设置为非阻塞并注册，可直接使用eh_recv/eh_send等函数
+     */
+    int                             (*handler)(int fd, void *arg);
+    void                            *arg;
+};
+
+struct eh_tcp_server_stat{
+    uint64_t                        accepted;           /* 累计接收的连接数 */
+    int                             active;             /* 正在处理的连接数 */
+    int                             workers;            /* 已创建的工作任务数(含空闲) */
+};
+
+/**
+ * @brief                           使用默认值初始化配置，之后再设置地址和handler
+ */
+extern void eh_tcp_server_config_init(struct eh_tcp_server_config *config);
+
+/**
+ * @brief                           创建监听socket并启动接收任务
+ * @param  config                   配置，只在调用期间使用
+ * @return eh_tcp_server_t*         返回值请使用eh_ptr_to_error来判断是否创建成功
+ */
+extern eh_tcp_server_t* eh_tcp_server_create(const struct eh_tcp_server_config *config);
+
+/**
+ * @brief                           获取实际监听的地址，用于取得系统分配的端口
+ * @return int                      见eh_error.h
+ */
+extern int eh_tcp_server_local_addr(eh_tcp_server_t *server, struct sockaddr *addr, socklen_t *addrlen);
+
+/**
+ * @brief                           获取服务端统计信息
+ */
+extern void eh_tcp_server_stat(eh_tcp_server_t *server, struct eh_tcp_server_stat *stat);
+
+/**
+ * @brief                           停止并销毁服务端，关闭监听socket，
+ *                                  对正在处理的连接执行shutdown使handler中的读写结束，
+ *                                  等待所有任务退出后释放服务端。
+ *                                  shutdown只能唤醒等待该连接读写的handler，挂起在其他事件(睡眠、锁、eh_offload等)上的
+ *                                  handler要自己在有限时间内返回，超时后服务端保持停止状态但不会被释放
+ * @param  server                   服务端
+ * @param  timeout                  等待工作任务退出的超时时间，EH_TIME_FOREVER为永久等待
+ * @return int                      成功返回EH_RET_OK，服务端已释放，
+ *                                  超时返回EH_RET_TIMEOUT，之后必须再次调用此函数直到返回EH_RET_OK
+ */
+extern int __async__ eh_tcp_server_destroy(eh_tcp_server_t *server, eh_sclock_t timeout);
+
+#ifdef __cplusplus
+#if __cplusplus
+}
+#endif
+#endif /* __cplusplus */
+
+
+#endif // _EH_TCP_SERVER_H_
@@ -0,0 +1,117 @@
+/**
+ * @file eh_udp.h
+ * @brief linux下批量收发UDP报文，基于eh_fd的fd注册，
+ *    接收时一次recvmmsg取回多个报文，发送时先将报文放入批次，再一次sendmmsg发出，
+ *    报文数据存放在批次创建时分配的连续内存中，收发过程不再申请内存。
+ *    可选使用UDP GSO/GRO(linux 4.18/5.0及以上): 发送时一个报文按segment_size切分为多个数据报，
+ *    接收端开启GRO后多个数据报可能合并为一个报文，segment_size为合并前每个数据报的长度。
+ *      使用限制: 收发函数只能在协程上下文中使用
+ * @author simon.xiaoapeng (simon.xiaoapeng@gmail.com)
+ * @version 1.0
+ * @date 2024-08-26
+ *
+ * @copyright Copyright (c) 2024  simon.xiaoapeng@gmail.com
+ *
+ * @par 修改日志:
+ */
+
+#ifndef _EH_UDP_H_
+#define _EH_UDP_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include "eh_types.h"
+
+#ifdef __cplusplus
+#if __cplusplus
+extern "C"{
+#endif
+#endif /* __cplusplus */
+
+typedef struct eh_udp_batch eh_udp_batch_t;
+
+struct eh_udp_msg{
+    void                            *data;
+    size_t                          len;
+    struct sockaddr_storage         addr;
+    socklen_t                       addrlen;
+    uint16_t                        segment_size;       /* 0为普通报文，否则为GSO/GRO的分段长度 */
+};
+
+/**
+ * @brief                           创建批次
+ * @param  max_cnt                  一次最多收发的报文数
+ * @param  msg_size                 单个报文的最大长度，接收端开启GRO时需要能容纳合并后的报文(最大64KB)
+ * @return eh_udp_batch_t*          返回值请使用eh_ptr_to_error来判断是否创建成功
+ */
+extern eh_udp_batch_t* eh_udp_batch_create(int max_cnt, size_t msg_size);
+
+/**
+ * @brief                           销毁批次
+ */
+extern void eh_udp_batch_destroy(eh_udp_batch_t *batch);
+
+/**
+ * @brief                           清空批次中的报文
+ */
+extern void eh_udp_batch_clear(eh_udp_batch_t *batch);
+
+/**
+ * @brief                           获取批次中的报文数
+ */
+extern int eh_udp_batch_count(eh_udp_batch_t *batch);
+
+/**
+ * @brief                           获取批次中的第idx个报文，数据在下一次收发或清空前有效
+ */
+extern struct eh_udp_msg* eh_udp_batch_msg(eh_udp_batch_t *batch, int idx);
+
+/**
+ * @brief                           复制一个待发送的报文到批次中
+ * @param  batch                    批次
+ * @param  data                     报文数据
+ * @param  len                      报文长度，不能超过msg_size
+ * @param  addr                     目的地址，已connect的socket可为NULL
+ * @param  addrlen                  目的地址长度
+ * @param  segment_size             不为0时使用GSO，内核按此长度将报文切分为多个数据报
+ * @return int                      见eh_error.h，批次已满返回EH_RET_BUSY
+ */
+extern int eh_udp_batch_add(eh_udp_batch_t *batch, const void *data, size_t len,
+    const struct sockaddr *addr, socklen_t addrlen, uint16_t segment_size);
+
+/**
+ * @brief                           接收报文，至少收到一个报文后返回，之前批次中的报文被清空
+ * @param  fd                       UDP socket
+ * @param  batch                    批次
+ * @param  timeout                  超时时间，0为不等待，EH_TIME_FOREVER为永久等待
+ * @return int                      成功返回收到的报文数，失败返回-1并设置errno，超时errno为ETIMEDOUT
+ */
+extern int __async__ eh_udp_recv_batch(int fd, eh_udp_batch_t *batch, eh_sclock_t timeout);
+
+/**
+ * @brief                           发送批次中的全部报文，已发出的报文从批次中移除
+ * @param  fd                       UDP socket
+ * @param  batch                    批次
+ * @param  timeout                  超时时间，0为不等待，EH_TIME_FOREVER为永久等待
+ * @return int                      返回已发送的报文数，一个都没有发出时返回-1并设置errno，
+ *                                  中途失败或超时时未发出的报文按原顺序留在批次头部，
+ *                                  此时eh_udp_batch_count不为0，errno为失败原因，可以修正后再次发送或清空
+ */
+extern int __async__ eh_udp_send_batch(int fd, eh_udp_batch_t *batch, eh_sclock_t timeout);
+
+/**
+ * @brief                           开启或关闭socket的UDP GRO
+ * @return int                      见eh_error.h，内核不支持时返回EH_RET_INVALID_STATE
+ */
+extern int eh_udp_set_gro(int fd, bool enable);
+
+#ifdef __cplusplus
+#if __cplusplus
+}
+#endif
+#endif /* __cplusplus */
+
+
+#endif // _EH_UDP_H_
@@ -0,0 +1,60 @@
+/**
+ * @file eh_uring.h
+ * @brief linux io_uring后端的异步IO接口，仅在CMake配置EH_CONFIG_LINUX_IO_URING=ON时可用，
+ *    请求只写入提交队列，在调度器每一轮循环(eh_poll)中统一提交并收割完成事件，
+ *    一次io_uring_enter可以提交多个任务的请求，
+ *    超时通过IORING_OP_LINK_TIMEOUT链接在请求之后，由内核负责取消。
+ *      使用限制: 此模块所有的函数都只能在协程上下文中使用，需要linux 5.11及以上内核
+ * @author simon.xiaoapeng (simon.xiaoapeng@gmail.com)
+ * @version 1.0
+ * @date 2024-08-22
+ *
+ * @copyright Copyright (c) 2024  simon.xiaoapeng@gmail.com
+ *
+ * @par 修改日志:
+ */
+
+#ifndef _EH_URING_H_
+#define _EH_URING_H_
+
+#include <stdint.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include "eh_types.h"
+
+#ifdef __cplusplus
+#if __cplusplus
+extern "C"{
+#endif
+#endif /* __cplusplus */
+
+/**
+ * 以下函数与同名的系统调用语义一致，在请求完成前挂起当前任务，
+ * offset为-1时使用文件当前位置(管道、socket等只能为-1或0)，
+ * 失败返回-1并设置errno，超时errno为ETIMEDOUT，提交队列已满时errno为EBUSY
+ */
+extern ssize_t __async__ eh_uring_read(int fd, void *buf, size_t len, int64_t offset, eh_sclock_t timeout);
+extern ssize_t __async__ eh_uring_write(int fd, const void *buf, size_t len, int64_t offset, eh_sclock_t timeout);
+extern ssize_t __async__ eh_uring_recv(int fd, void *buf, size_t len, int flags, eh_sclock_t timeout);
+extern ssize_t __async__ eh_uring_send(int fd, const void *buf, size_t len, int flags, eh_sclock_t timeout);
+extern int __async__ eh_uring_accept(int fd, struct sockaddr *addr, socklen_t *addrlen, eh_sclock_t timeout);
+extern int __async__ eh_uring_openat(int dirfd, const char *path, int flags, mode_t mode, eh_sclock_t timeout);
+
+/**
+ * @brief                           等同于fsync，flags为IORING_FSYNC_DATASYNC时等同于fdatasync
+ */
+extern int __async__ eh_uring_fsync(int fd, unsigned int flags, eh_sclock_t timeout);
+
+/**
+ * @brief                           获取调用io_uring_enter的次数和提交的请求数，用于观察批量提交的效果
+ */
+extern void eh_uring_stat(uint64_t *enter_cnt, uint64_t *submit_cnt);
+
+#ifdef __cplusplus
+#if __cplusplus
+}
+#endif
+#endif /* __cplusplus */
+
+
+#endif // _EH_URING_H_
@@ -1,6 +1,11 @@
 /**
  * @file epoll_hub.h
- * @brief linux epoll处理中心
+ * @brief linux epoll处理中心，
+ *    空闲等待默认使用绝对时间的timerfd提供us级别的超时，截止时间变化不超过20us时不重新设置定时器，
+ *    超时为0时不接触定时器。
+ *    定义EH_CONFIG_LINUX_EPOLL_HUB_PWAIT2时改用epoll_pwait2直接传入超时(内核>=5.11，不支持时自动回退到timerfd)，
+ *    省去timerfd_settime，但超时受调度器线程timer slack(默认50us)的影响，实测平均唤醒延迟从约9us增加到约130us，
+ *    需要同时保持精度时可定义EH_CONFIG_LINUX_EPOLL_HUB_TIMERSLACK_NSEC修改整个线程的timer slack
  * @author simon.xiaoapeng (simon.xiaoapeng@gmail.com)
  * @version 1.0
  * @date 2024-06-13
@@ -23,6 +28,7 @@ extern "C"{
 struct epoll_fd_action{
     void (*callback)(uint32_t events, void *arg);
     void *arg;
+    uint32_t revents;           /* 就绪状态缓存，epoll_hub在回调前将报告的事件合并进来，由使用者在遇到EAGAIN时清除 */
 };
 
 extern void epoll_hub_set_wait_break_event(void);
@@ -30,6 +36,10 @@ extern void epoll_hub_clean_wait_break_event(void);
 extern int  epoll_hub_add_fd(int fd, uint32_t events, struct epoll_fd_action *action);
 extern int  epoll_hub_del_fd(int fd);
 extern int  epoll_hub_poll(eh_usec_t timeout);
+/* 获取epoll_hub_poll的调用次数和设置超时定时器的次数，用于统计每轮循环的系统调用开销 */
+extern void epoll_hub_stat(uint64_t *wait_cnt, uint64_t *timer_set_cnt);
+/* 获取当前一次epoll_wait最多取回的事件数，会根据每轮就绪的数量自动扩大和缩小 */
+extern int  epoll_hub_batch_size(void);
 extern int  epoll_hub_init(void);
 extern void epoll_hub_exit(void);
 
@@ -0,0 +1,463 @@
+/**
+ * @file uring_hub.c
+ * @brief 基于io_uring的处理中心，对外提供与epoll_hub相同的接口，可通过EH_CONFIG_LINUX_IO_URING替换epoll_hub.c，
+ *    空闲等待使用io_uring_enter的EXT_ARG超时参数，不再需要timerfd，
+ *    唤醒用的eventfd和epoll_hub_add_fd所使用的epoll描述符都以multishot poll请求的形式挂在环上，
+ *    eh_uring_*请求在任务中只填写提交队列，每轮循环统一提交和收割。
+ *      不使用liburing，直接通过系统调用操作环，需要linux 5.11及以上内核
+ * @author simon.xiaoapeng (simon.xiaoapeng@gmail.com)
+ * @version 1.0
+ * @date 2024-08-22
+ *
+ * @copyright Copyright (c) 2024  simon.xiaoapeng@gmail.com
+ *
+ * @par 修改日志:
+ */
+
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <linux/io_uring.h>
+#include "eh.h"
+#include "eh_event.h"
+#include "eh_platform.h"
+#include "eh_timer.h"
+#include "eh_interior.h"
+#include "eh_module.h"
+#include "epoll_hub.h"
+#include "eh_uring.h"
+
+#define EPOLL_WAIT_MAX_EVENTS       1024
+#define URING_ENTRIES               256
+
+/* user_data的特殊值，其余为struct eh_uring_req的地址 */
+#define URING_UD_IGNORE             0ULL
+#define URING_UD_WAIT_BREAK         1ULL
+#define URING_UD_EPOLL              2ULL
+
+struct eh_uring_req {
+    eh_task_t                   *task;
+    struct __kernel_timespec    ts;                     /* 链接超时的时间，提交前必须有效 */
+    int32_t                     res;
+    bool                        done;
+};
+
+struct uring_hub{
+    int                         ring_fd;
+    int                         epoll_fd;
+    int                         wait_break_fd;
+    void                        *ring;
+    size_t                      ring_size;
+    struct io_uring_sqe         *sqes;
+    size_t                      sqes_size;
+    unsigned                    *sq_head;
+    unsigned                    *sq_tail;
+    unsigned                    *sq_array;
+    unsigned                    sq_mask;
+    unsigned                    sq_entries;
+    unsigned                    sq_local_tail;          /* 已填写但还未发布给内核的位置 */
+    unsigned                    to_submit;
+    unsigned                    *cq_head;
+    unsigned                    *cq_tail;
+    unsigned                    cq_mask;
+    struct io_uring_cqe         *cqes;
+    bool                        poll_multishot;
+    bool                        epoll_ready;
+    uint64_t                    wait_cnt;
+    uint64_t                    enter_cnt;
+    uint64_t                    submit_cnt;
+    struct epoll_event          wait_events[EPOLL_WAIT_MAX_EVENTS];
+}uring_hub;
+
+static int _uring_enter(unsigned to_submit, unsigned min_complete, unsigned flags, void *arg, size_t argsz){
+    uring_hub.enter_cnt++;
+    return (int)syscall(__NR_io_uring_enter, uring_hub.ring_fd, to_submit, min_complete, flags, arg, argsz);
+}
+
+/**
+ * @brief                           将已填写的请求发布给内核并提交，wait_usec不为0时等待至少一个完成事件
+ */
+static void _uring_submit(eh_usec_t wait_usec){
+    struct io_uring_getevents_arg arg = {0};
+    struct __kernel_timespec ts;
+    unsigned flags = 0;
+    int ret;
+
+    __atomic_store_n(uring_hub.sq_tail, uring_hub.sq_local_tail, __ATOMIC_RELEASE);
+    if(wait_usec){
+        ts.tv_sec = (long long)(wait_usec / 1000000);
+        ts.tv_nsec = (long long)((wait_usec % 1000000) * 1000);
+        arg.sigmask_sz = _NSIG / 8;
+        arg.ts = (uint64_t)(uintptr_t)&ts;
+        flags = IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG;
+    }else if(uring_hub.to_submit == 0){
+        return ;
+    }
+    ret = _uring_enter(uring_hub.to_submit, wait_usec ? 1 : 0, flags, wait_usec ? &arg : NULL, wait_usec ? sizeof(arg) : 0);
+    if(ret > 0){
+        uring_hub.submit_cnt += (unsigned)ret;
+        uring_hub.to_submit -= (unsigned)ret;
+    }
+}
+
+static unsigned _uring_sq_space(void){
+    return uring_hub.sq_entries - (uring_hub.sq_local_tail - __atomic_load_n(uring_hub.sq_head, __ATOMIC_ACQUIRE));
+}
+
+/**
+ * @brief                           获取cnt个连续的提交队列项，队列满时先提交一次
+ */
+static struct io_uring_sqe* _uring_get_sqe(unsigned cnt){
+    struct io_uring_sqe *sqe;
+    unsigned index, i;
+    if(_uring_sq_space() < cnt){
+        _uring_submit(0);
+        if(_uring_sq_space() < cnt)
+            return NULL;
+    }
+    index = uring_hub.sq_local_tail & uring_hub.sq_mask;
+    sqe = &uring_hub.sqes[index];
+    for(i = 0; i < cnt; i++){
+        index = (uring_hub.sq_local_tail + i) & uring_hub.sq_mask;
+        memset(&uring_hub.sqes[index], 0, sizeof(struct io_uring_sqe));
+        uring_hub.sq_array[index] = index;
+    }
+    /* 返回第一项，其余项在回绕处可能不相邻，需通过_uring_next_sqe访问 */
+    uring_hub.sq_local_tail += cnt;
+    uring_hub.to_submit += cnt;
+    return sqe;
+}
+
+static struct io_uring_sqe* _uring_next_sqe(struct io_uring_sqe *sqe){
+    unsigned index = (unsigned)(sqe - uring_hub.sqes);
+    return &uring_hub.sqes[(index + 1) & uring_hub.sq_mask];
+}
+
+static int _uring_arm_poll(int fd, uint64_t user_data){
+    struct io_uring_sqe *sqe = _uring_get_sqe(1);
+    if(sqe == NULL)
+        return -1;
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = fd;
+    sqe->poll32_events = POLLIN;
+    sqe->len = uring_hub.poll_multishot ? IORING_POLL_ADD_MULTI : 0;
+    sqe->user_data = user_data;
+    return 0;
+}
+
+static void _uring_poll_complete(struct io_uring_cqe *cqe, int fd){
+    if(cqe->res == -EINVAL && uring_hub.poll_multishot){
+        /* 内核不支持multishot poll，退化为每次重新提交 */
+        uring_hub.poll_multishot = false;
+    }
+    if(!(cqe->flags & IORING_CQE_F_MORE))
+        _uring_arm_poll(fd, cqe->user_data);
+}
+
+static void _uring_reap(void){
+    struct io_uring_cqe *cqe;
+    struct eh_uring_req *req;
+    unsigned head, tail;
+    head = *uring_hub.cq_head;
+    tail = __atomic_load_n(uring_hub.cq_tail, __ATOMIC_ACQUIRE);
+    for(; head != tail; head++){
+        cqe = &uring_hub.cqes[head & uring_hub.cq_mask];
+        switch(cqe->user_data){
+            case URING_UD_IGNORE:
+                break;
+            case URING_UD_WAIT_BREAK:
+                _uring_poll_complete(cqe, uring_hub.wait_break_fd);
+                break;
+            case URING_UD_EPOLL:
+                uring_hub.epoll_ready = true;
+                _uring_poll_complete(cqe, uring_hub.epoll_fd);
+                break;
+            default:
+                req = (struct eh_uring_req *)(uintptr_t)cqe->user_data;
+                req->res = cqe->res;
+                req->done = true;
+                eh_task_wake_up(req->task);
+                break;
+        }
+    }
+    __atomic_store_n(uring_hub.cq_head, head, __ATOMIC_RELEASE);
+}
+
+static void _uring_epoll_dispatch(void){
+    int ret;
+    uring_hub.epoll_ready = false;
+    ret = epoll_wait(uring_hub.epoll_fd, uring_hub.wait_events, EPOLL_WAIT_MAX_EVENTS, 0);
+    if(ret <= 0)
+        return ;
+    /* 水平触发的fd可能依然就绪，而epoll描述符上的poll不一定会再次触发，下一轮再检查一次 */
+    uring_hub.epoll_ready = true;
+    for(int i = 0; i < ret; i++){
+        struct epoll_event *event = &uring_hub.wait_events[i];
+        struct epoll_fd_action *action = event->data.ptr;
+        if(action == NULL)
+            continue;
+        action->revents |= event->events;
+        if(action->callback)
+            action->callback(event->events, action->arg);
+    }
+}
+
+void epoll_hub_clean_wait_break_event(void){
+    eventfd_t value;
+    eventfd_read(uring_hub.wait_break_fd, &value);
+}
+
+void epoll_hub_set_wait_break_event(void){
+    eventfd_write(uring_hub.wait_break_fd, 1);
+}
+
+int epoll_hub_add_fd(int fd, uint32_t events, struct epoll_fd_action *action){
+    struct epoll_event event = {0};
+
+    event.events = events;
+    event.data.ptr = action;
+    return epoll_ctl(uring_hub.epoll_fd, EPOLL_CTL_ADD, fd, &event);
+}
+
+int epoll_hub_del_fd(int fd){
+    return epoll_ctl(uring_hub.epoll_fd, EPOLL_CTL_DEL, fd, NULL);
+}
+
+int epoll_hub_poll(eh_usec_t usec_timeout){
+    uring_hub.wait_cnt++;
+    _uring_submit(uring_hub.epoll_ready ? 0 : usec_timeout);
+    _uring_reap();
+    if(uring_hub.epoll_ready)
+        _uring_epoll_dispatch();
+    return 0;
+}
+
+void epoll_hub_stat(uint64_t *wait_cnt, uint64_t *timer_set_cnt){
+    if(wait_cnt)
+        *wait_cnt = uring_hub.wait_cnt;
+    /* 超时由io_uring_enter的参数提供，没有定时器 */
+    if(timer_set_cnt)
+        *timer_set_cnt = 0;
+}
+
+int epoll_hub_batch_size(void){
+    /* epoll描述符在环上有就绪通知，取不完的事件在下一轮继续取，使用固定大小 */
+    return EPOLL_WAIT_MAX_EVENTS;
+}
+
+static ssize_t __async__ _eh_uring_wait(struct io_uring_sqe *sqe, struct eh_uring_req *req, eh_sclock_t timeout){
+    struct io_uring_sqe *timeout_sqe;
+    eh_save_state_t state;
+    eh_usec_t usec;
+
+    req->task = eh_task_get_current();
+    req->res = 0;
+    req->done = false;
+    sqe->user_data = (uint64_t)(uintptr_t)req;
+    if(!eh_time_is_forever(timeout)){
+        usec = timeout > 0 ? eh_clock_to_usec(timeout) : 0;
+        req->ts.tv_sec = (long long)(usec / 1000000);
+        req->ts.tv_nsec = (long long)((usec % 1000000) * 1000);
+        sqe->flags |= IOSQE_IO_LINK;
+        timeout_sqe = _uring_next_sqe(sqe);
+        timeout_sqe->opcode = IORING_OP_LINK_TIMEOUT;
+        timeout_sqe->fd = -1;
+        timeout_sqe->addr = (uint64_t)(uintptr_t)&req->ts;
+        timeout_sqe->len = 1;
+        timeout_sqe->user_data = URING_UD_IGNORE;
+    }
+
+    /* 请求在本轮循环的epoll_hub_poll中提交，完成后由_uring_reap唤醒 */
+    for(;;){
+        state = eh_enter_critical();
+        if(req->done)
+            break;
+        eh_task_set_current_state(EH_TASK_STATE_WAIT);
+        eh_exit_critical(state);
+        __await__ eh_task_next();
+    }
+    eh_exit_critical(state);
+
+    if(req->res >= 0)
+        return req->res;
+    errno = req->res == -ECANCELED ? ETIMEDOUT : -req->res;
+    return -1;
+}
+
+static struct io_uring_sqe* _eh_uring_prep(uint8_t opcode, int fd, uint64_t addr, uint32_t len, uint64_t off, eh_sclock_t timeout){
+    struct io_uring_sqe *sqe = _uring_get_sqe(eh_time_is_forever(timeout) ? 1 : 2);
+    if(sqe == NULL){
+        errno = EBUSY;
+        return NULL;
+    }
+    sqe->opcode = opcode;
+    sqe->fd = fd;
+    sqe->addr = addr;
+    sqe->len = len;
+    sqe->off = off;
+    return sqe;
+}
+
+ssize_t __async__ eh_uring_read(int fd, void *buf, size_t len, int64_t offset, eh_sclock_t timeout){
+    struct eh_uring_req req;
+    struct io_uring_sqe *sqe = _eh_uring_prep(IORING_OP_READ, fd, (uint64_t)(uintptr_t)buf, (uint32_t)len, (uint64_t)offset, timeout);
+    if(sqe == NULL)
+        return -1;
+    return __await__ _eh_uring_wait(sqe, &req, timeout);
+}
+
+ssize_t __async__ eh_uring_write(int fd, const void *buf, size_t len, int64_t offset, eh_sclock_t timeout){
+    struct eh_uring_req req;
+    struct io_uring_sqe *sqe = _eh_uring_prep(IORING_OP_WRITE, fd, (uint64_t)(uintptr_t)buf, (uint32_t)len, (uint64_t)offset, timeout);
+    if(sqe == NULL)
+        return -1;
+    return __await__ _eh_uring_wait(sqe, &req, timeout);
+}
+
+ssize_t __async__ eh_uring_recv(int fd, void *buf, size_t len, int flags, eh_sclock_t timeout){
+    struct eh_uring_req req;
+    struct io_uring_sqe *sqe = _eh_uring_prep(IORING_OP_RECV, fd, (uint64_t)(uintptr_t)buf, (uint32_t)len, 0, timeout);
+    if(sqe == NULL)
+        return -1;
+    sqe->msg_flags = (uint32_t)flags;
+    return __await__ _eh_uring_wait(sqe, &req, timeout);
+}
+
+ssize_t __async__ eh_uring_send(int fd, const void *buf, size_t len, int flags, eh_sclock_t timeout){
+    struct eh_uring_req req;
+    struct io_uring_sqe *sqe = _eh_uring_prep(IORING_OP_SEND, fd, (uint64_t)(uintptr_t)buf, (uint32_t)len, 0, timeout);
+    if(sqe == NULL)
+        return -1;
+    sqe->msg_flags = (uint32_t)(flags | MSG_NOSIGNAL);
+    return __await__ _eh_uring_wait(sqe, &req, timeout);
+}
+
+int __async__ eh_uring_accept(int fd, struct sockaddr *addr, socklen_t *addrlen, eh_sclock_t timeout){
+    struct eh_uring_req req;
+    struct io_uring_sqe *sqe = _eh_uring_prep(IORING_OP_ACCEPT, fd, (uint64_t)(uintptr_t)addr, 0, (uint64_t)(uintptr_t)addrlen, timeout);
+    if(sqe == NULL)
+        return -1;
+    sqe->accept_flags = SOCK_NONBLOCK | SOCK_CLOEXEC;
+    return (int)__await__ _eh_uring_wait(sqe, &req, timeout);
+}
+
+int __async__ eh_uring_fsync(int fd, unsigned int flags, eh_sclock_t timeout){
+    struct eh_uring_req req;
+    struct io_uring_sqe *sqe = _eh_uring_prep(IORING_OP_FSYNC, fd, 0, 0, 0, timeout);
+    if(sqe == NULL)
+        return -1;
+    sqe->fsync_flags = flags;
+    return (int)__await__ _eh_uring_wait(sqe, &req, timeout);
+}
+
+int __async__ eh_uring_openat(int dirfd, const char *path, int flags, mode_t mode, eh_sclock_t timeout){
+    struct eh_uring_req req;
+    struct io_uring_sqe *sqe = _eh_uring_prep(IORING_OP_OPENAT, dirfd, (uint64_t)(uintptr_t)path, (uint32_t)mode, 0, timeout);
+    if(sqe == NULL)
+        return -1;
+    sqe->open_flags = (uint32_t)flags;
+    return (int)__await__ _eh_uring_wait(sqe, &req, timeout);
+}
+
+void eh_uring_stat(uint64_t *enter_cnt, uint64_t *submit_cnt){
+    if(enter_cnt)
+        *enter_cnt = uring_hub.enter_cnt;
+    if(submit_cnt)
+        *submit_cnt = uring_hub.submit_cnt;
+}
+
+static int _uring_setup(void){
+    struct io_uring_params params;
+    uint8_t *ring;
+    int ret;
+
+    memset(&params, 0, sizeof(params));
+    ret = (int)syscall(__NR_io_uring_setup, URING_ENTRIES, &params);
+    if(ret < 0)
+        return -1;
+    uring_hub.ring_fd = ret;
+    if(!(params.features & IORING_FEAT_SINGLE_MMAP) || !(params.features & IORING_FEAT_EXT_ARG))
+        goto feature_error;
+
+    uring_hub.ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    if(params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe) > uring_hub.ring_size)
+        uring_hub.ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    uring_hub.ring = mmap(NULL, uring_hub.ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+        uring_hub.ring_fd, IORING_OFF_SQ_RING);
+    if(uring_hub.ring == MAP_FAILED)
+        goto feature_error;
+    uring_hub.sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    uring_hub.sqes = mmap(NULL, uring_hub.sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+        uring_hub.ring_fd, IORING_OFF_SQES);
+    if(uring_hub.sqes == MAP_FAILED)
+        goto sqes_mmap_error;
+
+    ring = uring_hub.ring;
+    uring_hub.sq_head = (unsigned *)(ring + params.sq_off.head);
+    uring_hub.sq_tail = (unsigned *)(ring + params.sq_off.tail);
+    uring_hub.sq_array = (unsigned *)(ring + params.sq_off.array);
+    uring_hub.sq_mask = *(unsigned *)(ring + params.sq_off.ring_mask);
+    uring_hub.sq_entries = *(unsigned *)(ring + params.sq_off.ring_entries);
+    uring_hub.sq_local_tail = *uring_hub.sq_tail;
+    uring_hub.to_submit = 0;
+    uring_hub.cq_head = (unsigned *)(ring + params.cq_off.head);
+    uring_hub.cq_tail = (unsigned *)(ring + params.cq_off.tail);
+    uring_hub.cq_mask = *(unsigned *)(ring + params.cq_off.ring_mask);
+    uring_hub.cqes = (struct io_uring_cqe *)(ring + params.cq_off.cqes);
+    return 0;
+sqes_mmap_error:
+    munmap(uring_hub.ring, uring_hub.ring_size);
+feature_error:
+    close(uring_hub.ring_fd);
+    return -1;
+}
+
+static void _uring_teardown(void){
+    munmap(uring_hub.sqes, uring_hub.sqes_size);
+    munmap(uring_hub.ring, uring_hub.ring_size);
+    close(uring_hub.ring_fd);
+}
+
+int __init epoll_hub_init(void){
+    int ret;
+    ret = _uring_setup();
+    if(ret < 0)
+        return -1;
+    uring_hub.poll_multishot = true;
+    uring_hub.epoll_ready = false;
+    uring_hub.wait_cnt = 0;
+    uring_hub.enter_cnt = 0;
+    uring_hub.submit_cnt = 0;
+
+    ret = epoll_create1(EPOLL_CLOEXEC);
+    if(ret < 0)
+        goto epoll_create_error;
+    uring_hub.epoll_fd = ret;
+
+    ret = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if(ret < 0)
+        goto eventfd_error;
+    uring_hub.wait_break_fd = ret;
+
+    _uring_arm_poll(uring_hub.wait_break_fd, URING_UD_WAIT_BREAK);
+    _uring_arm_poll(uring_hub.epoll_fd, URING_UD_EPOLL);
+    _uring_submit(0);
+    return 0;
+eventfd_error:
+    close(uring_hub.epoll_fd);
+epoll_create_error:
+    _uring_teardown();
+    return -1;
+}
+
+void __exit epoll_hub_exit(void){
+    _uring_teardown();
+    close(uring_hub.wait_break_fd);
+    close(uring_hub.epoll_fd);
+}
@@ -11,6 +11,15 @@
  */
 #define EH_CONFIG_EVENT_CALLBACK_FUNCTION_STACK_SIZE            (8*1024U)
 
+/**
+ *  配置事件回调的调度通道数，每个通道一个任务，使用上面的栈大小，未定义时为1
+ *  配置每个通道每批最多处理的事件个数，决定每个通道槽位数组的大小，未定义时为32
+ *  配置每个通道默认每批处理的事件个数(1~EH_CONFIG_EVENT_CALLBACK_LANE_BATCH_SIZE_MAX)，未定义时为8
+ */
+#define EH_CONFIG_EVENT_CALLBACK_LANE_CNT                       3
+#define EH_CONFIG_EVENT_CALLBACK_LANE_BATCH_SIZE_MAX            32
+#define EH_CONFIG_EVENT_CALLBACK_LANE_BATCH_SIZE                8
+
 
 /**
  *  platform_get_clock_monotonic_time 函数获取到的时钟使用的时钟频率
@@ -0,0 +1,134 @@
+/**
+ * @file test_chan.c
+ * @brief 通道测试
+ * @author simon.xiaoapeng (simon.xiaoapeng@gmail.com)
+ * @version 1.0
+ * @date 2024-08-08
+ * 
+ * @copyright Copyright (c) 2024  simon.xiaoapeng@gmail.com
+ * 
+ * @par 修改日志:
+ */
+
+#include <stdio.h>
+#include "eh.h"
+#include "eh_debug.h"
+#include "eh_event.h"
+#include "eh_platform.h"
+#include "eh_timer.h"
+#include "eh_sleep.h"
+#include "eh_chan.h"
+
+#define TEST_MSG_CNT    1000
+
+static eh_chan_t chan_a;
+static eh_chan_t chan_b;
+
+void stdout_write(void *stream, const uint8_t *buf, size_t size){
+    (void)stream;
+    printf("%.*s", (int)size, (const char*)buf);
+}
+
+int task_sender(void *arg){
+    eh_chan_t chan = (eh_chan_t)arg;
+    int ret;
+    for(int i = 0; i < TEST_MSG_CNT; i++){
+        ret = __await__ eh_chan_send(chan, &i, EH_TIME_FOREVER);
+        if(ret < 0)
+            return ret;
+    }
+    eh_chan_close(chan);
+    return 0;
+}
+
+static int test_chan_pingpong(uint32_t capacity){
+    eh_task_t *sender;
+    int val, expect = 0, ret, app_ret;
+    eh_chan_t chan = eh_chan_create_type(int, capacity);
+    EH_DBG_ERROR_EXEC(eh_ptr_to_error(chan) < 0, return -1);
+    sender = eh_task_create("sender", 0, 12*1024, chan, task_sender);
+    for(;;){
+        ret = __await__ eh_chan_recv(chan, &val, EH_TIME_FOREVER);
+        if(ret == EH_RET_INVALID_STATE)
+            break;
+        EH_DBG_ERROR_EXEC(ret < 0 || val != expect, return -1);
+        expect++;
+    }
+    EH_DBG_ERROR_EXEC(expect != TEST_MSG_CNT, return -1);
+    EH_DBG_ERROR_EXEC(eh_chan_send(chan, &val, 0) != EH_RET_INVALID_STATE, return -1);
+    ret = __await__ eh_task_join(sender, &app_ret, EH_TIME_FOREVER);
+    EH_DBG_ERROR_EXEC(ret < 0 || app_ret < 0, return -1);
+    eh_chan_destroy(chan);
+    return 0;
+}
+
+int task_delay_sender(void *arg){
+    int val = 100;
+    (void) arg;
+    __await__ eh_usleep(100*1000);
+    return __await__ eh_chan_send(chan_b, &val, EH_TIME_FOREVER);
+}
+
+static int test_chan_select(void){
+    struct eh_chan_case cases[2];
+    eh_task_t *sender;
+    int val_a = 0, val_b = 0, ret, app_ret;
+
+    chan_a = eh_chan_create_type(int, 1);
+    chan_b = eh_chan_create_type(int, 0);
+
+    /* 用例1 无缓冲通道无人接收时发送超时 */
+    val_a = 1;
+    EH_DBG_ERROR_EXEC(eh_chan_send(chan_b, &val_a, 0) != EH_RET_TIMEOUT, return -1);
+    EH_DBG_ERROR_EXEC(eh_chan_send(chan_b, &val_a, (eh_sclock_t)eh_msec_to_clock(50)) != EH_RET_TIMEOUT, return -1);
+
+    /* 用例2 缓冲区已满时select选择接收 */
+    EH_DBG_ERROR_EXEC(eh_chan_send(chan_a, &val_a, 0) != EH_RET_OK, return -1);
+    cases[0].chan = chan_a;
+    cases[0].dir = EH_CHAN_DIR_SEND;
+    cases[0].elem = &val_a;
+    cases[1].chan = chan_a;
+    cases[1].dir = EH_CHAN_DIR_RECV;
+    cases[1].elem = &val_b;
+    EH_DBG_ERROR_EXEC(eh_chan_select(cases, 2, 0) != 1 || val_b != 1, return -1);
+
+    /* 用例3 在两个通道上等待，由另一个任务在无缓冲通道上交接 */
+    cases[0].chan = chan_a;
+    cases[0].dir = EH_CHAN_DIR_RECV;
+    cases[0].elem = &val_a;
+    cases[1].chan = chan_b;
+    cases[1].dir = EH_CHAN_DIR_RECV;
+    cases[1].elem = &val_b;
+    sender = eh_task_create("delay_sender", 0, 12*1024, NULL, task_delay_sender);
+    ret = __await__ eh_chan_select(cases, 2, (eh_sclock_t)eh_msec_to_clock(1000));
+    EH_DBG_ERROR_EXEC(ret != 1 || val_b != 100, return -1);
+    ret = __await__ eh_task_join(sender, &app_ret, EH_TIME_FOREVER);
+    EH_DBG_ERROR_EXEC(ret < 0 || app_ret < 0, return -1);
+
+    /* 用例4 select超时 */
+    EH_DBG_ERROR_EXEC(eh_chan_select(cases, 2, (eh_sclock_t)eh_msec_to_clock(50)) != EH_RET_TIMEOUT, return -1);
+
+    eh_chan_destroy(chan_a);
+    eh_chan_destroy(chan_b);
+    return 0;
+}
+
+int task_app(void *arg){
+    (void) arg;
+    EH_DBG_ERROR_EXEC(test_chan_pingpong(0) < 0, return -1);
+    eh_debugfl("test unbuffered chan Pass");
+    EH_DBG_ERROR_EXEC(test_chan_pingpong(16) < 0, return -1);
+    eh_debugfl("test buffered chan Pass");
+    EH_DBG_ERROR_EXEC(test_chan_select() < 0, return -1);
+    eh_debugfl("test chan select Pass");
+    return 0;
+}
+
+int main(void){
+    int ret;
+    eh_debugfl("test_chan start!!");
+    eh_global_init();
+    ret = task_app("task_app");
+    eh_global_exit();
+    return ret;
+}
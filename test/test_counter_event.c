@@ -0,0 +1,129 @@
+/**
+ * @file test_counter_event.c
+ * @brief 计数事件测试
+ * @author simon.xiaoapeng (simon.xiaoapeng@gmail.com)
+ * @version 1.0
+ * @date 2024-08-15
+ *
+ * @copyright Copyright (c) 2024  simon.xiaoapeng@gmail.com
+ *
+ * @par 修改日志:
+ */
+
+#include <stdio.h>
+#include <pthread.h>
+#include "eh.h"
+#include "eh_debug.h"
+#include "eh_event.h"
+#include "eh_platform.h"
+#include "eh_timer.h"
+#include "eh_sleep.h"
+#include "eh_counter_event.h"
+
+#define TEST_THREAD_CNT         4
+#define TEST_THREAD_ADD_CNT     100000
+
+static EH_DEFINE_COUNTER_EVENT(test_ce);
+
+void stdout_write(void *stream, const uint8_t *buf, size_t size){
+    (void)stream;
+    printf("%.*s", (int)size, (const char*)buf);
+}
+
+static void* thread_producer(void* arg){
+    (void) arg;
+    for(int i = 0; i < TEST_THREAD_ADD_CNT; i++){
+        while(eh_counter_event_add(&test_ce, 1) == EH_RET_BUSY);
+    }
+    return NULL;
+}
+
+static int test_basic(void){
+    uint32_t count;
+    int ret;
+
+    /* 等待前的通知不会丢失 */
+    eh_counter_event_add(&test_ce, 3);
+    eh_counter_event_add(&test_ce, 2);
+    ret = __await__ eh_counter_event_take(&test_ce, 1, &count, 0);
+    EH_DBG_ERROR_EXEC(ret != EH_RET_OK || count != 1, return -1);
+    ret = __await__ eh_counter_event_take(&test_ce, EH_COUNTER_EVENT_TAKE_ALL, &count, EH_TIME_FOREVER);
+    EH_DBG_ERROR_EXEC(ret != EH_RET_OK || count != 4, return -1);
+    ret = __await__ eh_counter_event_take(&test_ce, EH_COUNTER_EVENT_TAKE_ALL, &count, 0);
+    EH_DBG_ERROR_EXEC(ret != EH_RET_TIMEOUT || count != 0, return -1);
+    ret = __await__ eh_counter_event_take(&test_ce, EH_COUNTER_EVENT_TAKE_ALL, &count, (eh_sclock_t)eh_msec_to_clock(10));
+    EH_DBG_ERROR_EXEC(ret != EH_RET_TIMEOUT, return -1);
+
+    /* 溢出时计数保持不变 */
+    eh_counter_event_add(&test_ce, UINT32_MAX);
+    EH_DBG_ERROR_EXEC(eh_counter_event_add(&test_ce, 1) != EH_RET_BUSY, return -1);
+    EH_DBG_ERROR_EXEC(eh_counter_event_try_take(&test_ce, EH_COUNTER_EVENT_TAKE_ALL) != UINT32_MAX, return -1);
+    return 0;
+}
+
+static int test_epoll(void){
+    eh_epoll_slot_t slot;
+    eh_epoll_t epoll;
+    int ret;
+
+    epoll = eh_epoll_new();
+    EH_DBG_ERROR_EXEC(eh_ptr_to_error(epoll) < 0, return -1);
+    eh_epoll_add_event(epoll, eh_counter_event_to_event(&test_ce), &test_ce);
+    eh_counter_event_add(&test_ce, 7);
+    ret = __await__ eh_epoll_wait(epoll, &slot, 1, 0);
+    EH_DBG_ERROR_EXEC(ret != 1 || slot.userdata != &test_ce, goto error);
+    EH_DBG_ERROR_EXEC(eh_counter_event_try_take(&test_ce, EH_COUNTER_EVENT_TAKE_ALL) != 7, goto error);
+    ret = __await__ eh_epoll_wait(epoll, &slot, 1, 0);
+    EH_DBG_ERROR_EXEC(ret != EH_RET_TIMEOUT, goto error);
+    eh_epoll_del(epoll);
+    return 0;
+error:
+    eh_epoll_del(epoll);
+    return -1;
+}
+
+static int test_burst(void){
+    pthread_t threads[TEST_THREAD_CNT];
+    uint64_t total = 0;
+    uint32_t count, wakeup_cnt = 0;
+    int ret;
+
+    for(int i = 0; i < TEST_THREAD_CNT; i++){
+        if(pthread_create(&threads[i], NULL, thread_producer, NULL) != 0){
+            eh_errfl("pthread_create error!");
+            return -1;
+        }
+    }
+    while(total < (uint64_t)TEST_THREAD_CNT * TEST_THREAD_ADD_CNT){
+        ret = __await__ eh_counter_event_take(&test_ce, EH_COUNTER_EVENT_TAKE_ALL, &count, (eh_sclock_t)eh_msec_to_clock(1000));
+        EH_DBG_ERROR_EXEC(ret != EH_RET_OK, return -1);
+        total += count;
+        wakeup_cnt++;
+    }
+    for(int i = 0; i < TEST_THREAD_CNT; i++)
+        pthread_join(threads[i], NULL);
+    EH_DBG_ERROR_EXEC(total != (uint64_t)TEST_THREAD_CNT * TEST_THREAD_ADD_CNT, return -1);
+    EH_DBG_ERROR_EXEC(eh_counter_event_pending(&test_ce) != 0, return -1);
+    eh_infofl("%llu notifications consumed by %u wakeups", (unsigned long long)total, wakeup_cnt);
+    return 0;
+}
+
+int task_app(void *arg){
+    (void) arg;
+    EH_DBG_ERROR_EXEC(test_basic() < 0, return -1);
+    eh_debugfl("test counter event basic Pass");
+    EH_DBG_ERROR_EXEC(test_epoll() < 0, return -1);
+    eh_debugfl("test counter event epoll Pass");
+    EH_DBG_ERROR_EXEC(test_burst() < 0, return -1);
+    eh_debugfl("test counter event burst Pass");
+    eh_counter_event_clean(&test_ce);
+    return 0;
+}
+
+int main(void){
+    int ret;
+    eh_global_init();
+    ret = task_app("task_app");
+    eh_global_exit();
+    return ret;
+}
@@ -18,6 +18,7 @@
 #include "eh_event.h"
 #include "eh_platform.h"
 #include "eh_timer.h" 
+#include "eh_sleep.h"
 #include "eh_types.h"
 #include <stdlib.h>
 #include <sys/epoll.h>
@@ -28,6 +29,235 @@ void stdout_write(void *stream, const uint8_t *buf, size_t size){
     printf("%.*s", (int)size, (const char*)buf);
 }
 
+#define CHURN_EVENT_CNT     256
+#define CHURN_LOOP_CNT      200
+
+static eh_event_t churn_events[CHURN_EVENT_CNT];
+static eh_epoll_node_t churn_nodes[CHURN_EVENT_CNT];
+
+static int test_epoll_node(void){
+    eh_epoll_t epoll;
+    eh_epoll_slot_t epoll_slot[4];
+    eh_clock_t start, event_time, node_time;
+    int ret;
+
+    epoll = eh_epoll_new();
+    EH_DBG_ERROR_EXEC(eh_ptr_to_error(epoll) < 0, return -1);
+    for(int i = 0; i < CHURN_EVENT_CNT; i++)
+        eh_event_init(&churn_events[i]);
+
+    /* 节点方式添加的事件与指针方式一样能被等待到 */
+    eh_epoll_add_node(epoll, &churn_nodes[0], &churn_events[0], "node0");
+    eh_epoll_add_event(epoll, &churn_events[1], "event1");
+    eh_event_notify(&churn_events[0]);
+    eh_event_notify(&churn_events[1]);
+    ret = __await__ eh_epoll_wait(epoll, epoll_slot, 4, 0);
+    EH_DBG_ERROR_EXEC(ret != 2, goto error);
+    EH_DBG_ERROR_EXEC(epoll_slot[0].event != &churn_events[0] || epoll_slot[1].event != &churn_events[1], goto error);
+    /* 删除后的节点不再收到事件，且只能从添加它的接口删除 */
+    EH_DBG_ERROR_EXEC(eh_epoll_del_node(epoll, &churn_nodes[0]) != EH_RET_OK, goto error);
+    EH_DBG_ERROR_EXEC(eh_epoll_del_node(epoll, &churn_nodes[0]) != EH_RET_INVALID_PARAM, goto error);
+    EH_DBG_ERROR_EXEC(eh_epoll_del_event(epoll, &churn_events[1]) != EH_RET_OK, goto error);
+    eh_event_notify(&churn_events[0]);
+    ret = __await__ eh_epoll_wait(epoll, epoll_slot, 4, 0);
+    EH_DBG_ERROR_EXEC(ret != EH_RET_TIMEOUT, goto error);
+
+    start = eh_get_clock_monotonic_time();
+    for(int loop = 0; loop < CHURN_LOOP_CNT; loop++){
+        for(int i = 0; i < CHURN_EVENT_CNT; i++)
+            EH_DBG_ERROR_EXEC(eh_epoll_add_event(epoll, &churn_events[i], NULL) < 0, goto error);
+        for(int i = 0; i < CHURN_EVENT_CNT; i++)
+            eh_epoll_del_event(epoll, &churn_events[i]);
+    }
+    event_time = eh_get_clock_monotonic_time() - start;
+
+    start = eh_get_clock_monotonic_time();
+    for(int loop = 0; loop < CHURN_LOOP_CNT; loop++){
+        for(int i = 0; i < CHURN_EVENT_CNT; i++)
+            eh_epoll_add_node(epoll, &churn_nodes[i], &churn_events[i], NULL);
+        for(int i = 0; i < CHURN_EVENT_CNT; i++)
+            eh_epoll_del_node(epoll, &churn_nodes[i]);
+    }
+    node_time = eh_get_clock_monotonic_time() - start;
+    eh_infofl("%d add/del: eh_epoll_add_event %llu us, eh_epoll_add_node %llu us", 
+        CHURN_LOOP_CNT * CHURN_EVENT_CNT, 
+        (unsigned long long)eh_clock_to_usec(event_time), (unsigned long long)eh_clock_to_usec(node_time));
+
+    /* epoll删除时用户提供的节点被分离而不是释放 */
+    eh_epoll_add_node(epoll, &churn_nodes[0], &churn_events[0], NULL);
+    eh_epoll_del(epoll);
+    EH_DBG_ERROR_EXEC(!eh_list_empty(&churn_events[0].receptor_list_head), return -1);
+    return 0;
+error:
+    eh_epoll_del(epoll);
+    return -1;
+}
+
+static int level_cnt;
+
+static bool level_condition(void *userdata){
+    (void)userdata;
+    return level_cnt > 0;
+}
+
+static int test_epoll_mode(void){
+    eh_epoll_t epoll_a, epoll_b, epoll_c;
+    eh_epoll_slot_t epoll_slot[4];
+    eh_event_t event;
+    int cnt_a = 0, cnt_b = 0, cnt_c = 0;
+    int ret = -1;
+
+    eh_event_init(&event);
+    epoll_a = eh_epoll_new();
+    epoll_b = eh_epoll_new();
+    epoll_c = eh_epoll_new();
+
+    /* EH_EPOLLONESHOT */
+    eh_epoll_add_event_mode(epoll_a, &event, NULL, EH_EPOLLONESHOT, NULL);
+    eh_event_notify(&event);
+    EH_DBG_ERROR_EXEC(__await__ eh_epoll_wait(epoll_a, epoll_slot, 4, 0) != 1, goto out);
+    eh_event_notify(&event);
+    EH_DBG_ERROR_EXEC(__await__ eh_epoll_wait(epoll_a, epoll_slot, 4, 0) != EH_RET_TIMEOUT, goto out);
+    EH_DBG_ERROR_EXEC(eh_epoll_rearm_event(epoll_a, &event) != EH_RET_OK, goto out);
+    eh_event_notify(&event);
+    EH_DBG_ERROR_EXEC(__await__ eh_epoll_wait(epoll_a, epoll_slot, 4, 0) != 1, goto out);
+    eh_epoll_del_event(epoll_a, &event);
+
+    /* EH_EPOLLLT */
+    EH_DBG_ERROR_EXEC(eh_epoll_add_event_mode(epoll_a, &event, NULL, EH_EPOLLLT, NULL) != EH_RET_INVALID_PARAM, goto out);
+    eh_epoll_add_event_mode(epoll_a, &event, NULL, EH_EPOLLLT, level_condition);
+    level_cnt = 1;
+    eh_event_notify(&event);
+    EH_DBG_ERROR_EXEC(__await__ eh_epoll_wait(epoll_a, epoll_slot, 4, 0) != 1, goto out);
+    EH_DBG_ERROR_EXEC(__await__ eh_epoll_wait(epoll_a, epoll_slot, 4, 0) != 1, goto out);
+    level_cnt = 0;
+    EH_DBG_ERROR_EXEC(__await__ eh_epoll_wait(epoll_a, epoll_slot, 4, 0) != EH_RET_TIMEOUT, goto out);
+    eh_epoll_del_event(epoll_a, &event);
+
+    /* EH_EPOLLEXCLUSIVE，a和b轮流被唤醒，非独占的c每次都被唤醒 */
+    eh_epoll_add_event_mode(epoll_a, &event, NULL, EH_EPOLLEXCLUSIVE, NULL);
+    eh_epoll_add_event_mode(epoll_b, &event, NULL, EH_EPOLLEXCLUSIVE, NULL);
+    eh_epoll_add_event(epoll_c, &event, NULL);
+    for(int i = 0; i < 4; i++){
+        eh_event_notify(&event);
+        cnt_a += __await__ eh_epoll_wait(epoll_a, epoll_slot, 4, 0) == 1;
+        cnt_b += __await__ eh_epoll_wait(epoll_b, epoll_slot, 4, 0) == 1;
+        cnt_c += __await__ eh_epoll_wait(epoll_c, epoll_slot, 4, 0) == 1;
+    }
+    EH_DBG_ERROR_EXEC(cnt_a != 2 || cnt_b != 2 || cnt_c != 4, goto out);
+    ret = 0;
+out:
+    eh_epoll_del(epoll_a);
+    eh_epoll_del(epoll_b);
+    eh_epoll_del(epoll_c);
+    return ret;
+}
+
+static eh_epoll_t level_epoll;
+static int level_delivered;
+static int level_timeout;
+
+static int task_level_waiter(void *arg){
+    eh_epoll_slot_t epoll_slot;
+    int ret;
+    (void)arg;
+    ret = __await__ eh_epoll_wait(level_epoll, &epoll_slot, 1, (eh_sclock_t)eh_msec_to_clock(50));
+    if(ret == 1)
+        level_delivered++;
+    else if(ret == EH_RET_TIMEOUT)
+        level_timeout++;
+    return 0;
+}
+
+/* 水平触发的项被读走后仍留在就绪队列中，但不能因此唤醒其他等待者重复投递 */
+static int test_epoll_level_multi_waiter(void){
+    eh_task_t *tasks[2];
+    eh_event_t event;
+    int app_ret;
+
+    eh_event_init(&event);
+    level_epoll = eh_epoll_new();
+    EH_DBG_ERROR_EXEC(eh_ptr_to_error(level_epoll) < 0, return -1);
+    eh_epoll_add_event_mode(level_epoll, &event, NULL, EH_EPOLLLT, level_condition);
+    for(int i = 0; i < 2; i++){
+        tasks[i] = eh_task_create("level_waiter", 0, 4*1024, NULL, task_level_waiter);
+        EH_DBG_ERROR_EXEC(eh_ptr_to_error(tasks[i]) < 0, return -1);
+    }
+    __await__ eh_usleep(1000);
+    level_cnt = 1;
+    eh_event_notify(&event);
+    __await__ eh_usleep(1000);
+    EH_DBG_ERROR_EXEC(level_delivered != 1, return -1);
+    /* 事件不再就绪，另一个等待者一直等到超时 */
+    level_cnt = 0;
+    for(int i = 0; i < 2; i++)
+        __await__ eh_task_join(tasks[i], &app_ret, EH_TIME_FOREVER);
+    eh_epoll_del(level_epoll);
+    EH_DBG_ERROR_EXEC(level_delivered != 1 || level_timeout != 1, return -1);
+    return 0;
+}
+
+#define WORKER_CNT          4
+#define WORKER_EVENT_CNT    8
+#define WORKER_ROUND_CNT    100
+
+static eh_epoll_t worker_epoll;
+static eh_event_t worker_events[WORKER_EVENT_CNT];
+static int worker_handled[WORKER_CNT];
+static bool worker_stop;
+
+static int task_worker(void *arg){
+    int id = (int)(intptr_t)arg;
+    eh_epoll_slot_t epoll_slot;
+    int ret;
+    while(!worker_stop){
+        ret = __await__ eh_epoll_wait(worker_epoll, &epoll_slot, 1, (eh_sclock_t)eh_msec_to_clock(10));
+        if(ret == EH_RET_TIMEOUT)
+            continue;
+        if(ret < 0)
+            return ret;
+        worker_handled[id]++;
+        /* 模拟处理耗时，让出CPU给其他工作任务 */
+        __await__ eh_task_yield();
+    }
+    return 0;
+}
+
+static int test_epoll_multi_waiter(void){
+    eh_task_t *workers[WORKER_CNT];
+    int total = 0, app_ret;
+
+    worker_epoll = eh_epoll_new();
+    EH_DBG_ERROR_EXEC(eh_ptr_to_error(worker_epoll) < 0, return -1);
+    for(int i = 0; i < WORKER_EVENT_CNT; i++){
+        eh_event_init(&worker_events[i]);
+        eh_epoll_add_event(worker_epoll, &worker_events[i], NULL);
+    }
+    for(int i = 0; i < WORKER_CNT; i++){
+        workers[i] = eh_task_create("worker", 0, 4*1024, (void*)(intptr_t)i, task_worker);
+        EH_DBG_ERROR_EXEC(eh_ptr_to_error(workers[i]) < 0, return -1);
+    }
+    /* 让所有工作任务进入等待 */
+    eh_usleep(1000);
+    for(int round = 0; round < WORKER_ROUND_CNT; round++){
+        for(int i = 0; i < WORKER_EVENT_CNT; i++)
+            eh_event_notify(&worker_events[i]);
+        eh_usleep(1000);
+    }
+    worker_stop = true;
+    for(int i = 0; i < WORKER_CNT; i++)
+        __await__ eh_task_join(workers[i], &app_ret, EH_TIME_FOREVER);
+    eh_epoll_del(worker_epoll);
+
+    for(int i = 0; i < WORKER_CNT; i++){
+        EH_DBG_ERROR_EXEC(worker_handled[i] == 0, return -1);
+        total += worker_handled[i];
+    }
+    eh_infofl("handled %d/%d/%d/%d", worker_handled[0], worker_handled[1], worker_handled[2], worker_handled[3]);
+    EH_DBG_ERROR_EXEC(total != WORKER_EVENT_CNT * WORKER_ROUND_CNT, return -1);
+    return 0;
+}
+
 int task_app(void *arg){
     eh_timer_event_t timer1, timer2, timer3;
     eh_epoll_t epoll;
@@ -35,6 +265,15 @@ int task_app(void *arg){
     (void) arg;
     int ret;
 
+    EH_DBG_ERROR_EXEC(test_epoll_node() < 0, return -1);
+    eh_debugfl("test epoll node Pass");
+    EH_DBG_ERROR_EXEC(test_epoll_mode() < 0, return -1);
+    eh_debugfl("test epoll mode Pass");
+    EH_DBG_ERROR_EXEC(test_epoll_level_multi_waiter() < 0, return -1);
+    eh_debugfl("test epoll level multi waiter Pass");
+    EH_DBG_ERROR_EXEC(test_epoll_multi_waiter() < 0, return -1);
+    eh_debugfl("test epoll multi waiter Pass");
+
     eh_timer_init(&timer1);
     eh_timer_set_attr(&timer1, EH_TIMER_ATTR_AUTO_CIRCULATION);
     eh_timer_config_interval(&timer1, (eh_sclock_t)eh_msec_to_clock(300));
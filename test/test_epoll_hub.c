@@ -0,0 +1,152 @@
+/**
+ * @file test_epoll_hub.c
+ * @brief epoll_hub每轮循环的系统调用开销测试，
+ *    统计让出CPU密集和短睡眠密集两种场景下epoll_hub_poll的调用次数和超时定时器的设置次数，
+ *    以及大量fd同时就绪时批量大小的调整
+ * @author simon.xiaoapeng (simon.xiaoapeng@gmail.com)
+ * @version 1.0
+ * @date 2024-08-24
+ *
+ * @copyright Copyright (c) 2024  simon.xiaoapeng@gmail.com
+ *
+ * @par 修改日志:
+ */
+
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include "eh.h"
+#include "eh_debug.h"
+#include "eh_event.h"
+#include "eh_platform.h"
+#include "eh_timer.h"
+#include "eh_sleep.h"
+#include "epoll_hub.h"
+
+#define TEST_YIELD_CNT          200000
+#define TEST_SLEEP_CNT          2000
+#define TEST_SLEEP_USEC         200
+#define TEST_BATCH_FD_CNT       500
+
+static struct epoll_fd_action batch_actions[TEST_BATCH_FD_CNT];
+static int batch_fds[TEST_BATCH_FD_CNT];
+static int batch_callback_cnt;
+
+void stdout_write(void *stream, const uint8_t *buf, size_t size){
+    (void)stream;
+    printf("%.*s", (int)size, (const char*)buf);
+}
+
+static int task_yield(void *arg){
+    (void)arg;
+    for(int i = 0; i < TEST_YIELD_CNT; i++)
+        __await__ eh_task_yield();
+    return 0;
+}
+
+/* 两个任务不断让出CPU，同时有一个周期定时器在运行，每轮循环都有一个未到期的超时 */
+static int test_yield(void){
+    eh_timer_event_t timer;
+    eh_task_t *task;
+    uint64_t wait_start, wait_end, set_start, set_end;
+    eh_clock_t start;
+    int ret;
+
+    eh_timer_advanced_init(&timer, (eh_sclock_t)eh_msec_to_clock(1), EH_TIMER_ATTR_AUTO_CIRCULATION);
+    eh_timer_start(&timer);
+    epoll_hub_stat(&wait_start, &set_start);
+    start = eh_get_clock_monotonic_time();
+    task = eh_task_create("yield", 0, 12*1024, NULL, task_yield);
+    EH_DBG_ERROR_EXEC(eh_ptr_to_error(task) < 0, return -1);
+    for(int i = 0; i < TEST_YIELD_CNT; i++)
+        __await__ eh_task_yield();
+    EH_DBG_ERROR_EXEC(__await__ eh_task_join(task, &ret, EH_TIME_FOREVER) < 0 || ret != 0, return -1);
+    epoll_hub_stat(&wait_end, &set_end);
+    eh_infofl("yield: %d yields in %llu us, %llu polls, %llu timer sets",
+        2 * TEST_YIELD_CNT, (unsigned long long)eh_clock_to_usec(eh_get_clock_monotonic_time() - start),
+        (unsigned long long)(wait_end - wait_start), (unsigned long long)(set_end - set_start));
+    eh_timer_clean(&timer);
+    return 0;
+}
+
+/* 连续的短睡眠，每次空闲等待的截止时间都不相同 */
+static int test_sleep(void){
+    uint64_t wait_start, wait_end, set_start, set_end;
+    eh_clock_t start;
+    eh_usec_t usec;
+
+    epoll_hub_stat(&wait_start, &set_start);
+    start = eh_get_clock_monotonic_time();
+    for(int i = 0; i < TEST_SLEEP_CNT; i++)
+        __await__ eh_usleep(TEST_SLEEP_USEC);
+    usec = eh_clock_to_usec(eh_get_clock_monotonic_time() - start);
+    epoll_hub_stat(&wait_end, &set_end);
+    EH_DBG_ERROR_EXEC(usec < (eh_usec_t)TEST_SLEEP_CNT * TEST_SLEEP_USEC, return -1);
+    eh_infofl("sleep: %d x %dus in %llu us (avg overshoot %llu us), %llu polls, %llu timer sets",
+        TEST_SLEEP_CNT, TEST_SLEEP_USEC, (unsigned long long)usec,
+        (unsigned long long)(usec / TEST_SLEEP_CNT - TEST_SLEEP_USEC),
+        (unsigned long long)(wait_end - wait_start), (unsigned long long)(set_end - set_start));
+    return 0;
+}
+
+static void batch_callback(uint32_t events, void *arg){
+    (void)events;
+    (void)arg;
+    batch_callback_cnt++;
+}
+
+/* 大量fd同时就绪，批量大小扩大后所有事件在少数几轮内取完，并且就绪状态缓存在action中 */
+static int test_batch(void){
+    uint64_t wait_start, wait_end;
+    int size_start, polls;
+
+    size_start = epoll_hub_batch_size();
+    for(int i = 0; i < TEST_BATCH_FD_CNT; i++){
+        batch_fds[i] = eventfd(1, EFD_NONBLOCK | EFD_CLOEXEC);
+        EH_DBG_ERROR_EXEC(batch_fds[i] < 0, return -1);
+        batch_actions[i].callback = batch_callback;
+        batch_actions[i].arg = NULL;
+        batch_actions[i].revents = 0;
+        EH_DBG_ERROR_EXEC(epoll_hub_add_fd(batch_fds[i], EPOLLIN | EPOLLET, &batch_actions[i]) < 0, return -1);
+    }
+    batch_callback_cnt = 0;
+    epoll_hub_stat(&wait_start, NULL);
+    while(batch_callback_cnt < TEST_BATCH_FD_CNT)
+        __await__ eh_task_yield();
+    epoll_hub_stat(&wait_end, NULL);
+    polls = (int)(wait_end - wait_start);
+    eh_infofl("batch: %d ready fds in %d polls, batch size %d -> %d",
+        TEST_BATCH_FD_CNT, polls, size_start, epoll_hub_batch_size());
+    EH_DBG_ERROR_EXEC(epoll_hub_batch_size() < size_start, return -1);
+    for(int i = 0; i < TEST_BATCH_FD_CNT; i++){
+        EH_DBG_ERROR_EXEC(!(batch_actions[i].revents & EPOLLIN), return -1);
+        epoll_hub_del_fd(batch_fds[i]);
+        close(batch_fds[i]);
+    }
+
+    /* 之后长时间没有事件，批量大小逐渐缩小 */
+    for(int i = 0; i < 4000; i++)
+        __await__ eh_task_yield();
+    eh_infofl("batch: after idle polls batch size %d", epoll_hub_batch_size());
+    return 0;
+}
+
+int task_app(void *arg){
+    (void) arg;
+    EH_DBG_ERROR_EXEC(test_yield() < 0, return -1);
+    eh_debugfl("test epoll_hub yield Pass");
+    EH_DBG_ERROR_EXEC(test_sleep() < 0, return -1);
+    eh_debugfl("test epoll_hub sleep Pass");
+    EH_DBG_ERROR_EXEC(test_batch() < 0, return -1);
+    eh_debugfl("test epoll_hub batch Pass");
+    return 0;
+}
+
+int main(void){
+    int ret;
+    eh_global_init();
+    ret = task_app("task_app");
+    eh_global_exit();
+    return ret;
+}
@@ -36,8 +36,222 @@ void stdout_write(void *stream, const uint8_t *buf, size_t size){
     printf("%.*s", (int)size, (const char*)buf);
 }
 
+#define MODE_BENCH_CNT      100000
+
+static int mode_cnt;
+static void slot_count_function(eh_event_t *e, void *p){
+    (void)e;
+    (void)p;
+    mode_cnt++;
+}
+
+static int test_cb_mode_one(enum eh_event_cb_mode mode, const char *name){
+    eh_event_t event;
+    eh_event_cb_trigger_t mode_trigger;
+    eh_event_cb_slot_t mode_slot;
+    eh_clock_t start;
+    int ret = -1;
+
+    eh_event_init(&event);
+    eh_event_cb_trigger_init(&mode_trigger);
+    eh_event_cb_trigger_set_mode(&mode_trigger, mode);
+    eh_event_cb_slot_init(&mode_slot, slot_count_function, NULL);
+    eh_event_cb_register(&event, &mode_trigger);
+    eh_event_cb_connect(&mode_trigger, &mode_slot);
+
+    mode_cnt = 0;
+    eh_event_cb_notify(&event, &mode_trigger);
+    /* 只有DIRECT模式在通知返回时槽函数已被调用 */
+    EH_DBG_ERROR_EXEC((mode == EH_EVENT_CB_MODE_DIRECT) != (mode_cnt == 1), goto out);
+    __await__ eh_usleep(1000);
+    EH_DBG_ERROR_EXEC(mode_cnt != 1, goto out);
+
+    mode_cnt = 0;
+    start = eh_get_clock_monotonic_time();
+    for(int i = 0; i < MODE_BENCH_CNT; i++){
+        eh_event_cb_notify(&event, &mode_trigger);
+        while(mode_cnt == i)
+            __await__ eh_task_yield();
+    }
+    eh_infofl("%s: %d signals in %llu us", name, MODE_BENCH_CNT, 
+        (unsigned long long)eh_clock_to_usec(eh_get_clock_monotonic_time() - start));
+    ret = 0;
+out:
+    eh_event_cb_trigger_clean(&mode_trigger);
+    EH_DBG_ERROR_EXEC(!eh_list_empty(&mode_trigger.cb_head), ret = -1);
+    eh_event_cb_unregister(&event);
+    eh_event_clean(&event);
+    return ret;
+}
+
+static int deferred_cnt;
+static void slot_deferred_count_function(eh_event_t *e, void *p){
+    (void)e;
+    (void)p;
+    deferred_cnt++;
+}
+
+/* DIRECT通知只调用自己触发器的槽函数，已触发的DEFERRED槽函数仍在本轮调度循环结束时调用 */
+static int test_cb_direct_isolation(void){
+    eh_event_t direct_event, deferred_event;
+    eh_event_cb_trigger_t direct_trigger, deferred_trigger;
+    eh_event_cb_slot_t direct_slot, deferred_slot;
+    int ret = -1;
+
+    eh_event_init(&direct_event);
+    eh_event_init(&deferred_event);
+    eh_event_cb_trigger_init(&direct_trigger);
+    eh_event_cb_trigger_init(&deferred_trigger);
+    eh_event_cb_trigger_set_mode(&direct_trigger, EH_EVENT_CB_MODE_DIRECT);
+    eh_event_cb_trigger_set_mode(&deferred_trigger, EH_EVENT_CB_MODE_DEFERRED);
+    eh_event_cb_slot_init(&direct_slot, slot_count_function, NULL);
+    eh_event_cb_slot_init(&deferred_slot, slot_deferred_count_function, NULL);
+    eh_event_cb_register(&direct_event, &direct_trigger);
+    eh_event_cb_register(&deferred_event, &deferred_trigger);
+    eh_event_cb_connect(&direct_trigger, &direct_slot);
+    eh_event_cb_connect(&deferred_trigger, &deferred_slot);
+
+    mode_cnt = 0;
+    deferred_cnt = 0;
+    eh_event_cb_notify(&deferred_event, &deferred_trigger);
+    eh_event_cb_notify(&direct_event, &direct_trigger);
+    EH_DBG_ERROR_EXEC(mode_cnt != 1 || deferred_cnt != 0, goto out);
+    __await__ eh_usleep(1000);
+    EH_DBG_ERROR_EXEC(mode_cnt != 1 || deferred_cnt != 1, goto out);
+    ret = 0;
+out:
+    eh_event_cb_trigger_clean(&direct_trigger);
+    eh_event_cb_trigger_clean(&deferred_trigger);
+    eh_event_cb_unregister(&direct_event);
+    eh_event_cb_unregister(&deferred_event);
+    eh_event_clean(&direct_event);
+    eh_event_clean(&deferred_event);
+    return ret;
+}
+
+#define LANE_SLOW_EVENT_CNT     8
+#define LANE_SLOW_USEC          2000
+
+static eh_event_t lane_slow_events[LANE_SLOW_EVENT_CNT];
+static eh_event_t lane_fast_event;
+static eh_event_cb_trigger_t lane_slow_trigger, lane_fast_trigger;
+static eh_event_cb_slot_t lane_slow_slot, lane_fast_slot;
+static int lane_slow_cnt;
+static eh_clock_t lane_fast_notify_time, lane_fast_latency;
+
+static void slot_lane_slow(eh_event_t *e, void *p){
+    eh_clock_t start = eh_get_clock_monotonic_time();
+    (void)e;
+    (void)p;
+    /* 模拟耗时的日志槽函数 */
+    while(eh_clock_to_usec(eh_get_clock_monotonic_time() - start) < LANE_SLOW_USEC);
+    if(++lane_slow_cnt == 2){
+        lane_fast_notify_time = eh_get_clock_monotonic_time();
+        eh_event_notify(&lane_fast_event);
+    }
+}
+
+static void slot_lane_fast(eh_event_t *e, void *p){
+    (void)e;
+    (void)p;
+    lane_fast_latency = eh_get_clock_monotonic_time() - lane_fast_notify_time;
+}
+
+static int test_cb_lane(void){
+    eh_event_init(&lane_fast_event);
+    eh_event_cb_trigger_init(&lane_slow_trigger);
+    eh_event_cb_trigger_init(&lane_fast_trigger);
+    eh_event_cb_slot_init(&lane_slow_slot, slot_lane_slow, NULL);
+    eh_event_cb_slot_init(&lane_fast_slot, slot_lane_fast, NULL);
+    eh_event_cb_connect(&lane_slow_trigger, &lane_slow_slot);
+    eh_event_cb_connect(&lane_fast_trigger, &lane_fast_slot);
+    EH_DBG_ERROR_EXEC(eh_event_cb_register_lane(&lane_fast_event, &lane_fast_trigger, EH_EVENT_CB_LANE_CNT) != EH_RET_INVALID_PARAM, return -1);
+    eh_event_cb_register_lane(&lane_fast_event, &lane_fast_trigger, 0);
+    for(int i = 0; i < LANE_SLOW_EVENT_CNT; i++){
+        eh_event_init(&lane_slow_events[i]);
+        eh_event_cb_register_lane(&lane_slow_events[i], &lane_slow_trigger, EH_EVENT_CB_LANE_CNT - 1);
+    }
+    EH_DBG_ERROR_EXEC(eh_event_cb_lane_set_batch_size(EH_EVENT_CB_LANE_CNT - 1, 0) != EH_RET_INVALID_PARAM, return -1);
+    eh_event_cb_lane_set_batch_size(EH_EVENT_CB_LANE_CNT - 1, 1);
+    /* 通道任务已在等待中，先触发一次使新的批大小生效 */
+    eh_event_notify(&lane_slow_events[0]);
+    __await__ eh_usleep(LANE_SLOW_USEC * 2);
+    lane_slow_cnt = 0;
+
+    for(int i = 0; i < LANE_SLOW_EVENT_CNT; i++)
+        eh_event_notify(&lane_slow_events[i]);
+    __await__ eh_usleep(LANE_SLOW_USEC * LANE_SLOW_EVENT_CNT * 2);
+    EH_DBG_ERROR_EXEC(lane_slow_cnt != LANE_SLOW_EVENT_CNT, return -1);
+    eh_infofl("fast slot latency %llu us behind slow lane", (unsigned long long)eh_clock_to_usec(lane_fast_latency));
+    /* 慢通道每批只处理一个，快速槽最多等待一个慢槽函数 */
+    EH_DBG_ERROR_EXEC(eh_clock_to_usec(lane_fast_latency) >= LANE_SLOW_USEC, return -1);
+
+    for(int i = 0; i < LANE_SLOW_EVENT_CNT; i++)
+        eh_event_cb_unregister(&lane_slow_events[i]);
+    eh_event_cb_unregister(&lane_fast_event);
+    eh_event_cb_trigger_clean(&lane_slow_trigger);
+    eh_event_cb_trigger_clean(&lane_fast_trigger);
+    return 0;
+}
+
+static int lane_order[2], lane_order_cnt;
+static void slot_lane_order(eh_event_t *e, void *p){
+    (void)e;
+    lane_order[lane_order_cnt++] = (int)(intptr_t)p;
+}
+
+/* 同时就绪时编号小的通道先运行，与通知的先后无关 */
+static int test_cb_lane_priority(void){
+    eh_event_t low_event, high_event;
+    eh_event_cb_trigger_t low_trigger, high_trigger;
+    eh_event_cb_slot_t low_slot, high_slot;
+    int ret = -1;
+
+    EH_DBG_ERROR_EXEC(EH_EVENT_CB_LANE_CNT < 3, return -1);
+    eh_event_init(&low_event);
+    eh_event_init(&high_event);
+    eh_event_cb_trigger_init(&low_trigger);
+    eh_event_cb_trigger_init(&high_trigger);
+    eh_event_cb_slot_init(&low_slot, slot_lane_order, (void*)(intptr_t)(EH_EVENT_CB_LANE_CNT - 1));
+    eh_event_cb_slot_init(&high_slot, slot_lane_order, (void*)(intptr_t)1);
+    eh_event_cb_connect(&low_trigger, &low_slot);
+    eh_event_cb_connect(&high_trigger, &high_slot);
+    eh_event_cb_register_lane(&low_event, &low_trigger, EH_EVENT_CB_LANE_CNT - 1);
+    eh_event_cb_register_lane(&high_event, &high_trigger, 1);
+
+    /* 批大小上限由EH_CONFIG_EVENT_CALLBACK_LANE_BATCH_SIZE_MAX决定 */
+    EH_DBG_ERROR_EXEC(eh_event_cb_lane_set_batch_size(1, EH_CONFIG_EVENT_CALLBACK_LANE_BATCH_SIZE_MAX) != EH_RET_OK, goto out);
+    EH_DBG_ERROR_EXEC(eh_event_cb_lane_set_batch_size(1, EH_CONFIG_EVENT_CALLBACK_LANE_BATCH_SIZE_MAX + 1) != EH_RET_INVALID_PARAM, goto out);
+
+    lane_order_cnt = 0;
+    eh_event_notify(&low_event);
+    eh_event_notify(&high_event);
+    __await__ eh_usleep(1000);
+    EH_DBG_ERROR_EXEC(lane_order_cnt != 2 || lane_order[0] != 1 || lane_order[1] != EH_EVENT_CB_LANE_CNT - 1, goto out);
+    ret = 0;
+out:
+    eh_event_cb_lane_set_batch_size(1, EH_CONFIG_EVENT_CALLBACK_LANE_BATCH_SIZE);
+    eh_event_cb_unregister(&low_event);
+    eh_event_cb_unregister(&high_event);
+    eh_event_cb_trigger_clean(&low_trigger);
+    eh_event_cb_trigger_clean(&high_trigger);
+    eh_event_clean(&low_event);
+    eh_event_clean(&high_event);
+    return ret;
+}
+
 int task_app(void *arg){
     (void) arg;
+    EH_DBG_ERROR_EXEC(test_cb_mode_one(EH_EVENT_CB_MODE_TASK, "task") < 0, return -1);
+    EH_DBG_ERROR_EXEC(test_cb_mode_one(EH_EVENT_CB_MODE_DEFERRED, "deferred") < 0, return -1);
+    EH_DBG_ERROR_EXEC(test_cb_mode_one(EH_EVENT_CB_MODE_DIRECT, "direct") < 0, return -1);
+    EH_DBG_ERROR_EXEC(test_cb_direct_isolation() < 0, return -1);
+    eh_debugfl("test event_cb mode Pass");
+    EH_DBG_ERROR_EXEC(test_cb_lane() < 0, return -1);
+    eh_debugfl("test event_cb lane Pass");
+    EH_DBG_ERROR_EXEC(test_cb_lane_priority() < 0, return -1);
+    eh_debugfl("test event_cb lane priority Pass");
+
     eh_timer_init(&timer1);
     eh_timer_config_interval(&timer1, eh_msec_to_clock(1000));
     eh_timer_set_attr(&timer1, EH_TIMER_ATTR_AUTO_CIRCULATION);
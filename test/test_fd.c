@@ -0,0 +1,426 @@
+/**
+ * @file test_fd.c
+ * @brief 异步fd IO测试
+ * @author simon.xiaoapeng (simon.xiaoapeng@gmail.com)
+ * @version 1.0
+ * @date 2024-08-20
+ *
+ * @copyright Copyright (c) 2024  simon.xiaoapeng@gmail.com
+ *
+ * @par 修改日志:
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include "eh.h"
+#include "eh_debug.h"
+#include "eh_event.h"
+#include "eh_platform.h"
+#include "eh_timer.h"
+#include "eh_sleep.h"
+#include "eh_fd.h"
+
+#define TEST_ECHO_TOTAL         (4 * 1024 * 1024)
+#define TEST_ECHO_CHUNK         (16 * 1024)
+#define TEST_PINGPONG_CNT       20000
+#define TEST_SENDFILE_PATH      "/tmp/eh_fd_sendfile.tmp"
+#define TEST_SENDFILE_SIZE      (64 * 1024 * 1024)
+#define TEST_SPLICE_CHUNK       (64 * 1024)
+
+static uint8_t send_buf[TEST_ECHO_CHUNK];
+static uint8_t recv_buf[TEST_ECHO_CHUNK];
+static uint8_t echo_buf[TEST_ECHO_CHUNK];
+
+void stdout_write(void *stream, const uint8_t *buf, size_t size){
+    (void)stream;
+    printf("%.*s", (int)size, (const char*)buf);
+}
+
+static void* thread_pipe_writer(void* arg){
+    int fd = *(int*)arg;
+    usleep(20000);
+    if(write(fd, "x", 1) != 1)
+        return (void*)-1;
+    return NULL;
+}
+
+static int test_pipe(void){
+    int fds[2];
+    pthread_t thread;
+    eh_clock_t start;
+    char c;
+    int ret;
+
+    EH_DBG_ERROR_EXEC(pipe(fds) < 0, return -1);
+    ret = __await__ eh_fd_wait(fds[0], EPOLLIN, (eh_sclock_t)eh_msec_to_clock(10));
+    EH_DBG_ERROR_EXEC(ret != EH_RET_TIMEOUT, return -1);
+    EH_DBG_ERROR_EXEC(__await__ eh_read(fds[0], &c, 1, 0) != -1 || errno != EAGAIN, return -1);
+    EH_DBG_ERROR_EXEC(__await__ eh_read(fds[0], &c, 1, (eh_sclock_t)eh_msec_to_clock(10)) != -1 || errno != ETIMEDOUT, return -1);
+
+    /* 其他线程写入后，挂起中的读操作被唤醒 */
+    start = eh_get_clock_monotonic_time();
+    EH_DBG_ERROR_EXEC(pthread_create(&thread, NULL, thread_pipe_writer, &fds[1]) != 0, return -1);
+    EH_DBG_ERROR_EXEC(__await__ eh_read(fds[0], &c, 1, EH_TIME_FOREVER) != 1 || c != 'x', return -1);
+    pthread_join(thread, NULL);
+    eh_infofl("pipe read woke after %llu us", (unsigned long long)eh_clock_to_usec(eh_get_clock_monotonic_time() - start));
+
+    /* 对端关闭时读到0 */
+    close(fds[1]);
+    EH_DBG_ERROR_EXEC(__await__ eh_read(fds[0], &c, 1, EH_TIME_FOREVER) != 0, return -1);
+    eh_close(fds[0]);
+    return 0;
+}
+
+/* fd被直接close后，复用该fd号的新管道不会继承旧的就绪状态 */
+static int test_fd_reuse(void){
+    int old_fds[2], fds[2];
+    char c;
+
+    EH_DBG_ERROR_EXEC(pipe(old_fds) < 0, return -1);
+    EH_DBG_ERROR_EXEC(eh_fd_register(old_fds[0]) < 0, return -1);
+    EH_DBG_ERROR_EXEC(__await__ eh_read(old_fds[0], &c, 1, (eh_sclock_t)eh_msec_to_clock(10)) != -1 || errno != ETIMEDOUT, return -1);
+    close(old_fds[0]);
+    close(old_fds[1]);
+    EH_DBG_ERROR_EXEC(pipe(fds) < 0, return -1);
+    EH_DBG_ERROR_EXEC(fds[0] != old_fds[0], return -1);
+    EH_DBG_ERROR_EXEC(write(fds[1], "y", 1) != 1, return -1);
+    EH_DBG_ERROR_EXEC(__await__ eh_read(fds[0], &c, 1, (eh_sclock_t)eh_msec_to_clock(1000)) != 1 || c != 'y', return -1);
+    eh_close(fds[0]);
+    close(fds[1]);
+    return 0;
+}
+
+static int task_echo_server(void *arg){
+    int listen_fd = *(int*)arg;
+    ssize_t n, sent;
+    int fd;
+    fd = __await__ eh_accept(listen_fd, NULL, NULL, EH_TIME_FOREVER);
+    EH_DBG_ERROR_EXEC(fd < 0, return -1);
+    for(;;){
+        n = __await__ eh_recv(fd, echo_buf, sizeof(echo_buf), 0, EH_TIME_FOREVER);
+        if(n <= 0)
+            break;
+        for(sent = 0; sent < n; ){
+            ssize_t ret = __await__ eh_send(fd, echo_buf + sent, (size_t)(n - sent), 0, EH_TIME_FOREVER);
+            EH_DBG_ERROR_EXEC(ret < 0, eh_close(fd); return -1);
+            sent += ret;
+        }
+    }
+    eh_close(fd);
+    return n < 0 ? -1 : 0;
+}
+
+static int task_echo_reader(void *arg){
+    int fd = *(int*)arg;
+    size_t total = 0;
+    ssize_t n;
+    uint8_t expect = 0;
+    while(total < TEST_ECHO_TOTAL){
+        n = __await__ eh_recv(fd, recv_buf, sizeof(recv_buf), 0, (eh_sclock_t)eh_msec_to_clock(5000));
+        EH_DBG_ERROR_EXEC(n <= 0, return -1);
+        for(ssize_t i = 0; i < n; i++){
+            EH_DBG_ERROR_EXEC(recv_buf[i] != expect, return -1);
+            expect++;
+        }
+        total += (size_t)n;
+    }
+    return 0;
+}
+
+static int test_tcp_echo(void){
+    struct sockaddr_in addr;
+    socklen_t addrlen = sizeof(addr);
+    eh_task_t *server, *reader;
+    eh_clock_t start;
+    size_t total = 0;
+    int listen_fd, fd, server_ret, reader_ret;
+    ssize_t n;
+
+    for(size_t i = 0; i < sizeof(send_buf); i++)
+        send_buf[i] = (uint8_t)i;
+
+    listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    EH_DBG_ERROR_EXEC(listen_fd < 0, return -1);
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    EH_DBG_ERROR_EXEC(bind(listen_fd, (struct sockaddr*)&addr, sizeof(addr)) < 0, return -1);
+    EH_DBG_ERROR_EXEC(listen(listen_fd, 8) < 0, return -1);
+    getsockname(listen_fd, (struct sockaddr*)&addr, &addrlen);
+
+    server = eh_task_create("echo_server", 0, 12*1024, &listen_fd, task_echo_server);
+    EH_DBG_ERROR_EXEC(eh_ptr_to_error(server) < 0, return -1);
+
+    fd = socket(AF_INET, SOCK_STREAM, 0);
+    EH_DBG_ERROR_EXEC(fd < 0, return -1);
+    EH_DBG_ERROR_EXEC(__await__ eh_connect(fd, (struct sockaddr*)&addr, sizeof(addr), (eh_sclock_t)eh_msec_to_clock(1000)) < 0, return -1);
+    reader = eh_task_create("echo_reader", 0, 12*1024, &fd, task_echo_reader);
+    EH_DBG_ERROR_EXEC(eh_ptr_to_error(reader) < 0, return -1);
+
+    /* 发送量远大于socket缓冲区，发送方会多次遇到EAGAIN而挂起 */
+    start = eh_get_clock_monotonic_time();
+    while(total < TEST_ECHO_TOTAL){
+        n = __await__ eh_send(fd, send_buf + total % TEST_ECHO_CHUNK, TEST_ECHO_CHUNK - total % TEST_ECHO_CHUNK, 0, EH_TIME_FOREVER);
+        EH_DBG_ERROR_EXEC(n <= 0, return -1);
+        total += (size_t)n;
+    }
+    EH_DBG_ERROR_EXEC(__await__ eh_task_join(reader, &reader_ret, EH_TIME_FOREVER) < 0 || reader_ret != 0, return -1);
+    eh_infofl("tcp echo %d bytes in %llu us", TEST_ECHO_TOTAL,
+        (unsigned long long)eh_clock_to_usec(eh_get_clock_monotonic_time() - start));
+    eh_close(fd);
+    EH_DBG_ERROR_EXEC(__await__ eh_task_join(server, &server_ret, EH_TIME_FOREVER) < 0 || server_ret != 0, return -1);
+
+    /* 连接一个已关闭的端口 */
+    eh_close(listen_fd);
+    fd = socket(AF_INET, SOCK_STREAM, 0);
+    EH_DBG_ERROR_EXEC(__await__ eh_connect(fd, (struct sockaddr*)&addr, sizeof(addr), (eh_sclock_t)eh_msec_to_clock(1000)) != -1 || errno != ECONNREFUSED, return -1);
+    eh_close(fd);
+    return 0;
+}
+
+static int task_pong(void *arg){
+    int fd = *(int*)arg;
+    char buf[64];
+    for(int i = 0; i < TEST_PINGPONG_CNT; i++){
+        if(__await__ eh_read(fd, buf, sizeof(buf), EH_TIME_FOREVER) != 1)
+            return -1;
+        if(__await__ eh_write(fd, buf, 1, EH_TIME_FOREVER) != 1)
+            return -1;
+    }
+    return 0;
+}
+
+/* 小消息往返，每次读到的长度都不足，之后的读操作不需要先进行一次返回EAGAIN的系统调用 */
+static int test_pingpong(void){
+    uint64_t again_start, again_end, skip_start, skip_end;
+    eh_task_t *pong;
+    eh_clock_t start;
+    char buf[64];
+    int fds[2], pong_ret;
+
+    EH_DBG_ERROR_EXEC(socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, fds) < 0, return -1);
+    EH_DBG_ERROR_EXEC(eh_fd_register(fds[0]) < 0 || eh_fd_register(fds[1]) < 0, return -1);
+    pong = eh_task_create("pong", 0, 12*1024, &fds[1], task_pong);
+    EH_DBG_ERROR_EXEC(eh_ptr_to_error(pong) < 0, return -1);
+    eh_fd_stat(&again_start, &skip_start);
+    start = eh_get_clock_monotonic_time();
+    for(int i = 0; i < TEST_PINGPONG_CNT; i++){
+        EH_DBG_ERROR_EXEC(__await__ eh_write(fds[0], "p", 1, EH_TIME_FOREVER) != 1, return -1);
+        EH_DBG_ERROR_EXEC(__await__ eh_read(fds[0], buf, sizeof(buf), (eh_sclock_t)eh_msec_to_clock(1000)) != 1 || buf[0] != 'p', return -1);
+    }
+    eh_fd_stat(&again_end, &skip_end);
+    eh_infofl("pingpong %d round trips in %llu us, %llu EAGAIN, %llu skipped syscalls", TEST_PINGPONG_CNT,
+        (unsigned long long)eh_clock_to_usec(eh_get_clock_monotonic_time() - start),
+        (unsigned long long)(again_end - again_start), (unsigned long long)(skip_end - skip_start));
+    EH_DBG_ERROR_EXEC(__await__ eh_task_join(pong, &pong_ret, EH_TIME_FOREVER) < 0 || pong_ret != 0, return -1);
+    EH_DBG_ERROR_EXEC(skip_end == skip_start, return -1);
+
+    /* 读空后对端再写入，新的边沿使读操作重新进行系统调用 */
+    EH_DBG_ERROR_EXEC(write(fds[1], "ab", 2) != 2, return -1);
+    EH_DBG_ERROR_EXEC(__await__ eh_read(fds[0], buf, 1, EH_TIME_FOREVER) != 1 || buf[0] != 'a', return -1);
+    EH_DBG_ERROR_EXEC(__await__ eh_read(fds[0], buf, 1, EH_TIME_FOREVER) != 1 || buf[0] != 'b', return -1);
+    EH_DBG_ERROR_EXEC(__await__ eh_read(fds[0], buf, 1, 0) != -1 || errno != EAGAIN, return -1);
+    eh_close(fds[0]);
+    eh_close(fds[1]);
+    return 0;
+}
+
+struct test_sink{
+    int                 fd;
+    bool                verify;
+    size_t              total;
+};
+
+/* 读到对端关闭为止，数据应为按字节递增的序列 */
+static int task_sink(void *arg){
+    struct test_sink *sink = (struct test_sink *)arg;
+    ssize_t n;
+    sink->total = 0;
+    for(;;){
+        n = __await__ eh_read(sink->fd, recv_buf, sizeof(recv_buf), (eh_sclock_t)eh_msec_to_clock(5000));
+        EH_DBG_ERROR_EXEC(n < 0, return -1);
+        if(n == 0)
+            return 0;
+        for(ssize_t i = 0; sink->verify && i < n; i++)
+            EH_DBG_ERROR_EXEC(recv_buf[i] != (uint8_t)(sink->total + (size_t)i), return -1);
+        sink->total += (size_t)n;
+    }
+}
+
+/**
+ * @brief                           通过socketpair发送size字节的文件内容，
+ *                                  use_sendfile为false时走read+send的用户态拷贝
+ */
+static int file_to_socket(int file_fd, size_t size, bool verify, bool use_sendfile, eh_usec_t *usec){
+    struct test_sink sink;
+    eh_task_t *task;
+    eh_clock_t start;
+    off_t offset = 0;
+    size_t sent = 0;
+    ssize_t n, len;
+    int sv[2], ret;
+
+    EH_DBG_ERROR_EXEC(socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, sv) < 0, return -1);
+    sink.fd = sv[1];
+    sink.verify = verify;
+    task = eh_task_create("sink", 0, 12*1024, &sink, task_sink);
+    EH_DBG_ERROR_EXEC(eh_ptr_to_error(task) < 0, return -1);
+    start = eh_get_clock_monotonic_time();
+    while(sent < size){
+        if(use_sendfile){
+            n = __await__ eh_sendfile(sv[0], file_fd, &offset, size - sent, EH_TIME_FOREVER);
+        }else{
+            len = pread(file_fd, send_buf, sizeof(send_buf), (off_t)sent);
+            EH_DBG_ERROR_EXEC(len <= 0, return -1);
+            for(n = 0; n < len; ){
+                ssize_t ret_send = __await__ eh_send(sv[0], send_buf + n, (size_t)(len - n), 0, EH_TIME_FOREVER);
+                EH_DBG_ERROR_EXEC(ret_send < 0, return -1);
+                n += ret_send;
+            }
+        }
+        EH_DBG_ERROR_EXEC(n <= 0, return -1);
+        sent += (size_t)n;
+    }
+    eh_close(sv[0]);
+    EH_DBG_ERROR_EXEC(__await__ eh_task_join(task, &ret, EH_TIME_FOREVER) < 0 || ret != 0, return -1);
+    *usec = eh_clock_to_usec(eh_get_clock_monotonic_time() - start);
+    eh_close(sv[1]);
+    EH_DBG_ERROR_EXEC(sink.total != size, return -1);
+    return 0;
+}
+
+static int test_sendfile(void){
+    eh_usec_t copy_usec, sendfile_usec;
+    int file_fd;
+
+    for(size_t i = 0; i < sizeof(send_buf); i++)
+        send_buf[i] = (uint8_t)i;
+    file_fd = open(TEST_SENDFILE_PATH, O_RDWR | O_CREAT | O_TRUNC, 0600);
+    EH_DBG_ERROR_EXEC(file_fd < 0, return -1);
+    unlink(TEST_SENDFILE_PATH);
+    for(size_t off = 0; off < TEST_SENDFILE_SIZE; off += sizeof(send_buf))
+        EH_DBG_ERROR_EXEC(write(file_fd, send_buf, sizeof(send_buf)) != sizeof(send_buf), return -1);
+
+    EH_DBG_ERROR_EXEC(file_to_socket(file_fd, TEST_ECHO_TOTAL, true, true, &sendfile_usec) < 0, return -1);
+    EH_DBG_ERROR_EXEC(file_to_socket(file_fd, TEST_SENDFILE_SIZE, false, false, &copy_usec) < 0, return -1);
+    EH_DBG_ERROR_EXEC(file_to_socket(file_fd, TEST_SENDFILE_SIZE, false, true, &sendfile_usec) < 0, return -1);
+    eh_infofl("%d bytes file to socket: read+send %llu us, sendfile %llu us", TEST_SENDFILE_SIZE,
+        (unsigned long long)copy_usec, (unsigned long long)sendfile_usec);
+    /* 普通文件不能加入epoll，注册失败的原因通过errno返回 */
+    EH_DBG_ERROR_EXEC(eh_fd_register(file_fd) != EH_RET_FAULT, return -1);
+    EH_DBG_ERROR_EXEC(__await__ eh_connect(file_fd, (struct sockaddr *)&send_buf, sizeof(struct sockaddr_in), 0) != -1 || errno != EINVAL, return -1);
+    close(file_fd);
+    return 0;
+}
+
+/* 数据从socket经管道转发到另一个socket，同时通过tee镜像一份到旁路管道 */
+static int task_splice_relay(void *arg){
+    int *fds = (int *)arg;          /* 输入socket，中转管道读端，中转管道写端，镜像管道写端，输出socket */
+    ssize_t n, teed, moved;
+    for(;;){
+        n = __await__ eh_splice(fds[0], NULL, fds[2], NULL, TEST_SPLICE_CHUNK, SPLICE_F_MOVE, (eh_sclock_t)eh_msec_to_clock(5000));
+        EH_DBG_ERROR_EXEC(n < 0, return -1);
+        if(n == 0)
+            break;
+        /* tee总是从管道头部复制，先把已镜像的部分移出再继续复制剩余的部分 */
+        while(n > 0){
+            teed = __await__ eh_tee(fds[1], fds[3], (size_t)n, 0, (eh_sclock_t)eh_msec_to_clock(5000));
+            EH_DBG_ERROR_EXEC(teed <= 0, return -1);
+            for(moved = 0; moved < teed; ){
+                ssize_t ret = __await__ eh_splice(fds[1], NULL, fds[4], NULL, (size_t)(teed - moved), SPLICE_F_MOVE, (eh_sclock_t)eh_msec_to_clock(5000));
+                EH_DBG_ERROR_EXEC(ret <= 0, return -1);
+                moved += ret;
+            }
+            n -= teed;
+        }
+    }
+    eh_close(fds[3]);
+    eh_close(fds[4]);
+    return 0;
+}
+
+static int test_splice_tee(void){
+    struct test_sink out_sink, mirror_sink;
+    eh_task_t *relay, *out_task, *mirror_task;
+    int in_sv[2], out_sv[2], pipe_fds[2], mirror_fds[2];
+    int relay_fds[5];
+    size_t total = 0;
+    ssize_t n;
+    int ret;
+
+    EH_DBG_ERROR_EXEC(socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, in_sv) < 0, return -1);
+    EH_DBG_ERROR_EXEC(socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, out_sv) < 0, return -1);
+    EH_DBG_ERROR_EXEC(pipe2(pipe_fds, O_NONBLOCK) < 0, return -1);
+    EH_DBG_ERROR_EXEC(pipe2(mirror_fds, O_NONBLOCK) < 0, return -1);
+    EH_DBG_ERROR_EXEC(__await__ eh_splice(in_sv[1], NULL, pipe_fds[1], NULL, 1, 0, 0) != -1 || errno != EAGAIN, return -1);
+
+    relay_fds[0] = in_sv[1];
+    relay_fds[1] = pipe_fds[0];
+    relay_fds[2] = pipe_fds[1];
+    relay_fds[3] = mirror_fds[1];
+    relay_fds[4] = out_sv[0];
+    out_sink.fd = out_sv[1];
+    out_sink.verify = true;
+    mirror_sink.fd = mirror_fds[0];
+    mirror_sink.verify = true;
+    relay = eh_task_create("relay", 0, 12*1024, relay_fds, task_splice_relay);
+    EH_DBG_ERROR_EXEC(eh_ptr_to_error(relay) < 0, return -1);
+    out_task = eh_task_create("out_sink", 0, 12*1024, &out_sink, task_sink);
+    EH_DBG_ERROR_EXEC(eh_ptr_to_error(out_task) < 0, return -1);
+    mirror_task = eh_task_create("mirror_sink", 0, 12*1024, &mirror_sink, task_sink);
+    EH_DBG_ERROR_EXEC(eh_ptr_to_error(mirror_task) < 0, return -1);
+
+    for(size_t i = 0; i < sizeof(send_buf); i++)
+        send_buf[i] = (uint8_t)i;
+    while(total < TEST_ECHO_TOTAL){
+        n = __await__ eh_send(in_sv[0], send_buf + total % TEST_ECHO_CHUNK, TEST_ECHO_CHUNK - total % TEST_ECHO_CHUNK, 0, EH_TIME_FOREVER);
+        EH_DBG_ERROR_EXEC(n <= 0, return -1);
+        total += (size_t)n;
+    }
+    shutdown(in_sv[0], SHUT_WR);
+    EH_DBG_ERROR_EXEC(__await__ eh_task_join(relay, &ret, EH_TIME_FOREVER) < 0 || ret != 0, return -1);
+    EH_DBG_ERROR_EXEC(__await__ eh_task_join(out_task, &ret, EH_TIME_FOREVER) < 0 || ret != 0, return -1);
+    EH_DBG_ERROR_EXEC(__await__ eh_task_join(mirror_task, &ret, EH_TIME_FOREVER) < 0 || ret != 0, return -1);
+    EH_DBG_ERROR_EXEC(out_sink.total != TEST_ECHO_TOTAL || mirror_sink.total != TEST_ECHO_TOTAL, return -1);
+    eh_close(in_sv[0]);
+    eh_close(in_sv[1]);
+    eh_close(out_sv[1]);
+    eh_close(pipe_fds[0]);
+    eh_close(pipe_fds[1]);
+    eh_close(mirror_fds[0]);
+    return 0;
+}
+
+int task_app(void *arg){
+    (void) arg;
+    EH_DBG_ERROR_EXEC(test_pipe() < 0, return -1);
+    eh_debugfl("test fd pipe Pass");
+    EH_DBG_ERROR_EXEC(test_fd_reuse() < 0, return -1);
+    eh_debugfl("test fd reuse Pass");
+    EH_DBG_ERROR_EXEC(test_tcp_echo() < 0, return -1);
+    eh_debugfl("test fd tcp echo Pass");
+    EH_DBG_ERROR_EXEC(test_pingpong() < 0, return -1);
+    eh_debugfl("test fd pingpong Pass");
+    EH_DBG_ERROR_EXEC(test_sendfile() < 0, return -1);
+    eh_debugfl("test fd sendfile Pass");
+    EH_DBG_ERROR_EXEC(test_splice_tee() < 0, return -1);
+    eh_debugfl("test fd splice tee Pass");
+    return 0;
+}
+
+int main(void){
+    int ret;
+    eh_global_init();
+    ret = task_app("task_app");
+    eh_global_exit();
+    return ret;
+}
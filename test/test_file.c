@@ -0,0 +1,161 @@
+/**
+ * @file test_file.c
+ * @brief 普通文件异步IO测试，小块追加写的合并和顺序小块读的预读
+ * @author simon.xiaoapeng (simon.xiaoapeng@gmail.com)
+ * @version 1.0
+ * @date 2024-09-06
+ *
+ * @copyright Copyright (c) 2024  simon.xiaoapeng@gmail.com
+ *
+ * @par 修改日志:
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "eh.h"
+#include "eh_debug.h"
+#include "eh_event.h"
+#include "eh_platform.h"
+#include "eh_timer.h"
+#include "eh_sleep.h"
+#include "eh_file.h"
+
+#define TEST_FILE_PATH          "/tmp/eh_file_test.tmp"
+#define TEST_RECORD_SIZE        100
+#define TEST_RECORD_CNT         20000
+#define TEST_BUF_SIZE           (64*1024)
+
+void stdout_write(void *stream, const uint8_t *buf, size_t size){
+    (void)stream;
+    printf("%.*s", (int)size, (const char*)buf);
+}
+
+static void test_record(uint8_t *record, int i){
+    for(int j = 0; j < TEST_RECORD_SIZE; j++)
+        record[j] = (uint8_t)(i + j);
+}
+
+/**
+ * @brief                           追加TEST_RECORD_CNT条记录，coalesce为0时每次写都是一次IO
+ */
+static int write_records(size_t coalesce, eh_usec_t *usec, struct eh_file_stat *stat){
+    uint8_t record[TEST_RECORD_SIZE];
+    eh_file_t *file;
+    eh_clock_t start;
+
+    file = __await__ eh_file_open(TEST_FILE_PATH, O_RDWR | O_CREAT | O_TRUNC, 0600);
+    EH_DBG_ERROR_EXEC(eh_ptr_to_error(file) < 0, return -1);
+    EH_DBG_ERROR_EXEC(eh_file_set_write_coalesce(file, coalesce) < 0, return -1);
+    start = eh_get_clock_monotonic_time();
+    for(int i = 0; i < TEST_RECORD_CNT; i++){
+        test_record(record, i);
+        EH_DBG_ERROR_EXEC(__await__ eh_file_write(file, record, sizeof(record)) != sizeof(record), return -1);
+    }
+    EH_DBG_ERROR_EXEC(__await__ eh_file_flush(file) < 0, return -1);
+    *usec = eh_clock_to_usec(eh_get_clock_monotonic_time() - start);
+    eh_file_get_stat(file, stat);
+    EH_DBG_ERROR_EXEC(__await__ eh_file_fsync(file) < 0, return -1);
+    EH_DBG_ERROR_EXEC(__await__ eh_file_close(file) < 0, return -1);
+    return 0;
+}
+
+static int test_write_coalesce(void){
+    struct eh_file_stat plain_stat, coalesce_stat;
+    eh_usec_t plain_usec, coalesce_usec;
+
+    EH_DBG_ERROR_EXEC(write_records(0, &plain_usec, &plain_stat) < 0, return -1);
+    EH_DBG_ERROR_EXEC(plain_stat.write_io != TEST_RECORD_CNT || plain_stat.write_merged != 0, return -1);
+    EH_DBG_ERROR_EXEC(write_records(TEST_BUF_SIZE, &coalesce_usec, &coalesce_stat) < 0, return -1);
+    EH_DBG_ERROR_EXEC(coalesce_stat.write_io > (uint64_t)TEST_RECORD_CNT * TEST_RECORD_SIZE / TEST_BUF_SIZE + 1, return -1);
+    eh_infofl("%d x %d byte appends: %llu writes in %llu us, coalesced %llu writes in %llu us",
+        TEST_RECORD_CNT, TEST_RECORD_SIZE,
+        (unsigned long long)plain_stat.write_io, (unsigned long long)plain_usec,
+        (unsigned long long)coalesce_stat.write_io, (unsigned long long)coalesce_usec);
+    return 0;
+}
+
+static int test_readahead(void){
+    uint8_t record[TEST_RECORD_SIZE], expect[TEST_RECORD_SIZE];
+    struct eh_file_stat stat;
+    eh_file_t *file;
+    eh_clock_t start;
+    int i;
+
+    file = __await__ eh_file_open(TEST_FILE_PATH, O_RDONLY, 0);
+    EH_DBG_ERROR_EXEC(eh_ptr_to_error(file) < 0, return -1);
+    EH_DBG_ERROR_EXEC(eh_file_set_readahead(file, TEST_BUF_SIZE) < 0, return -1);
+    start = eh_get_clock_monotonic_time();
+    for(i = 0; i < TEST_RECORD_CNT; i++){
+        EH_DBG_ERROR_EXEC(__await__ eh_file_read(file, record, sizeof(record)) != sizeof(record), return -1);
+        test_record(expect, i);
+        EH_DBG_ERROR_EXEC(memcmp(record, expect, sizeof(record)) != 0, return -1);
+    }
+    EH_DBG_ERROR_EXEC(__await__ eh_file_read(file, record, sizeof(record)) != 0, return -1);
+    eh_file_get_stat(file, &stat);
+    eh_infofl("%d x %d byte sequential reads: %llu reads, %llu readahead hits in %llu us",
+        TEST_RECORD_CNT, TEST_RECORD_SIZE, (unsigned long long)stat.read_io, (unsigned long long)stat.readahead_hit,
+        (unsigned long long)eh_clock_to_usec(eh_get_clock_monotonic_time() - start));
+    EH_DBG_ERROR_EXEC(stat.read_io > (uint64_t)TEST_RECORD_CNT * TEST_RECORD_SIZE / TEST_BUF_SIZE + 2, return -1);
+
+    /* 随机读不经过预读缓冲区 */
+    for(i = TEST_RECORD_CNT - 1; i >= 0; i -= 997){
+        EH_DBG_ERROR_EXEC(__await__ eh_file_pread(file, record, sizeof(record), (off_t)i * TEST_RECORD_SIZE) != sizeof(record), return -1);
+        test_record(expect, i);
+        EH_DBG_ERROR_EXEC(memcmp(record, expect, sizeof(record)) != 0, return -1);
+    }
+    EH_DBG_ERROR_EXEC(__await__ eh_file_close(file) < 0, return -1);
+    return 0;
+}
+
+/* 不相邻的写先写出缓冲区，读之前写出缓冲区，写使预读缓冲区失效 */
+static int test_consistency(void){
+    struct eh_file_stat stat;
+    eh_file_t *file;
+    char buf[8];
+
+    file = __await__ eh_file_open("/nonexistent/eh_file", O_RDONLY, 0);
+    EH_DBG_ERROR_EXEC(eh_ptr_to_error(file) >= 0 || errno != ENOENT, return -1);
+
+    file = __await__ eh_file_open(TEST_FILE_PATH, O_RDWR | O_CREAT | O_TRUNC, 0600);
+    EH_DBG_ERROR_EXEC(eh_ptr_to_error(file) < 0, return -1);
+    EH_DBG_ERROR_EXEC(eh_file_set_write_coalesce(file, 1024) < 0, return -1);
+    EH_DBG_ERROR_EXEC(eh_file_set_readahead(file, 1024) < 0, return -1);
+    EH_DBG_ERROR_EXEC(__await__ eh_file_pwrite(file, "abcd", 4, 0) != 4, return -1);
+    EH_DBG_ERROR_EXEC(__await__ eh_file_pwrite(file, "efgh", 4, 4) != 4, return -1);
+    eh_file_get_stat(file, &stat);
+    EH_DBG_ERROR_EXEC(stat.write_io != 0 || stat.write_merged != 1, return -1);
+    EH_DBG_ERROR_EXEC(eh_file_set_write_coalesce(file, 0) != EH_RET_BUSY, return -1);
+    EH_DBG_ERROR_EXEC(__await__ eh_file_pwrite(file, "x", 1, 100) != 1, return -1);
+    eh_file_get_stat(file, &stat);
+    EH_DBG_ERROR_EXEC(stat.write_io != 1, return -1);
+
+    EH_DBG_ERROR_EXEC(__await__ eh_file_pread(file, buf, 8, 0) != 8 || memcmp(buf, "abcdefgh", 8) != 0, return -1);
+    EH_DBG_ERROR_EXEC(__await__ eh_file_pwrite(file, "XY", 2, 2) != 2, return -1);
+    EH_DBG_ERROR_EXEC(__await__ eh_file_pread(file, buf, 8, 0) != 8 || memcmp(buf, "abXYefgh", 8) != 0, return -1);
+    EH_DBG_ERROR_EXEC(__await__ eh_file_pread(file, buf, 1, 100) != 1 || buf[0] != 'x', return -1);
+    EH_DBG_ERROR_EXEC(__await__ eh_file_close(file) < 0, return -1);
+    unlink(TEST_FILE_PATH);
+    return 0;
+}
+
+int task_app(void *arg){
+    (void) arg;
+    EH_DBG_ERROR_EXEC(test_write_coalesce() < 0, return -1);
+    eh_debugfl("test file write coalesce Pass");
+    EH_DBG_ERROR_EXEC(test_readahead() < 0, return -1);
+    eh_debugfl("test file readahead Pass");
+    EH_DBG_ERROR_EXEC(test_consistency() < 0, return -1);
+    eh_debugfl("test file consistency Pass");
+    return 0;
+}
+
+int main(void){
+    int ret;
+    eh_global_init();
+    ret = task_app("task_app");
+    eh_global_exit();
+    return ret;
+}
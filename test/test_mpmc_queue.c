@@ -0,0 +1,228 @@
+/**
+ * @file test_mpmc_queue.c
+ * @brief 多生产者多消费者无锁队列测试
+ * @author simon.xiaoapeng (simon.xiaoapeng@gmail.com)
+ * @version 1.0
+ * @date 2024-08-06
+ * 
+ * @copyright Copyright (c) 2024  simon.xiaoapeng@gmail.com
+ * 
+ * @par 修改日志:
+ */
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "eh.h"
+#include "eh_error.h"
+#include "eh_debug.h"
+#include "eh_event.h"
+#include "eh_timer.h"
+#include "eh_types.h"
+#include "eh_mpmc_queue.h"
+
+#define TEST_PRODUCER_CNT           4
+#define TEST_MSG_CNT_PER_PRODUCER   100000
+#define TEST_TOTAL_MSG_CNT          (TEST_PRODUCER_CNT * TEST_MSG_CNT_PER_PRODUCER)
+#define TEST_WAIT_CONSUMER_CNT      4
+#define TEST_STOP_SEQ               0xFFFFFFFFU
+
+struct test_msg{
+    uint32_t    producer;
+    uint32_t    seq;
+};
+
+static eh_mpmc_queue_t *queue;
+static atomic_uint      pop_cnt;
+static atomic_ullong    pop_seq_sum;
+
+void stdout_write(void *stream, const uint8_t *buf, size_t size){
+    (void)stream;
+    printf("%.*s", (int)size, (const char*)buf);
+}
+
+static void* thread_producer(void *arg){
+    struct test_msg msg;
+    msg.producer = (uint32_t)(uintptr_t)arg;
+    for(uint32_t i = 0; i < TEST_MSG_CNT_PER_PRODUCER; ){
+        msg.seq = i;
+        if(eh_mpmc_queue_push(queue, &msg) != EH_RET_OK){
+            sched_yield();
+            continue;
+        }
+        i++;
+    }
+    return NULL;
+}
+
+static void* thread_consumer(void *arg){
+    struct test_msg msg;
+    (void) arg;
+    while(atomic_load(&pop_cnt) < TEST_TOTAL_MSG_CNT){
+        if(eh_mpmc_queue_pop(queue, &msg) != EH_RET_OK){
+            sched_yield();
+            continue;
+        }
+        atomic_fetch_add(&pop_seq_sum, msg.seq);
+        atomic_fetch_add(&pop_cnt, 1);
+    }
+    return NULL;
+}
+
+static int task_consumer(void *arg){
+    struct test_msg msg;
+    int ret;
+    uint32_t cnt = 0;
+    while(atomic_load(&pop_cnt) < TEST_TOTAL_MSG_CNT){
+        ret = __await__ eh_mpmc_queue_pop_wait(queue, &msg, (eh_sclock_t)eh_msec_to_clock(100));
+        if(ret == EH_RET_TIMEOUT)
+            continue;
+        if(ret < 0)
+            return ret;
+        atomic_fetch_add(&pop_seq_sum, msg.seq);
+        atomic_fetch_add(&pop_cnt, 1);
+        cnt++;
+    }
+    eh_debugfl("%s pop %u", arg, cnt);
+    return 0;
+}
+
+/* 非等待消费者，只消费前一半，之后的元素只能由永久等待的协程取走 */
+static void* thread_half_consumer(void *arg){
+    struct test_msg msg;
+    (void) arg;
+    while(atomic_load(&pop_cnt) < TEST_TOTAL_MSG_CNT / 2){
+        if(eh_mpmc_queue_pop(queue, &msg) != EH_RET_OK){
+            sched_yield();
+            continue;
+        }
+        if(msg.seq == TEST_STOP_SEQ){
+            eh_mpmc_queue_push(queue, &msg);
+            break;
+        }
+        atomic_fetch_add(&pop_seq_sum, msg.seq);
+        atomic_fetch_add(&pop_cnt, 1);
+    }
+    return NULL;
+}
+
+/**
+ * @brief                   没有超时兜底，丢失唤醒时队列中还有元素而所有协程都在睡眠，
+ *                          3秒内没有等到任何元素就认为唤醒丢失
+ */
+static int task_wait_consumer(void *arg){
+    struct test_msg msg;
+    int ret;
+    (void) arg;
+    for(;;){
+        ret = __await__ eh_mpmc_queue_pop_wait(queue, &msg, (eh_sclock_t)eh_msec_to_clock(3000));
+        if(ret < 0){
+            eh_errfl("pop_wait %d at %u/%u", ret, atomic_load(&pop_cnt), TEST_TOTAL_MSG_CNT);
+            return ret;
+        }
+        if(msg.seq == TEST_STOP_SEQ)
+            return 0;
+        atomic_fetch_add(&pop_seq_sum, msg.seq);
+        /* 最后一个元素的消费者通知其他等待者退出 */
+        if(atomic_fetch_add(&pop_cnt, 1) + 1 == TEST_TOTAL_MSG_CNT){
+            msg.seq = TEST_STOP_SEQ;
+            for(int i = 0; i < TEST_WAIT_CONSUMER_CNT; i++)
+                EH_DBG_ERROR_EXEC(eh_mpmc_queue_push(queue, &msg) != EH_RET_OK, return -1);
+            return 0;
+        }
+    }
+}
+
+int task_app(void *arg){
+    pthread_t producer[TEST_PRODUCER_CNT];
+    pthread_t consumer;
+    eh_task_t *task_1, *task_2;
+    eh_task_t *wait_consumers[TEST_WAIT_CONSUMER_CNT];
+    struct test_msg msg;
+    unsigned long long expect_sum;
+    int ret, app_ret;
+    (void) arg;
+
+    EH_DBG_ERROR_EXEC(eh_ptr_to_error(eh_mpmc_queue_create(3, sizeof(struct test_msg))) != EH_RET_INVALID_PARAM, return -1);
+    queue = eh_mpmc_queue_create(64, sizeof(struct test_msg));
+    EH_DBG_ERROR_EXEC(eh_ptr_to_error(queue) < 0, return -1);
+
+    /* 用例1 单线程满/空状态 */
+    EH_DBG_ERROR_EXEC(eh_mpmc_queue_pop(queue, &msg) != EH_RET_TIMEOUT, return -1);
+    EH_DBG_ERROR_EXEC(eh_mpmc_queue_pop_wait(queue, &msg, 0) != EH_RET_TIMEOUT, return -1);
+    for(uint32_t i = 0; i < 64; i++){
+        msg.producer = 0;
+        msg.seq = i;
+        EH_DBG_ERROR_EXEC(eh_mpmc_queue_push(queue, &msg) != EH_RET_OK, return -1);
+    }
+    EH_DBG_ERROR_EXEC(eh_mpmc_queue_push(queue, &msg) != EH_RET_BUSY, return -1);
+    for(uint32_t i = 0; i < 64; i++){
+        EH_DBG_ERROR_EXEC(eh_mpmc_queue_pop_wait(queue, &msg, EH_TIME_FOREVER) != EH_RET_OK, return -1);
+        EH_DBG_ERROR_EXEC(msg.seq != i, return -1);
+    }
+    EH_DBG_ERROR_EXEC(eh_mpmc_queue_pop(queue, &msg) != EH_RET_TIMEOUT, return -1);
+    eh_debugfl("test single thread Pass");
+
+    /* 用例2 多线程生产，线程与协程同时消费 */
+    atomic_init(&pop_cnt, 0);
+    atomic_init(&pop_seq_sum, 0);
+    task_1 = eh_task_create("consumer_1", 0, 12*1024, "consumer_1", task_consumer);
+    task_2 = eh_task_create("consumer_2", 0, 12*1024, "consumer_2", task_consumer);
+    pthread_create(&consumer, NULL, thread_consumer, NULL);
+    for(uintptr_t i = 0; i < TEST_PRODUCER_CNT; i++)
+        pthread_create(&producer[i], NULL, thread_producer, (void*)i);
+
+    ret = __await__ eh_task_join(task_1, &app_ret, EH_TIME_FOREVER);
+    EH_DBG_ERROR_EXEC(ret < 0 || app_ret < 0, return -1);
+    ret = __await__ eh_task_join(task_2, &app_ret, EH_TIME_FOREVER);
+    EH_DBG_ERROR_EXEC(ret < 0 || app_ret < 0, return -1);
+    for(int i = 0; i < TEST_PRODUCER_CNT; i++)
+        pthread_join(producer[i], NULL);
+    pthread_join(consumer, NULL);
+
+    expect_sum = (unsigned long long)TEST_PRODUCER_CNT * 
+        ((unsigned long long)TEST_MSG_CNT_PER_PRODUCER * (TEST_MSG_CNT_PER_PRODUCER - 1) / 2);
+    EH_DBG_ERROR_EXEC(atomic_load(&pop_cnt) != TEST_TOTAL_MSG_CNT, return -1);
+    EH_DBG_ERROR_EXEC(atomic_load(&pop_seq_sum) != expect_sum, return -1);
+    EH_DBG_ERROR_EXEC(eh_mpmc_queue_pop(queue, &msg) != EH_RET_TIMEOUT, return -1);
+    eh_debugfl("test multi thread Pass");
+
+    /* 用例3 多个协程永久等待，与非等待的线程消费者竞争，不能丢失唤醒 */
+    atomic_store(&pop_cnt, 0);
+    atomic_store(&pop_seq_sum, 0);
+    for(int i = 0; i < TEST_WAIT_CONSUMER_CNT; i++){
+        wait_consumers[i] = eh_task_create("wait_consumer", 0, 12*1024, NULL, task_wait_consumer);
+        EH_DBG_ERROR_EXEC(eh_ptr_to_error(wait_consumers[i]) < 0, return -1);
+    }
+    pthread_create(&consumer, NULL, thread_half_consumer, NULL);
+    for(uintptr_t i = 0; i < TEST_PRODUCER_CNT; i++)
+        pthread_create(&producer[i], NULL, thread_producer, (void*)i);
+    for(int i = 0; i < TEST_WAIT_CONSUMER_CNT; i++){
+        ret = __await__ eh_task_join(wait_consumers[i], &app_ret, EH_TIME_FOREVER);
+        EH_DBG_ERROR_EXEC(ret < 0 || app_ret < 0, return -1);
+    }
+    for(int i = 0; i < TEST_PRODUCER_CNT; i++)
+        pthread_join(producer[i], NULL);
+    pthread_join(consumer, NULL);
+    EH_DBG_ERROR_EXEC(atomic_load(&pop_cnt) != TEST_TOTAL_MSG_CNT, return -1);
+    EH_DBG_ERROR_EXEC(atomic_load(&pop_seq_sum) != expect_sum, return -1);
+    /* 线程消费者可能放回了一个结束标记 */
+    while(eh_mpmc_queue_pop(queue, &msg) == EH_RET_OK)
+        EH_DBG_ERROR_EXEC(msg.seq != TEST_STOP_SEQ, return -1);
+    eh_debugfl("test multi waiter Pass");
+
+    eh_mpmc_queue_destroy(queue);
+    return 0;
+}
+
+int main(void){
+    int ret;
+    eh_debugfl("test_mpmc_queue start!!");
+    eh_global_init();
+    ret = task_app("task_app");
+    eh_global_exit();
+    return ret;
+}
@@ -0,0 +1,208 @@
+/**
+ * @file test_msgring.c
+ * @brief 消息环测试
+ * @author simon.xiaoapeng (simon.xiaoapeng@gmail.com)
+ * @version 1.0
+ * @date 2024-08-04
+ * 
+ * @copyright Copyright (c) 2024  simon.xiaoapeng@gmail.com
+ * 
+ * @par 修改日志:
+ */
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sched.h>
+#include "eh.h"
+#include "eh_error.h"
+#include "eh_debug.h"
+#include "eh_types.h"
+#include "eh_msgring.h"
+
+#define TEST_RING_SIZE      256
+#define TEST_THREAD_MSG_CNT 100000
+
+void stdout_write(void *stream, const uint8_t *buf, size_t size){
+    (void)stream;
+    printf("%.*s", (int)size, (const char*)buf);
+}
+
+static void test_msg_fill(uint8_t *buf, int32_t len, uint8_t seq){
+    for(int32_t i = 0; i < len; i++)
+        buf[i] = (uint8_t)(seq + i);
+}
+
+static int test_msg_check(const uint8_t *buf, int32_t len, uint8_t seq){
+    for(int32_t i = 0; i < len; i++){
+        if(buf[i] != (uint8_t)(seq + i))
+            return -1;
+    }
+    return 0;
+}
+
+int test_basics_interface(void){
+    eh_msgring_t *msgring;
+    eh_msgring_msg_t msgs[8];
+    uint8_t buf[TEST_RING_SIZE];
+    uint8_t *wbuf;
+    const uint8_t *rbuf;
+    int32_t len;
+
+    EH_DBG_ERROR_EXEC(eh_ptr_to_error(eh_msgring_create(TEST_RING_SIZE + 1, NULL)) != EH_RET_INVALID_PARAM, return -1);
+    msgring = eh_msgring_create(TEST_RING_SIZE, NULL);
+    EH_DBG_ERROR_EXEC(eh_ptr_to_error(msgring) < 0, return -1);
+
+    /* 用例1 空环 */
+    EH_DBG_ERROR_EXEC(!eh_msgring_is_empty(msgring), return -1);
+    EH_DBG_ERROR_EXEC(eh_msgring_peek(msgring, &len) != NULL, return -1);
+    EH_DBG_ERROR_EXEC(eh_msgring_read(msgring, buf, sizeof(buf)) != EH_RET_TIMEOUT, return -1);
+
+    /* 用例2 最大消息为环的一半，两条最大消息正好占满整个环 */
+    EH_DBG_ERROR_EXEC(eh_msgring_msg_max_size(msgring) != TEST_RING_SIZE / 2 - EH_MSGRING_ALIGN, return -1);
+    EH_DBG_ERROR_EXEC(eh_msgring_push(msgring, buf, TEST_RING_SIZE) != EH_RET_INVALID_PARAM, return -1);
+    EH_DBG_ERROR_EXEC(eh_msgring_push(msgring, buf, eh_msgring_msg_max_size(msgring) + 1) != EH_RET_INVALID_PARAM, return -1);
+    EH_DBG_ERROR_EXEC(eh_msgring_push(msgring, buf, eh_msgring_msg_max_size(msgring)) != EH_RET_OK, return -1);
+    EH_DBG_ERROR_EXEC(eh_msgring_push(msgring, buf, eh_msgring_msg_max_size(msgring)) != EH_RET_OK, return -1);
+    EH_DBG_ERROR_EXEC(eh_msgring_push(msgring, buf, 0) != EH_RET_BUSY, return -1);
+    EH_DBG_ERROR_EXEC(eh_msgring_pop_batch(msgring, 2) != 2, return -1);
+
+    /* 用例3 单条写读,包括0长度消息 */
+    test_msg_fill(buf, 10, 1);
+    EH_DBG_ERROR_EXEC(eh_msgring_push(msgring, buf, 10) != EH_RET_OK, return -1);
+    EH_DBG_ERROR_EXEC(eh_msgring_push(msgring, buf, 0) != EH_RET_OK, return -1);
+    rbuf = eh_msgring_peek(msgring, &len);
+    EH_DBG_ERROR_EXEC(rbuf == NULL || len != 10 || test_msg_check(rbuf, len, 1), return -1);
+    EH_DBG_ERROR_EXEC(eh_msgring_pop(msgring) != 1, return -1);
+    EH_DBG_ERROR_EXEC(eh_msgring_read(msgring, buf, sizeof(buf)) != 0, return -1);
+    EH_DBG_ERROR_EXEC(!eh_msgring_is_empty(msgring), return -1);
+
+    /* 用例4 消息不在绕回处拆分 */
+    test_msg_fill(buf, 200, 4);
+    EH_DBG_ERROR_EXEC(eh_msgring_push(msgring, buf, 20) != EH_RET_OK, return -1);
+    EH_DBG_ERROR_EXEC(eh_msgring_push(msgring, buf, 100) != EH_RET_OK, return -1);
+    EH_DBG_ERROR_EXEC(eh_msgring_pop(msgring) != 1, return -1);
+    /* 写位置在环的中间，尾部只剩52字节，头部被未读的消息挡住只有44字节，读空后才能写入 */
+    EH_DBG_ERROR_EXEC(eh_msgring_push(msgring, buf, 50) != EH_RET_OK, return -1);
+    EH_DBG_ERROR_EXEC(eh_msgring_push(msgring, buf, 100) != EH_RET_BUSY, return -1);
+    EH_DBG_ERROR_EXEC(eh_msgring_pop_batch(msgring, 2) != 2, return -1);
+    EH_DBG_ERROR_EXEC(eh_msgring_push(msgring, buf, 100) != EH_RET_OK, return -1);
+    rbuf = eh_msgring_peek(msgring, &len);
+    EH_DBG_ERROR_EXEC(rbuf == NULL || len != 100 || test_msg_check(rbuf, len, 4), return -1);
+    EH_DBG_ERROR_EXEC(eh_msgring_pop(msgring) != 1, return -1);
+
+    /*
+     * 每轮前进132字节，64轮走遍所有对齐的位置，读写位置停在任何位置时，环读空后都能写入最大消息，
+     * 3/4环大的消息直接被拒绝，不会永远忙
+     */
+    for(int32_t step = 0; step < TEST_RING_SIZE; step += EH_MSGRING_ALIGN){
+        EH_DBG_ERROR_EXEC(eh_msgring_push(msgring, buf, TEST_RING_SIZE * 3 / 4) != EH_RET_INVALID_PARAM, return -1);
+        EH_DBG_ERROR_EXEC(eh_msgring_push(msgring, buf, eh_msgring_msg_max_size(msgring)) != EH_RET_OK, return -1);
+        rbuf = eh_msgring_peek(msgring, &len);
+        EH_DBG_ERROR_EXEC(rbuf == NULL || len != eh_msgring_msg_max_size(msgring) || test_msg_check(rbuf, len, 4), return -1);
+        EH_DBG_ERROR_EXEC(eh_msgring_pop(msgring) != 1, return -1);
+        EH_DBG_ERROR_EXEC(eh_msgring_push(msgring, buf, 0) != EH_RET_OK, return -1);
+        EH_DBG_ERROR_EXEC(eh_msgring_pop(msgring) != 1, return -1);
+    }
+
+    /* 用例5 预留/提交方式原地写入，批量读取 */
+    for(int i = 0; i < 6; i++){
+        wbuf = eh_msgring_push_reserve(msgring, i * 7);
+        EH_DBG_ERROR_EXEC(wbuf == NULL, return -1);
+        test_msg_fill(wbuf, i * 7, (uint8_t)i);
+        EH_DBG_ERROR_EXEC(eh_msgring_push_commit(msgring) != EH_RET_OK, return -1);
+    }
+    EH_DBG_ERROR_EXEC(eh_msgring_push_commit(msgring) != EH_RET_INVALID_STATE, return -1);
+    EH_DBG_ERROR_EXEC(eh_msgring_peek_batch(msgring, msgs, 8) != 6, return -1);
+    for(int i = 0; i < 6; i++){
+        EH_DBG_ERROR_EXEC(msgs[i].len != i * 7 || test_msg_check(msgs[i].buf, msgs[i].len, (uint8_t)i), return -1);
+    }
+    EH_DBG_ERROR_EXEC(eh_msgring_pop_batch(msgring, 4) != 4, return -1);
+    EH_DBG_ERROR_EXEC(eh_msgring_pop_batch(msgring, 8) != 2, return -1);
+    EH_DBG_ERROR_EXEC(!eh_msgring_is_empty(msgring), return -1);
+
+    eh_msgring_destroy(msgring);
+    return 0;
+}
+
+struct thread_wr{
+    eh_msgring_t    *msgring;
+    int             cnt;
+};
+
+static void* thread_test_writer(void *arg){
+    struct thread_wr *wr = (struct thread_wr *)arg;
+    uint8_t *wbuf;
+    int32_t len;
+    for(int i = 0; i < wr->cnt; ){
+        len = rand() % 64;
+        wbuf = eh_msgring_push_reserve(wr->msgring, len);
+        if(wbuf == NULL){
+            sched_yield();
+            continue;
+        }
+        test_msg_fill(wbuf, len, (uint8_t)i);
+        eh_msgring_push_commit(wr->msgring);
+        i++;
+    }
+    return NULL;
+}
+
+int test_thread_wr(void){
+    struct thread_wr wr;
+    eh_msgring_msg_t msgs[8];
+    pthread_t thread_id;
+    int ret = 0, n, seq = 0;
+
+    wr.cnt = TEST_THREAD_MSG_CNT;
+    wr.msgring = eh_msgring_create(TEST_RING_SIZE, NULL);
+    EH_DBG_ERROR_EXEC(eh_ptr_to_error(wr.msgring) < 0, return -1);
+    EH_DBG_ERROR_EXEC(pthread_create(&thread_id, NULL, thread_test_writer, &wr) != 0, return -1);
+    while(seq < wr.cnt){
+        n = eh_msgring_peek_batch(wr.msgring, msgs, 8);
+        if(n == 0){
+            /* 环为空时让出CPU，单核机器上忙等会饿死写线程 */
+            sched_yield();
+            continue;
+        }
+        for(int i = 0; i < n; i++, seq++){
+            if(test_msg_check(msgs[i].buf, msgs[i].len, (uint8_t)seq)){
+                ret = -1;
+                eh_errfl("msg %d check error", seq);
+                break;
+            }
+        }
+        if(ret < 0)
+            break;
+        eh_msgring_pop_batch(wr.msgring, n);
+    }
+    pthread_join(thread_id, NULL);
+    eh_msgring_destroy(wr.msgring);
+    return ret;
+}
+
+int task_app(void *arg){
+    (void) arg;
+    if(test_basics_interface()){
+        eh_errfl("test_basics_interface Fail");
+        return -1;
+    }
+    eh_debugfl("test_basics_interface Pass");
+    if(test_thread_wr()){
+        eh_errfl("test_thread_wr Fail");
+        return -1;
+    }
+    eh_debugfl("test_thread_wr Pass");
+    return 0;
+}
+
+int main(void){
+    int ret;
+    eh_debugfl("test_msgring start!!");
+    eh_global_init();
+    ret = task_app("task_app");
+    eh_global_exit();
+    return ret;
+}
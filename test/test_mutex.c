@@ -76,6 +76,59 @@ int task_test_1(void *arg){
     return 1;
 }
 
+#define BENCH_LOOP_CNT  100000
+static eh_mutex_t bench_mutex;
+static eh_task_t *bench_owner;
+static int bench_streak, bench_max_streak;
+
+int task_bench(void *arg){
+    int ret;
+    (void) arg;
+    for(int i = 0; i < BENCH_LOOP_CNT; i++){
+        ret = __await__ eh_mutex_lock(bench_mutex, EH_TIME_FOREVER);
+        EH_DBG_ERROR_EXEC(ret < 0, return ret);
+        /* 统计同一任务连续拿到锁的最大次数，用来观察锁的公平性 */
+        if(bench_owner == eh_task_self()){
+            bench_streak++;
+        }else{
+            bench_owner = eh_task_self();
+            bench_streak = 1;
+        }
+        if(bench_streak > bench_max_streak)
+            bench_max_streak = bench_streak;
+        /* 持锁让出CPU，另一个任务必然阻塞在锁上，每次解锁都是一次移交 */
+        __await__ eh_task_yield();
+        eh_mutex_unlock(bench_mutex);
+    }
+    return 0;
+}
+
+static int mutex_bench(void){
+    eh_task_t *bench_1,*bench_2;
+    eh_clock_t start, end;
+    eh_usec_t usec;
+    int app_ret;
+
+    bench_mutex = eh_mutex_create(EH_MUTEX_TYPE_NORMAL);
+    EH_DBG_ERROR_EXEC(eh_ptr_to_error(bench_mutex) < 0, return -1);
+    start = eh_get_clock_monotonic_time();
+    bench_1 = eh_task_create("bench_1", 0, 4*1024, NULL, task_bench);
+    bench_2 = eh_task_create("bench_2", 0, 4*1024, NULL, task_bench);
+    __await__ eh_task_join(bench_1, &app_ret, EH_TIME_FOREVER);
+    EH_DBG_ERROR_EXEC(app_ret < 0, return -1);
+    __await__ eh_task_join(bench_2, &app_ret, EH_TIME_FOREVER);
+    EH_DBG_ERROR_EXEC(app_ret < 0, return -1);
+    end = eh_get_clock_monotonic_time();
+    eh_mutex_destroy(bench_mutex);
+
+    usec = eh_clock_to_usec(end - start);
+    if(usec == 0) usec = 1;
+    eh_infofl("mutex ping-pong: %d lock/unlock in %llu us, %llu ops/s, max streak %d",
+        2 * BENCH_LOOP_CNT, (unsigned long long)usec, (unsigned long long)(2ULL * BENCH_LOOP_CNT * 1000000 / usec),
+        bench_max_streak);
+    return 0;
+}
+
 
 int task_app(void *arg){
     eh_task_t *test_1,*test_2;
@@ -95,6 +148,9 @@ int task_app(void *arg){
     eh_debugfl("test_2: ret=%d app_ret=%d", ret, app_ret);
 
     eh_mutex_destroy(sem);
+
+    EH_DBG_ERROR_EXEC(mutex_bench() < 0, return -1);
+    eh_debugfl("mutex bench Pass");
     return 0;
 }
 
@@ -0,0 +1,160 @@
+/**
+ * @file test_offload.c
+ * @brief 阻塞调用线程池测试
+ * @author simon.xiaoapeng (simon.xiaoapeng@gmail.com)
+ * @version 1.0
+ * @date 2024-08-30
+ *
+ * @copyright Copyright (c) 2024  simon.xiaoapeng@gmail.com
+ *
+ * @par 修改日志:
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "eh.h"
+#include "eh_debug.h"
+#include "eh_event.h"
+#include "eh_platform.h"
+#include "eh_timer.h"
+#include "eh_sleep.h"
+#include "eh_offload.h"
+
+#define TEST_BENCH_JOB_CNT      2000
+#define TEST_BENCH_ROUNDS       5
+
+static int tick_cnt;
+static bool tick_stop;
+static eh_offload_t *bench_jobs[TEST_BENCH_JOB_CNT];
+
+void stdout_write(void *stream, const uint8_t *buf, size_t size){
+    (void)stream;
+    printf("%.*s", (int)size, (const char*)buf);
+}
+
+static intptr_t job_sleep(void *arg){
+    usleep((useconds_t)(intptr_t)arg);
+    return 42;
+}
+
+static intptr_t job_open_missing(void *arg){
+    (void)arg;
+    return open("/nonexistent/eh_offload", O_RDONLY);
+}
+
+static intptr_t job_fsync(void *arg){
+    const char *path = (const char *)arg;
+    char buf[4096];
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+    if(fd < 0)
+        return -1;
+    memset(buf, 0x5a, sizeof(buf));
+    for(int i = 0; i < 256; i++){
+        if(write(fd, buf, sizeof(buf)) != sizeof(buf))
+            break;
+    }
+    fsync(fd);
+    close(fd);
+    unlink(path);
+    return 0;
+}
+
+static intptr_t job_add(void *arg){
+    return (intptr_t)arg + 1;
+}
+
+static int task_ticker(void *arg){
+    (void)arg;
+    while(!tick_stop){
+        __await__ eh_usleep(1000);
+        tick_cnt++;
+    }
+    return 0;
+}
+
+/* 阻塞调用执行期间，其他协程继续运行 */
+static int test_basic(void){
+    eh_task_t *ticker;
+    eh_offload_t *job;
+    intptr_t result;
+    int ret;
+
+    tick_cnt = 0;
+    tick_stop = false;
+    ticker = eh_task_create("ticker", 0, 12*1024, NULL, task_ticker);
+    EH_DBG_ERROR_EXEC(eh_ptr_to_error(ticker) < 0, return -1);
+    EH_DBG_ERROR_EXEC(__await__ eh_offload_call(job_sleep, (void*)(intptr_t)50000, &result) < 0 || result != 42, return -1);
+    eh_infofl("50ms blocking call, ticker ran %d times", tick_cnt);
+    EH_DBG_ERROR_EXEC(tick_cnt < 20, return -1);
+
+    tick_cnt = 0;
+    EH_DBG_ERROR_EXEC(__await__ eh_offload_call(job_fsync, "/tmp/eh_offload_fsync.tmp", &result) < 0 || result != 0, return -1);
+    eh_infofl("1MB write+fsync, ticker ran %d times", tick_cnt);
+
+    /* errno从工作线程带回 */
+    EH_DBG_ERROR_EXEC(__await__ eh_offload_call(job_open_missing, NULL, &result) < 0, return -1);
+    EH_DBG_ERROR_EXEC(result != -1 || errno != ENOENT, return -1);
+
+    /* 超时后任务依然有效 */
+    job = eh_offload_submit(job_sleep, (void*)(intptr_t)30000);
+    EH_DBG_ERROR_EXEC(eh_ptr_to_error(job) < 0, return -1);
+    ret = __await__ eh_offload_wait(job, &result, (eh_sclock_t)eh_msec_to_clock(5));
+    EH_DBG_ERROR_EXEC(ret != EH_RET_TIMEOUT, return -1);
+    EH_DBG_ERROR_EXEC(__await__ eh_offload_wait(job, &result, EH_TIME_FOREVER) < 0 || result != 42, return -1);
+
+    /* 分离的任务完成后自动释放 */
+    job = eh_offload_submit(job_sleep, (void*)(intptr_t)1000);
+    EH_DBG_ERROR_EXEC(eh_ptr_to_error(job) < 0, return -1);
+    eh_offload_detach(job);
+    __await__ eh_usleep(10*1000);
+
+    tick_stop = true;
+    EH_DBG_ERROR_EXEC(__await__ eh_task_join(ticker, &ret, EH_TIME_FOREVER) < 0, return -1);
+    return 0;
+}
+
+/* 大量短任务，完成通知被合并 */
+static int test_bench(void){
+    uint64_t completed_start, completed_end, wakeups_start, wakeups_end;
+    eh_clock_t start;
+    intptr_t result;
+
+    eh_offload_stat(&completed_start, &wakeups_start);
+    start = eh_get_clock_monotonic_time();
+    for(int round = 0; round < TEST_BENCH_ROUNDS; round++){
+        for(int i = 0; i < TEST_BENCH_JOB_CNT; i++){
+            bench_jobs[i] = eh_offload_submit(job_add, (void*)(intptr_t)i);
+            EH_DBG_ERROR_EXEC(eh_ptr_to_error(bench_jobs[i]) < 0, return -1);
+        }
+        for(int i = 0; i < TEST_BENCH_JOB_CNT; i++){
+            EH_DBG_ERROR_EXEC(__await__ eh_offload_wait(bench_jobs[i], &result, EH_TIME_FOREVER) < 0, return -1);
+            EH_DBG_ERROR_EXEC(result != i + 1, return -1);
+        }
+    }
+    eh_offload_stat(&completed_end, &wakeups_end);
+    eh_infofl("bench: %d jobs in %llu us, %llu completions with %llu loop wakeups",
+        TEST_BENCH_JOB_CNT * TEST_BENCH_ROUNDS,
+        (unsigned long long)eh_clock_to_usec(eh_get_clock_monotonic_time() - start),
+        (unsigned long long)(completed_end - completed_start), (unsigned long long)(wakeups_end - wakeups_start));
+    return 0;
+}
+
+int task_app(void *arg){
+    (void) arg;
+    EH_DBG_ERROR_EXEC(test_basic() < 0, return -1);
+    eh_debugfl("test offload basic Pass");
+    EH_DBG_ERROR_EXEC(test_bench() < 0, return -1);
+    eh_debugfl("test offload bench Pass");
+    return 0;
+}
+
+int main(void){
+    int ret;
+    eh_global_init();
+    ret = task_app("task_app");
+    eh_global_exit();
+    return ret;
+}
@@ -0,0 +1,159 @@
+/**
+ * @file test_posix_signal.c
+ * @brief POSIX信号事件测试(test_signal.c测试的是事件回调的信号槽)
+ * @author simon.xiaoapeng (simon.xiaoapeng@gmail.com)
+ * @version 1.0
+ * @date 2024-09-02
+ *
+ * @copyright Copyright (c) 2024  simon.xiaoapeng@gmail.com
+ *
+ * @par 修改日志:
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <signal.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "eh.h"
+#include "eh_debug.h"
+#include "eh_event.h"
+#include "eh_platform.h"
+#include "eh_timer.h"
+#include "eh_sleep.h"
+#include "eh_posix_signal.h"
+
+#define TEST_RT_SIGNAL_CNT      5
+
+static int tick_cnt;
+static bool tick_stop;
+
+void stdout_write(void *stream, const uint8_t *buf, size_t size){
+    (void)stream;
+    printf("%.*s", (int)size, (const char*)buf);
+}
+
+static void* thread_kill(void *arg){
+    (void)arg;
+    usleep(20*1000);
+    kill(getpid(), SIGTERM);
+    return NULL;
+}
+
+static int task_ticker(void *arg){
+    (void)arg;
+    while(!tick_stop){
+        __await__ eh_usleep(1000);
+        tick_cnt++;
+    }
+    return 0;
+}
+
+static int test_basic(void){
+    struct signalfd_siginfo info[TEST_RT_SIGNAL_CNT + 1];
+    union sigval value;
+    eh_event_t *e;
+    int n;
+
+    EH_DBG_ERROR_EXEC(eh_ptr_to_error(eh_posix_signal_event(SIGKILL)) != EH_RET_INVALID_PARAM, return -1);
+    EH_DBG_ERROR_EXEC(eh_posix_signal_read(SIGUSR1, info, 1) != EH_RET_INVALID_STATE, return -1);
+    EH_DBG_ERROR_EXEC(__await__ eh_posix_signal_wait(SIGHUP, info, 1, (eh_sclock_t)eh_msec_to_clock(10)) != EH_RET_TIMEOUT, return -1);
+
+    /* 接管后信号不再终止进程，通过事件通知 */
+    e = eh_posix_signal_event(SIGUSR1);
+    EH_DBG_ERROR_EXEC(eh_ptr_to_error(e) < 0, return -1);
+    EH_DBG_ERROR_EXEC(eh_posix_signal_event(SIGUSR1) != e, return -1);
+    kill(getpid(), SIGUSR1);
+    EH_DBG_ERROR_EXEC(__await__ eh_event_wait_timeout(e, (eh_sclock_t)eh_msec_to_clock(1000)) < 0, return -1);
+    n = eh_posix_signal_read(SIGUSR1, info, TEST_RT_SIGNAL_CNT);
+    EH_DBG_ERROR_EXEC(n != 1 || info[0].ssi_signo != SIGUSR1 || info[0].ssi_pid != (uint32_t)getpid(), return -1);
+
+    /* 实时信号排队，一次唤醒取出全部siginfo */
+    EH_DBG_ERROR_EXEC(eh_ptr_to_error(eh_posix_signal_event(SIGRTMIN)) < 0, return -1);
+    for(int i = 0; i < TEST_RT_SIGNAL_CNT; i++){
+        value.sival_int = i;
+        sigqueue(getpid(), SIGRTMIN, value);
+    }
+    n = __await__ eh_posix_signal_wait(SIGRTMIN, info, TEST_RT_SIGNAL_CNT + 1, (eh_sclock_t)eh_msec_to_clock(1000));
+    EH_DBG_ERROR_EXEC(n != TEST_RT_SIGNAL_CNT, return -1);
+    for(int i = 0; i < n; i++)
+        EH_DBG_ERROR_EXEC(info[i].ssi_int != i, return -1);
+    EH_DBG_ERROR_EXEC(eh_posix_signal_dropped(SIGRTMIN) != 0, return -1);
+
+    /* 队列满时丢弃新的siginfo */
+    for(int i = 0; i < EH_POSIX_SIGNAL_QUEUE_SIZE + 3; i++){
+        value.sival_int = i;
+        sigqueue(getpid(), SIGRTMIN, value);
+    }
+    __await__ eh_usleep(10*1000);
+    EH_DBG_ERROR_EXEC(eh_posix_signal_dropped(SIGRTMIN) != 3, return -1);
+    n = eh_posix_signal_read(SIGRTMIN, info, 1);
+    EH_DBG_ERROR_EXEC(n != 1 || info[0].ssi_int != 0, return -1);
+
+    /* 释放后未决的信号被丢弃，不会按默认方式终止进程 */
+    eh_posix_signal_release(SIGRTMIN);
+    eh_posix_signal_release(SIGUSR1);
+    EH_DBG_ERROR_EXEC(eh_posix_signal_read(SIGUSR1, info, 1) != EH_RET_INVALID_STATE, return -1);
+    return 0;
+}
+
+/* 子进程退出时通过SIGCHLD取得pid和退出码 */
+static int test_sigchld(void){
+    struct signalfd_siginfo info;
+    pid_t pid;
+    int status;
+
+    EH_DBG_ERROR_EXEC(eh_ptr_to_error(eh_posix_signal_event(SIGCHLD)) < 0, return -1);
+    pid = fork();
+    EH_DBG_ERROR_EXEC(pid < 0, return -1);
+    if(pid == 0)
+        _exit(7);
+    EH_DBG_ERROR_EXEC(__await__ eh_posix_signal_wait(SIGCHLD, &info, 1, (eh_sclock_t)eh_msec_to_clock(1000)) != 1, return -1);
+    EH_DBG_ERROR_EXEC(info.ssi_pid != (uint32_t)pid || info.ssi_code != CLD_EXITED || info.ssi_status != 7, return -1);
+    EH_DBG_ERROR_EXEC(waitpid(pid, &status, 0) != pid || WEXITSTATUS(status) != 7, return -1);
+    eh_posix_signal_release(SIGCHLD);
+    return 0;
+}
+
+/* 其他线程发出的信号唤醒空闲的调度器，等待期间其他协程照常运行 */
+static int test_thread(void){
+    struct signalfd_siginfo info;
+    eh_task_t *ticker;
+    pthread_t thread;
+    int ret;
+
+    EH_DBG_ERROR_EXEC(eh_ptr_to_error(eh_posix_signal_event(SIGTERM)) < 0, return -1);
+    tick_cnt = 0;
+    tick_stop = false;
+    ticker = eh_task_create("ticker", 0, 12*1024, NULL, task_ticker);
+    EH_DBG_ERROR_EXEC(eh_ptr_to_error(ticker) < 0, return -1);
+    EH_DBG_ERROR_EXEC(pthread_create(&thread, NULL, thread_kill, NULL) != 0, return -1);
+    EH_DBG_ERROR_EXEC(__await__ eh_posix_signal_wait(SIGTERM, &info, 1, (eh_sclock_t)eh_msec_to_clock(1000)) != 1, return -1);
+    pthread_join(thread, NULL);
+    eh_infofl("SIGTERM from thread, ticker ran %d times while waiting", tick_cnt);
+    EH_DBG_ERROR_EXEC(tick_cnt < 5, return -1);
+    tick_stop = true;
+    EH_DBG_ERROR_EXEC(__await__ eh_task_join(ticker, &ret, EH_TIME_FOREVER) < 0, return -1);
+    eh_posix_signal_release(SIGTERM);
+    return 0;
+}
+
+int task_app(void *arg){
+    (void) arg;
+    EH_DBG_ERROR_EXEC(test_basic() < 0, return -1);
+    eh_debugfl("test posix signal basic Pass");
+    EH_DBG_ERROR_EXEC(test_sigchld() < 0, return -1);
+    eh_debugfl("test posix signal sigchld Pass");
+    EH_DBG_ERROR_EXEC(test_thread() < 0, return -1);
+    eh_debugfl("test posix signal thread Pass");
+    return 0;
+}
+
+int main(void){
+    int ret;
+    eh_global_init();
+    ret = task_app("task_app");
+    eh_global_exit();
+    return ret;
+}
@@ -0,0 +1,217 @@
+/**
+ * @file test_process.c
+ * @brief 异步子进程测试，包括管道读写和大量短进程的创建回收基准
+ * @author simon.xiaoapeng (simon.xiaoapeng@gmail.com)
+ * @version 1.0
+ * @date 2024-09-04
+ *
+ * @copyright Copyright (c) 2024  simon.xiaoapeng@gmail.com
+ *
+ * @par 修改日志:
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "eh.h"
+#include "eh_debug.h"
+#include "eh_event.h"
+#include "eh_platform.h"
+#include "eh_timer.h"
+#include "eh_sleep.h"
+#include "eh_ringbuf.h"
+#include "eh_process.h"
+
+#define TEST_PIPE_DATA_SIZE     (256*1024)
+#define TEST_RINGBUF_SIZE       (16*1024)
+#define TEST_BENCH_PROCESS_CNT  200
+
+static eh_process_t *bench_processes[TEST_BENCH_PROCESS_CNT];
+
+void stdout_write(void *stream, const uint8_t *buf, size_t size){
+    (void)stream;
+    printf("%.*s", (int)size, (const char*)buf);
+}
+
+static uint8_t test_pattern(size_t i){
+    return (uint8_t)(i * 7 + (i >> 9));
+}
+
+static int test_exit_status(void){
+    char *argv[] = {"sh", "-c", "exit 3", NULL};
+    struct eh_process_config config;
+    eh_process_t *process;
+    int status;
+
+    eh_process_config_init(&config, "/bin/sh");
+    config.argv = argv;
+    process = eh_process_spawn(&config);
+    EH_DBG_ERROR_EXEC(eh_ptr_to_error(process) < 0, return -1);
+    EH_DBG_ERROR_EXEC(__await__ eh_process_wait(process, &status, EH_TIME_FOREVER) < 0, return -1);
+    EH_DBG_ERROR_EXEC(!WIFEXITED(status) || WEXITSTATUS(status) != 3, return -1);
+    /* 已回收的子进程可以重复获取退出状态，不能再发送信号 */
+    EH_DBG_ERROR_EXEC(__await__ eh_process_wait(process, &status, 0) < 0 || WEXITSTATUS(status) != 3, return -1);
+    EH_DBG_ERROR_EXEC(eh_process_kill(process, SIGTERM) != EH_RET_INVALID_STATE, return -1);
+    eh_process_destroy(process);
+
+    eh_process_config_init(&config, "/nonexistent/eh_process");
+    EH_DBG_ERROR_EXEC(eh_ptr_to_error(eh_process_spawn(&config)) != EH_RET_FAULT, return -1);
+    return 0;
+}
+
+static int task_feed_stdin(void *arg){
+    eh_process_t *process = (eh_process_t *)arg;
+    eh_ringbuf_t *ringbuf;
+    uint8_t buf[4096];
+    size_t sent = 0;
+    int32_t len;
+    ssize_t n;
+
+    ringbuf = eh_ringbuf_create(TEST_RINGBUF_SIZE, NULL);
+    if(eh_ptr_to_error(ringbuf) < 0)
+        return -1;
+    while(sent < TEST_PIPE_DATA_SIZE || eh_ringbuf_size(ringbuf)){
+        while(sent < TEST_PIPE_DATA_SIZE && eh_ringbuf_free_size(ringbuf) > 0){
+            len = eh_ringbuf_free_size(ringbuf) < (int32_t)sizeof(buf) ? eh_ringbuf_free_size(ringbuf) : (int32_t)sizeof(buf);
+            if((size_t)len > TEST_PIPE_DATA_SIZE - sent)
+                len = (int32_t)(TEST_PIPE_DATA_SIZE - sent);
+            for(int32_t i = 0; i < len; i++)
+                buf[i] = test_pattern(sent + (size_t)i);
+            eh_ringbuf_write(ringbuf, buf, len);
+            sent += (size_t)len;
+        }
+        n = __await__ eh_process_write(process, ringbuf, EH_TIME_FOREVER);
+        if(n < 0)
+            break;
+    }
+    eh_ringbuf_destroy(ringbuf);
+    eh_process_close(process, EH_PROCESS_STDIN);
+    return sent == TEST_PIPE_DATA_SIZE ? 0 : -1;
+}
+
+/* 数据经cat的stdin流到stdout，写入和读取在两个任务中同时进行 */
+static int test_pipe(void){
+    char *argv[] = {"cat", NULL};
+    struct eh_process_config config;
+    eh_process_t *process;
+    eh_ringbuf_t *ringbuf;
+    eh_task_t *feeder;
+    uint8_t buf[4096];
+    size_t received = 0;
+    int32_t len;
+    ssize_t n;
+    int status, ret;
+
+    eh_process_config_init(&config, "cat");
+    config.argv = argv;
+    config.search_path = true;
+    config.pipe[EH_PROCESS_STDIN] = true;
+    config.pipe[EH_PROCESS_STDOUT] = true;
+    process = eh_process_spawn(&config);
+    EH_DBG_ERROR_EXEC(eh_ptr_to_error(process) < 0, return -1);
+    EH_DBG_ERROR_EXEC(eh_process_fd(process, EH_PROCESS_STDERR) != -1, return -1);
+    feeder = eh_task_create("feeder", 0, 16*1024, process, task_feed_stdin);
+    EH_DBG_ERROR_EXEC(eh_ptr_to_error(feeder) < 0, return -1);
+
+    ringbuf = eh_ringbuf_create(TEST_RINGBUF_SIZE, NULL);
+    EH_DBG_ERROR_EXEC(eh_ptr_to_error(ringbuf) < 0, return -1);
+    for(;;){
+        n = __await__ eh_process_read(process, EH_PROCESS_STDOUT, ringbuf, (eh_sclock_t)eh_msec_to_clock(5000));
+        EH_DBG_ERROR_EXEC(n < 0, return -1);
+        if(n == 0)
+            break;
+        while((len = eh_ringbuf_read(ringbuf, buf, (int32_t)sizeof(buf))) > 0){
+            for(int32_t i = 0; i < len; i++)
+                EH_DBG_ERROR_EXEC(buf[i] != test_pattern(received + (size_t)i), return -1);
+            received += (size_t)len;
+        }
+    }
+    eh_ringbuf_destroy(ringbuf);
+    EH_DBG_ERROR_EXEC(received != TEST_PIPE_DATA_SIZE, return -1);
+    EH_DBG_ERROR_EXEC(__await__ eh_task_join(feeder, &ret, EH_TIME_FOREVER) < 0 || ret != 0, return -1);
+    EH_DBG_ERROR_EXEC(__await__ eh_process_wait(process, &status, EH_TIME_FOREVER) < 0, return -1);
+    EH_DBG_ERROR_EXEC(!WIFEXITED(status) || WEXITSTATUS(status) != 0, return -1);
+    eh_process_destroy(process);
+    return 0;
+}
+
+static int test_kill(void){
+    char *argv[] = {"sleep", "10", NULL};
+    struct eh_process_config config;
+    eh_process_t *process;
+    siginfo_t info;
+    pid_t pid;
+    int status;
+
+    eh_process_config_init(&config, "sleep");
+    config.argv = argv;
+    config.search_path = true;
+    process = eh_process_spawn(&config);
+    EH_DBG_ERROR_EXEC(eh_ptr_to_error(process) < 0, return -1);
+    EH_DBG_ERROR_EXEC(__await__ eh_process_wait(process, &status, (eh_sclock_t)eh_msec_to_clock(10)) != EH_RET_TIMEOUT, return -1);
+    EH_DBG_ERROR_EXEC(eh_process_kill(process, SIGTERM) < 0, return -1);
+    EH_DBG_ERROR_EXEC(__await__ eh_process_wait(process, &status, (eh_sclock_t)eh_msec_to_clock(1000)) < 0, return -1);
+    EH_DBG_ERROR_EXEC(!WIFSIGNALED(status) || WTERMSIG(status) != SIGTERM, return -1);
+    eh_process_destroy(process);
+
+    /* 销毁还在运行的子进程不阻塞调度器，子进程退出后在事件循环中被回收，不会留下僵尸进程 */
+    process = eh_process_spawn(&config);
+    EH_DBG_ERROR_EXEC(eh_ptr_to_error(process) < 0, return -1);
+    pid = eh_process_pid(process);
+    eh_process_destroy(process);
+    for(int i = 0; i < 100; i++){
+        /* WNOWAIT只查询不回收，回收仍由eh_process完成 */
+        if(waitid(P_PID, (id_t)pid, &info, WEXITED | WNOHANG | WNOWAIT) < 0 && errno == ECHILD)
+            return 0;
+        __await__ eh_usleep(10*1000);
+    }
+    return -1;
+}
+
+/* 同时运行大量短进程，全部由调度器线程等待回收 */
+static int test_bench(void){
+    struct eh_process_config config;
+    eh_clock_t start;
+    eh_usec_t usec;
+    int status;
+
+    eh_process_config_init(&config, "/bin/true");
+    start = eh_get_clock_monotonic_time();
+    for(int i = 0; i < TEST_BENCH_PROCESS_CNT; i++){
+        bench_processes[i] = eh_process_spawn(&config);
+        EH_DBG_ERROR_EXEC(eh_ptr_to_error(bench_processes[i]) < 0, return -1);
+    }
+    for(int i = 0; i < TEST_BENCH_PROCESS_CNT; i++){
+        EH_DBG_ERROR_EXEC(__await__ eh_process_wait(bench_processes[i], &status, (eh_sclock_t)eh_msec_to_clock(5000)) < 0, return -1);
+        EH_DBG_ERROR_EXEC(!WIFEXITED(status) || WEXITSTATUS(status) != 0, return -1);
+        eh_process_destroy(bench_processes[i]);
+    }
+    usec = eh_clock_to_usec(eh_get_clock_monotonic_time() - start);
+    eh_infofl("bench: %d processes spawned and reaped in %llu us (%llu/s)", TEST_BENCH_PROCESS_CNT,
+        (unsigned long long)usec, (unsigned long long)((uint64_t)TEST_BENCH_PROCESS_CNT * 1000000 / (usec ? usec : 1)));
+    return 0;
+}
+
+int task_app(void *arg){
+    (void) arg;
+    EH_DBG_ERROR_EXEC(test_exit_status() < 0, return -1);
+    eh_debugfl("test process exit status Pass");
+    EH_DBG_ERROR_EXEC(test_pipe() < 0, return -1);
+    eh_debugfl("test process pipe Pass");
+    EH_DBG_ERROR_EXEC(test_kill() < 0, return -1);
+    eh_debugfl("test process kill Pass");
+    EH_DBG_ERROR_EXEC(test_bench() < 0, return -1);
+    eh_debugfl("test process bench Pass");
+    return 0;
+}
+
+int main(void){
+    int ret;
+    eh_global_init();
+    ret = task_app("task_app");
+    eh_global_exit();
+    return ret;
+}
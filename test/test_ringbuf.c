@@ -28,6 +28,7 @@
 #include "eh_timer.h" 
 #include "eh_types.h"
 #include "eh_ringbuf.h"
+#include "eh_ringbuf_fd.h"
 
 void stdout_write(void *stream, const uint8_t *buf, size_t size){
     (void)stream;
@@ -613,6 +614,27 @@ int test_basics_interface(eh_ringbuf_t* ringbuf){
     eh_ringbuf_reset(ringbuf);
     
 
+    /* 用例7 span跨边界readv/writev */
+    {
+        int pipe_fd[2];
+        EH_DBG_ERROR_EXEC(pipe(pipe_fd) < 0, return -1);
+        test_buf_init(test_buf, sizeof(test_buf));
+        /* 让读写位置停在中间，使空闲区域与已用区域都发生绕回 */
+        EH_DBG_ERROR_EXEC(eh_ringbuf_write(ringbuf, test_buf, 700) != 700, return -1);
+        EH_DBG_ERROR_EXEC(eh_ringbuf_read_skip(ringbuf, 700) != 700, return -1);
+        EH_DBG_ERROR_EXEC(write(pipe_fd[1], test_buf, 600) != 600, return -1);
+        EH_DBG_ERROR_EXEC(eh_ringbuf_readv_fd(ringbuf, pipe_fd[0]) != 600, return -1);
+        EH_DBG_ERROR_EXEC(eh_ringbuf_size(ringbuf) != 600, return -1);
+        EH_DBG_ERROR_EXEC(eh_ringbuf_writev_fd(ringbuf, pipe_fd[1]) != 600, return -1);
+        EH_DBG_ERROR_EXEC(eh_ringbuf_size(ringbuf) != 0, return -1);
+        test_buf_clean(test_buf, sizeof(test_buf));
+        EH_DBG_ERROR_EXEC(read(pipe_fd[0], test_buf, 600) != 600, return -1);
+        EH_DBG_ERROR_EXEC(test_buf_check(test_buf, 600, 0), return -1);
+        close(pipe_fd[0]);
+        close(pipe_fd[1]);
+        eh_ringbuf_reset(ringbuf);
+    }
+
     /* 用例21 并行随机读写测试 */
     EH_DBG_ERROR_EXEC(test_random_wr(100049, 10000)!=0, return -1);
 
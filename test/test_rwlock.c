@@ -0,0 +1,150 @@
+/**
+ * @file test_rwlock.c
+ * @brief 测试读写锁
+ * @author simon.xiaoapeng (simon.xiaoapeng@gmail.com)
+ * @version 1.0
+ * @date 2024-08-10
+ * 
+ * @copyright Copyright (c) 2024  simon.xiaoapeng@gmail.com
+ * 
+ * @par 修改日志:
+ */
+
+#include <stdio.h>
+#include "eh.h"
+#include "eh_debug.h"
+#include "eh_event.h"
+#include "eh_platform.h"
+#include "eh_timer.h"
+#include "eh_sleep.h" 
+#include "eh_rwlock.h"
+
+static eh_rwlock_t rwlock;
+static int reader_in;
+static int reader_in_max;
+static int writer_in;
+static int order_cnt;
+static int writer_order;
+
+void stdout_write(void *stream, const uint8_t *buf, size_t size){
+    (void)stream;
+    printf("%.*s", (int)size, (const char*)buf);
+}
+
+int task_reader(void *arg){
+    int ret;
+    (void) arg;
+    ret = __await__ eh_rwlock_rdlock(rwlock, EH_TIME_FOREVER);
+    if(ret < 0 || writer_in)
+        return -1;
+    reader_in++;
+    if(reader_in > reader_in_max)
+        reader_in_max = reader_in;
+    __await__ eh_usleep(100*1000);
+    reader_in--;
+    order_cnt++;
+    return eh_rwlock_unlock(rwlock);
+}
+
+int task_writer(void *arg){
+    int ret;
+    (void) arg;
+    ret = __await__ eh_rwlock_wrlock(rwlock, EH_TIME_FOREVER);
+    if(ret < 0 || reader_in || writer_in)
+        return -1;
+    writer_in++;
+    __await__ eh_usleep(100*1000);
+    writer_in--;
+    writer_order = order_cnt++;
+    return eh_rwlock_unlock(rwlock);
+}
+
+int task_destroyed_writer(void *arg){
+    (void) arg;
+    return __await__ eh_rwlock_wrlock(rwlock, EH_TIME_FOREVER) == EH_RET_EVENT_ERROR ? 0 : -1;
+}
+
+/* 写者等待期间锁被销毁，等待返回EH_RET_EVENT_ERROR且不再访问已释放的锁 */
+static int test_destroy_waiting(enum eh_rwlock_type type){
+    eh_task_t *writer;
+    int ret, app_ret;
+
+    rwlock = eh_rwlock_create(type);
+    EH_DBG_ERROR_EXEC(eh_ptr_to_error(rwlock) < 0, return -1);
+    EH_DBG_ERROR_EXEC(eh_rwlock_rdlock(rwlock, 0) != EH_RET_OK, return -1);
+    writer = eh_task_create("writer", 0, 12*1024, NULL, task_destroyed_writer);
+    EH_DBG_ERROR_EXEC(eh_ptr_to_error(writer) < 0, return -1);
+    __await__ eh_usleep(10*1000);
+    eh_rwlock_destroy(rwlock);
+    ret = __await__ eh_task_join(writer, &app_ret, EH_TIME_FOREVER);
+    EH_DBG_ERROR_EXEC(ret < 0 || app_ret < 0, return -1);
+    return 0;
+}
+
+static int test_rwlock(enum eh_rwlock_type type){
+    eh_task_t *readers[4], *writer, *late_reader;
+    int ret, app_ret;
+
+    rwlock = eh_rwlock_create(type);
+    EH_DBG_ERROR_EXEC(eh_ptr_to_error(rwlock) < 0, return -1);
+    reader_in = reader_in_max = writer_in = order_cnt = 0;
+    writer_order = -1;
+
+    /* 用例1 写锁超时，读锁在写者持有时超时 */
+    EH_DBG_ERROR_EXEC(eh_rwlock_unlock(rwlock) != EH_RET_INVALID_STATE, return -1);
+    EH_DBG_ERROR_EXEC(eh_rwlock_wrlock(rwlock, 0) != EH_RET_OK, return -1);
+    EH_DBG_ERROR_EXEC(eh_rwlock_rdlock(rwlock, (eh_sclock_t)eh_msec_to_clock(10)) != EH_RET_TIMEOUT, return -1);
+    EH_DBG_ERROR_EXEC(eh_rwlock_unlock(rwlock) != EH_RET_OK, return -1);
+
+    /* 用例2 多个读者同时持锁，写者在第一批读者之后进入 */
+    for(int i = 0; i < 2; i++)
+        readers[i] = eh_task_create("reader", 0, 12*1024, NULL, task_reader);
+    writer = eh_task_create("writer", 0, 12*1024, NULL, task_writer);
+    __await__ eh_usleep(10*1000);
+    /* 写者已经在等待，后来的读者 */
+    late_reader = eh_task_create("late_reader", 0, 12*1024, NULL, task_reader);
+    for(int i = 2; i < 4; i++)
+        readers[i] = eh_task_create("reader", 0, 12*1024, NULL, task_reader);
+
+    for(int i = 0; i < 4; i++){
+        ret = __await__ eh_task_join(readers[i], &app_ret, EH_TIME_FOREVER);
+        EH_DBG_ERROR_EXEC(ret < 0 || app_ret < 0, return -1);
+    }
+    ret = __await__ eh_task_join(late_reader, &app_ret, EH_TIME_FOREVER);
+    EH_DBG_ERROR_EXEC(ret < 0 || app_ret < 0, return -1);
+    ret = __await__ eh_task_join(writer, &app_ret, EH_TIME_FOREVER);
+    EH_DBG_ERROR_EXEC(ret < 0 || app_ret < 0, return -1);
+
+    if(type == EH_RWLOCK_TYPE_WRITER_PREFER){
+        /* 写者在前两个读者之后立即获得锁，之后三个读者一起被唤醒 */
+        EH_DBG_ERROR_EXEC(writer_order != 2, return -1);
+        EH_DBG_ERROR_EXEC(reader_in_max != 3, return -1);
+    }else{
+        /* 读者优先时，所有读者都在写者之前 */
+        EH_DBG_ERROR_EXEC(writer_order != 5, return -1);
+        EH_DBG_ERROR_EXEC(reader_in_max != 5, return -1);
+    }
+
+    eh_rwlock_destroy(rwlock);
+    return 0;
+}
+
+int task_app(void *arg){
+    (void) arg;
+    EH_DBG_ERROR_EXEC(test_rwlock(EH_RWLOCK_TYPE_READER_PREFER) < 0, return -1);
+    eh_debugfl("test reader prefer Pass");
+    EH_DBG_ERROR_EXEC(test_rwlock(EH_RWLOCK_TYPE_WRITER_PREFER) < 0, return -1);
+    eh_debugfl("test writer prefer Pass");
+    EH_DBG_ERROR_EXEC(test_destroy_waiting(EH_RWLOCK_TYPE_READER_PREFER) < 0, return -1);
+    EH_DBG_ERROR_EXEC(test_destroy_waiting(EH_RWLOCK_TYPE_WRITER_PREFER) < 0, return -1);
+    eh_debugfl("test destroy with waiting writer Pass");
+    return 0;
+}
+
+int main(void){
+    int ret;
+    eh_global_init();
+    ret = task_app("task_app");
+    eh_global_exit();
+    return ret;
+}
@@ -37,6 +37,9 @@ void stdout_write(void *stream, const uint8_t *buf, size_t size){
     printf("%.*s", (int)size, (const char*)buf);
 }
 
+EH_EXTERN_CUSTOM_SIGNAL(timer_1000ms_signal, eh_timer_event_t);
+EH_EXTERN_SIGNAL(test_signal);
+
 EH_DEFINE_CUSTOM_SIGNAL(
     timer_1000ms_signal, 
     eh_timer_event_t, 
@@ -0,0 +1,199 @@
+/**
+ * @file test_signal_queue.c
+ * @brief 排队信号测试
+ * @author simon.xiaoapeng (simon.xiaoapeng@gmail.com)
+ * @version 1.0
+ * @date 2024-08-18
+ *
+ * @copyright Copyright (c) 2024  simon.xiaoapeng@gmail.com
+ *
+ * @par 修改日志:
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+#include "eh.h"
+#include "eh_debug.h"
+#include "eh_event.h"
+#include "eh_platform.h"
+#include "eh_timer.h"
+#include "eh_sleep.h"
+#include "eh_signal.h"
+#include "eh_signal_queue.h"
+
+#define TEST_BURST_CNT          40
+#define TEST_LARGE_SIZE         64
+#define TEST_LARGE_POOL_CNT     8
+#define TEST_THREAD_CNT         100000
+
+struct test_large_payload{
+    uint32_t    seq;
+    uint8_t     fill[TEST_LARGE_SIZE - sizeof(uint32_t)];
+};
+
+static eh_signal_queue_t *test_sq;
+static uint32_t recv_cnt, recv_batch_cnt, recv_next_seq, recv_seq_error;
+static uint32_t mirror_cnt;
+static uint32_t plain_slot_cnt;
+
+void stdout_write(void *stream, const uint8_t *buf, size_t size){
+    (void)stream;
+    printf("%.*s", (int)size, (const char*)buf);
+}
+
+static void slot_telemetry(eh_event_t *e, void *p){
+    const eh_signal_payload_t *payloads;
+    uint32_t seq;
+    int n;
+    (void)e;
+    (void)p;
+    n = eh_signal_queue_batch(test_sq, &payloads);
+    for(int i = 0; i < n; i++){
+        memcpy(&seq, payloads[i].buf, sizeof(seq));
+        if(seq != recv_next_seq)
+            recv_seq_error++;
+        recv_next_seq = seq + 1;
+    }
+    recv_cnt += (uint32_t)n;
+    recv_batch_cnt++;
+}
+
+/* 同一批负载会交给每个连接的槽 */
+static void slot_mirror(eh_event_t *e, void *p){
+    const eh_signal_payload_t *payloads;
+    (void)e;
+    (void)p;
+    mirror_cnt += (uint32_t)eh_signal_queue_batch(test_sq, &payloads);
+}
+
+static void slot_plain(eh_event_t *e, void *p){
+    (void)e;
+    (void)p;
+    plain_slot_cnt++;
+}
+
+static EH_DEFINE_SLOT(telemetry_slot, slot_telemetry, NULL);
+static EH_DEFINE_SLOT(mirror_slot, slot_mirror, NULL);
+static EH_DEFINE_SLOT(plain_slot, slot_plain, NULL);
+static EH_STATIC_SIGNAL(plain_signal);
+
+static void test_reset(void){
+    recv_cnt = 0;
+    recv_batch_cnt = 0;
+    recv_next_seq = 0;
+    recv_seq_error = 0;
+    mirror_cnt = 0;
+}
+
+static int test_inline(void){
+    test_sq = eh_signal_queue_create(TEST_BURST_CNT, sizeof(uint32_t), 0);
+    EH_DBG_ERROR_EXEC(eh_ptr_to_error(test_sq) < 0, return -1);
+    eh_signal_queue_slot_connect(test_sq, &telemetry_slot);
+    eh_signal_queue_slot_connect(test_sq, &mirror_slot);
+    EH_DBG_ERROR_EXEC(eh_signal_queue_slot_connect(test_sq, &mirror_slot) != EH_RET_BUSY, return -1);
+    eh_signal_queue_register(test_sq);
+    test_reset();
+
+    /* 普通信号在分发前的多次触发会合并 */
+    eh_signal_slot_connect(&plain_signal, &plain_slot);
+    eh_signal_register(&plain_signal);
+    for(uint32_t i = 0; i < TEST_BURST_CNT; i++)
+        eh_signal_notify(&plain_signal);
+
+    for(uint32_t i = 0; i < TEST_BURST_CNT; i++)
+        EH_DBG_ERROR_EXEC(eh_signal_queue_notify(test_sq, &i, sizeof(i)) != EH_RET_OK, return -1);
+    EH_DBG_ERROR_EXEC(eh_signal_queue_notify(test_sq, &recv_cnt, sizeof(recv_cnt)) != EH_RET_BUSY, return -1);
+    EH_DBG_ERROR_EXEC(eh_signal_queue_notify(test_sq, &recv_cnt, sizeof(recv_cnt) + 1) != EH_RET_INVALID_PARAM, return -1);
+    __await__ eh_usleep(10000);
+    eh_infofl("plain signal: %u notify -> %u slot call, queued signal: %u payloads in %u batches",
+        TEST_BURST_CNT, plain_slot_cnt, recv_cnt, recv_batch_cnt);
+    EH_DBG_ERROR_EXEC(plain_slot_cnt != 1, return -1);
+    EH_DBG_ERROR_EXEC(recv_cnt != TEST_BURST_CNT || recv_seq_error, return -1);
+    EH_DBG_ERROR_EXEC(mirror_cnt != TEST_BURST_CNT, return -1);
+    EH_DBG_ERROR_EXEC(recv_batch_cnt != (TEST_BURST_CNT + EH_SIGNAL_QUEUE_BATCH_SIZE - 1) / EH_SIGNAL_QUEUE_BATCH_SIZE, return -1);
+    EH_DBG_ERROR_EXEC(eh_signal_queue_dropped(test_sq) != 1, return -1);
+
+    eh_signal_unregister(&plain_signal);
+    eh_signal_clean(&plain_signal);
+    eh_signal_queue_destroy(test_sq);
+    return 0;
+}
+
+static int test_pool(void){
+    struct test_large_payload payload;
+    memset(&payload, 0x5a, sizeof(payload));
+    test_sq = eh_signal_queue_create(TEST_BURST_CNT, sizeof(payload), TEST_LARGE_POOL_CNT);
+    EH_DBG_ERROR_EXEC(eh_ptr_to_error(test_sq) < 0, return -1);
+    eh_signal_queue_slot_connect(test_sq, &telemetry_slot);
+    eh_signal_queue_set_mode(test_sq, EH_EVENT_CB_MODE_DEFERRED);
+    eh_signal_queue_register(test_sq);
+    test_reset();
+
+    /* 大负载只能同时存在TEST_LARGE_POOL_CNT个，小负载不受内存块数量限制 */
+    for(payload.seq = 0; payload.seq < TEST_LARGE_POOL_CNT; payload.seq++)
+        EH_DBG_ERROR_EXEC(eh_signal_queue_notify(test_sq, &payload, sizeof(payload)) != EH_RET_OK, return -1);
+    EH_DBG_ERROR_EXEC(eh_signal_queue_notify(test_sq, &payload, sizeof(payload)) != EH_RET_BUSY, return -1);
+    EH_DBG_ERROR_EXEC(eh_signal_queue_notify(test_sq, &payload, sizeof(uint32_t)) != EH_RET_OK, return -1);
+    __await__ eh_usleep(10000);
+    EH_DBG_ERROR_EXEC(recv_cnt != TEST_LARGE_POOL_CNT + 1 || recv_seq_error, return -1);
+
+    /* 内存块释放后可以再次使用 */
+    for(payload.seq = TEST_LARGE_POOL_CNT + 1; payload.seq < TEST_LARGE_POOL_CNT * 2 + 1; payload.seq++)
+        EH_DBG_ERROR_EXEC(eh_signal_queue_notify(test_sq, &payload, sizeof(payload)) != EH_RET_OK, return -1);
+    __await__ eh_usleep(10000);
+    EH_DBG_ERROR_EXEC(recv_cnt != TEST_LARGE_POOL_CNT * 2 + 1 || recv_seq_error, return -1);
+    eh_signal_queue_destroy(test_sq);
+    return 0;
+}
+
+static void* thread_producer(void* arg){
+    (void) arg;
+    for(uint32_t i = 0; i < TEST_THREAD_CNT; i++){
+        while(eh_signal_queue_notify(test_sq, &i, sizeof(i)) == EH_RET_BUSY)
+            sched_yield();
+    }
+    return NULL;
+}
+
+static int test_thread(void){
+    pthread_t thread;
+    eh_clock_t start;
+    test_sq = eh_signal_queue_create(256, sizeof(uint32_t), 0);
+    EH_DBG_ERROR_EXEC(eh_ptr_to_error(test_sq) < 0, return -1);
+    eh_signal_queue_slot_connect(test_sq, &telemetry_slot);
+    eh_signal_queue_register(test_sq);
+    test_reset();
+
+    start = eh_get_clock_monotonic_time();
+    EH_DBG_ERROR_EXEC(pthread_create(&thread, NULL, thread_producer, NULL) != 0, return -1);
+    while(recv_cnt < TEST_THREAD_CNT)
+        __await__ eh_usleep(1000);
+    pthread_join(thread, NULL);
+    eh_infofl("thread: %u payloads in %u batches, %llu us, %u retries",
+        recv_cnt, recv_batch_cnt, (unsigned long long)eh_clock_to_usec(eh_get_clock_monotonic_time() - start),
+        eh_signal_queue_dropped(test_sq));
+    EH_DBG_ERROR_EXEC(recv_seq_error, return -1);
+    eh_signal_queue_destroy(test_sq);
+    return 0;
+}
+
+int task_app(void *arg){
+    (void) arg;
+    EH_DBG_ERROR_EXEC(test_inline() < 0, return -1);
+    eh_debugfl("test signal queue inline Pass");
+    EH_DBG_ERROR_EXEC(test_pool() < 0, return -1);
+    eh_debugfl("test signal queue pool Pass");
+    EH_DBG_ERROR_EXEC(test_thread() < 0, return -1);
+    eh_debugfl("test signal queue thread Pass");
+    return 0;
+}
+
+int main(void){
+    int ret;
+    eh_global_init();
+    ret = task_app("task_app");
+    eh_global_exit();
+    return ret;
+}
@@ -0,0 +1,253 @@
+/**
+ * @file test_tcp_server.c
+ * @brief TCP服务端框架测试，回环地址上的echo基准(每秒连接数和每秒请求数)
+ * @author simon.xiaoapeng (simon.xiaoapeng@gmail.com)
+ * @version 1.0
+ * @date 2024-08-28
+ *
+ * @copyright Copyright (c) 2024  simon.xiaoapeng@gmail.com
+ *
+ * @par 修改日志:
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include "eh.h"
+#include "eh_debug.h"
+#include "eh_event.h"
+#include "eh_platform.h"
+#include "eh_timer.h"
+#include "eh_sleep.h"
+#include "eh_fd.h"
+#include "eh_tcp_server.h"
+
+#define TEST_CLIENT_CNT         16
+#define TEST_CONN_PER_CLIENT    200
+#define TEST_REQ_PER_CLIENT     2000
+#define TEST_REQ_SIZE           64
+
+static struct sockaddr_in server_addr;
+
+void stdout_write(void *stream, const uint8_t *buf, size_t size){
+    (void)stream;
+    printf("%.*s", (int)size, (const char*)buf);
+}
+
+static int echo_handler(int fd, void *arg){
+    uint8_t buf[1024];
+    ssize_t n;
+    (void)arg;
+    for(;;){
+        n = __await__ eh_recv(fd, buf, sizeof(buf), 0, EH_TIME_FOREVER);
+        if(n <= 0)
+            return 0;
+        if(__await__ eh_send(fd, buf, (size_t)n, 0, EH_TIME_FOREVER) != n)
+            return -1;
+    }
+}
+
+/* 收到数据后挂起在睡眠上，连接的shutdown无法唤醒它 */
+static int sleep_handler(int fd, void *arg){
+    uint8_t c;
+    (void)arg;
+    if(__await__ eh_recv(fd, &c, 1, 0, EH_TIME_FOREVER) != 1)
+        return -1;
+    __await__ eh_usleep(200*1000);
+    return 0;
+}
+
+static int client_connect(void){
+    int fd, on = 1;
+    fd = socket(AF_INET, SOCK_STREAM, 0);
+    if(fd < 0)
+        return -1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+    if(__await__ eh_connect(fd, (struct sockaddr*)&server_addr, sizeof(server_addr), (eh_sclock_t)eh_msec_to_clock(1000)) < 0){
+        eh_close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static int client_request(int fd){
+    uint8_t req[TEST_REQ_SIZE], resp[TEST_REQ_SIZE];
+    size_t got = 0;
+    ssize_t n;
+    memset(req, 0x5a, sizeof(req));
+    if(__await__ eh_send(fd, req, sizeof(req), 0, EH_TIME_FOREVER) != sizeof(req))
+        return -1;
+    while(got < sizeof(resp)){
+        n = __await__ eh_recv(fd, resp + got, sizeof(resp) - got, 0, (eh_sclock_t)eh_msec_to_clock(1000));
+        if(n <= 0)
+            return -1;
+        got += (size_t)n;
+    }
+    return memcmp(req, resp, sizeof(req)) == 0 ? 0 : -1;
+}
+
+/* 每次请求都新建连接 */
+static int task_conn_client(void *arg){
+    int fd;
+    (void)arg;
+    for(int i = 0; i < TEST_CONN_PER_CLIENT; i++){
+        fd = client_connect();
+        if(fd < 0 || client_request(fd) < 0)
+            return -1;
+        eh_close(fd);
+    }
+    return 0;
+}
+
+/* 长连接上连续请求 */
+static int task_req_client(void *arg){
+    int fd;
+    (void)arg;
+    fd = client_connect();
+    if(fd < 0)
+        return -1;
+    for(int i = 0; i < TEST_REQ_PER_CLIENT; i++){
+        if(client_request(fd) < 0)
+            return -1;
+    }
+    eh_close(fd);
+    return 0;
+}
+
+static int run_clients(int (*client)(void *arg), eh_usec_t *usec){
+    eh_task_t *tasks[TEST_CLIENT_CNT];
+    eh_clock_t start;
+    int ret, failed = 0;
+    start = eh_get_clock_monotonic_time();
+    for(int i = 0; i < TEST_CLIENT_CNT; i++){
+        tasks[i] = eh_task_create("client", 0, 16*1024, NULL, client);
+        EH_DBG_ERROR_EXEC(eh_ptr_to_error(tasks[i]) < 0, return -1);
+    }
+    for(int i = 0; i < TEST_CLIENT_CNT; i++){
+        EH_DBG_ERROR_EXEC(__await__ eh_task_join(tasks[i], &ret, EH_TIME_FOREVER) < 0, return -1);
+        if(ret != 0)
+            failed++;
+    }
+    *usec = eh_clock_to_usec(eh_get_clock_monotonic_time() - start);
+    return failed ? -1 : 0;
+}
+
+static eh_tcp_server_t* start_server(int listener_cnt, int max_conn, int (*handler)(int fd, void *arg)){
+    struct eh_tcp_server_config config;
+    struct sockaddr_in addr;
+    socklen_t addrlen = sizeof(server_addr);
+    eh_tcp_server_t *server;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    eh_tcp_server_config_init(&config);
+    config.addr = (struct sockaddr*)&addr;
+    config.addrlen = sizeof(addr);
+    config.listener_cnt = listener_cnt;
+    config.max_conn = max_conn;
+    config.backlog = 512;
+    config.handler = handler;
+    server = eh_tcp_server_create(&config);
+    if(eh_ptr_to_error(server) < 0)
+        return server;
+    eh_tcp_server_local_addr(server, (struct sockaddr*)&server_addr, &addrlen);
+    return server;
+}
+
+static int test_bench(int listener_cnt){
+    eh_tcp_server_t *server;
+    struct eh_tcp_server_stat stat;
+    eh_usec_t conn_usec, req_usec;
+    int conn_total = TEST_CLIENT_CNT * TEST_CONN_PER_CLIENT;
+    int req_total = TEST_CLIENT_CNT * TEST_REQ_PER_CLIENT;
+
+    server = start_server(listener_cnt, 64, echo_handler);
+    EH_DBG_ERROR_EXEC(eh_ptr_to_error(server) < 0, return -1);
+    EH_DBG_ERROR_EXEC(run_clients(task_conn_client, &conn_usec) < 0, return -1);
+    EH_DBG_ERROR_EXEC(run_clients(task_req_client, &req_usec) < 0, return -1);
+    eh_tcp_server_stat(server, &stat);
+    eh_infofl("listeners=%d: %d conns in %llu us (%llu conn/s), %d reqs in %llu us (%llu req/s), %d workers for %llu conns",
+        listener_cnt,
+        conn_total, (unsigned long long)conn_usec, (unsigned long long)((uint64_t)conn_total * 1000000 / (conn_usec ? conn_usec : 1)),
+        req_total, (unsigned long long)req_usec, (unsigned long long)((uint64_t)req_total * 1000000 / (req_usec ? req_usec : 1)),
+        stat.workers, (unsigned long long)stat.accepted);
+    EH_DBG_ERROR_EXEC(stat.accepted != (uint64_t)(conn_total + TEST_CLIENT_CNT), return -1);
+    /* 工作任务被重复使用，数量远小于连接数 */
+    EH_DBG_ERROR_EXEC(stat.workers > 64, return -1);
+    EH_DBG_ERROR_EXEC(__await__ eh_tcp_server_destroy(server, EH_TIME_FOREVER) != EH_RET_OK, return -1);
+    return 0;
+}
+
+/* 工作任务数达到上限时，新连接留在backlog中，等到有任务空闲后才被接收 */
+static int test_max_conn(void){
+    eh_tcp_server_t *server;
+    struct eh_tcp_server_stat stat;
+    int fds[4];
+
+    server = start_server(1, 2, echo_handler);
+    EH_DBG_ERROR_EXEC(eh_ptr_to_error(server) < 0, return -1);
+    for(int i = 0; i < 4; i++){
+        fds[i] = client_connect();
+        EH_DBG_ERROR_EXEC(fds[i] < 0, return -1);
+    }
+    __await__ eh_usleep(20*1000);
+    eh_tcp_server_stat(server, &stat);
+    EH_DBG_ERROR_EXEC(stat.accepted != 2 || stat.active != 2 || stat.workers != 2, return -1);
+    EH_DBG_ERROR_EXEC(client_request(fds[0]) < 0, return -1);
+    eh_close(fds[0]);
+    EH_DBG_ERROR_EXEC(client_request(fds[2]) < 0, return -1);
+    eh_tcp_server_stat(server, &stat);
+    EH_DBG_ERROR_EXEC(stat.accepted != 3 || stat.workers != 2, return -1);
+    /* 销毁时正在处理的连接被关闭 */
+    EH_DBG_ERROR_EXEC(__await__ eh_tcp_server_destroy(server, EH_TIME_FOREVER) != EH_RET_OK, return -1);
+    EH_DBG_ERROR_EXEC(__await__ eh_recv(fds[1], &stat, 1, 0, (eh_sclock_t)eh_msec_to_clock(1000)) != 0, return -1);
+    for(int i = 1; i < 4; i++)
+        eh_close(fds[i]);
+    return 0;
+}
+
+/* handler挂起在连接以外的事件上时，销毁超时返回，服务端保留到handler返回后再次销毁 */
+static int test_destroy_timeout(void){
+    eh_tcp_server_t *server;
+    eh_clock_t start;
+    int fd;
+
+    server = start_server(1, 2, sleep_handler);
+    EH_DBG_ERROR_EXEC(eh_ptr_to_error(server) < 0, return -1);
+    fd = client_connect();
+    EH_DBG_ERROR_EXEC(fd < 0, return -1);
+    EH_DBG_ERROR_EXEC(__await__ eh_send(fd, "x", 1, 0, EH_TIME_FOREVER) != 1, return -1);
+    __await__ eh_usleep(20*1000);
+    start = eh_get_clock_monotonic_time();
+    EH_DBG_ERROR_EXEC(__await__ eh_tcp_server_destroy(server, (eh_sclock_t)eh_msec_to_clock(20)) != EH_RET_TIMEOUT, return -1);
+    EH_DBG_ERROR_EXEC(eh_get_clock_monotonic_time() - start > (eh_clock_t)eh_msec_to_clock(150), return -1);
+    EH_DBG_ERROR_EXEC(__await__ eh_tcp_server_destroy(server, EH_TIME_FOREVER) != EH_RET_OK, return -1);
+    eh_close(fd);
+    return 0;
+}
+
+int task_app(void *arg){
+    (void) arg;
+    EH_DBG_ERROR_EXEC(test_max_conn() < 0, return -1);
+    eh_debugfl("test tcp server max conn Pass");
+    EH_DBG_ERROR_EXEC(test_destroy_timeout() < 0, return -1);
+    eh_debugfl("test tcp server destroy timeout Pass");
+    EH_DBG_ERROR_EXEC(test_bench(1) < 0, return -1);
+    eh_debugfl("test tcp server bench Pass");
+    EH_DBG_ERROR_EXEC(test_bench(4) < 0, return -1);
+    eh_debugfl("test tcp server reuseport bench Pass");
+    return 0;
+}
+
+int main(void){
+    int ret;
+    eh_global_init();
+    ret = task_app("task_app");
+    eh_global_exit();
+    return ret;
+}
@@ -0,0 +1,218 @@
+/**
+ * @file test_udp.c
+ * @brief 批量UDP收发测试，并与逐个报文的sendto/recvfrom比较吞吐
+ * @author simon.xiaoapeng (simon.xiaoapeng@gmail.com)
+ * @version 1.0
+ * @date 2024-08-26
+ *
+ * @copyright Copyright (c) 2024  simon.xiaoapeng@gmail.com
+ *
+ * @par 修改日志:
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include "eh.h"
+#include "eh_debug.h"
+#include "eh_event.h"
+#include "eh_platform.h"
+#include "eh_timer.h"
+#include "eh_fd.h"
+#include "eh_udp.h"
+
+#define TEST_BATCH_CNT          64
+#define TEST_MSG_SIZE           2048
+#define TEST_BENCH_MSG_LEN      64
+#define TEST_BENCH_ROUNDS       2000
+#define TEST_GSO_SEGMENT        1000
+#define TEST_GSO_SEGMENT_CNT    8
+
+static uint8_t gso_buf[TEST_GSO_SEGMENT * TEST_GSO_SEGMENT_CNT];
+
+void stdout_write(void *stream, const uint8_t *buf, size_t size){
+    (void)stream;
+    printf("%.*s", (int)size, (const char*)buf);
+}
+
+static int udp_socket(struct sockaddr_in *addr){
+    socklen_t addrlen = sizeof(*addr);
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if(fd < 0)
+        return -1;
+    memset(addr, 0, sizeof(*addr));
+    addr->sin_family = AF_INET;
+    addr->sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if(bind(fd, (struct sockaddr*)addr, sizeof(*addr)) < 0 || eh_fd_register(fd) < 0){
+        close(fd);
+        return -1;
+    }
+    getsockname(fd, (struct sockaddr*)addr, &addrlen);
+    return fd;
+}
+
+static int test_basic(int tx, int rx, struct sockaddr_in *tx_addr, struct sockaddr_in *rx_addr){
+    eh_udp_batch_t *batch;
+    struct eh_udp_msg *msg;
+    char text[16];
+    int cnt = 0;
+
+    batch = eh_udp_batch_create(4, 64);
+    EH_DBG_ERROR_EXEC(eh_ptr_to_error(batch) < 0, return -1);
+    EH_DBG_ERROR_EXEC(__await__ eh_udp_recv_batch(rx, batch, (eh_sclock_t)eh_msec_to_clock(10)) != -1 || errno != ETIMEDOUT, return -1);
+    for(int i = 0; i < 4; i++){
+        snprintf(text, sizeof(text), "msg%d", i);
+        EH_DBG_ERROR_EXEC(eh_udp_batch_add(batch, text, strlen(text), (struct sockaddr*)rx_addr, sizeof(*rx_addr), 0) < 0, return -1);
+    }
+    EH_DBG_ERROR_EXEC(eh_udp_batch_add(batch, "full", 4, (struct sockaddr*)rx_addr, sizeof(*rx_addr), 0) != EH_RET_BUSY, return -1);
+    EH_DBG_ERROR_EXEC(__await__ eh_udp_send_batch(tx, batch, EH_TIME_FOREVER) != 4, return -1);
+    EH_DBG_ERROR_EXEC(eh_udp_batch_count(batch) != 0, return -1);
+    while(cnt < 4){
+        int n = __await__ eh_udp_recv_batch(rx, batch, (eh_sclock_t)eh_msec_to_clock(1000));
+        EH_DBG_ERROR_EXEC(n <= 0, return -1);
+        for(int i = 0; i < n; i++, cnt++){
+            msg = eh_udp_batch_msg(batch, i);
+            snprintf(text, sizeof(text), "msg%d", cnt);
+            EH_DBG_ERROR_EXEC(msg->len != strlen(text) || memcmp(msg->data, text, msg->len) != 0, return -1);
+            EH_DBG_ERROR_EXEC(((struct sockaddr_in*)&msg->addr)->sin_port != tx_addr->sin_port, return -1);
+        }
+    }
+
+    /* 中途失败时未发出的报文留在批次中，修正后可以继续发送 */
+    eh_udp_batch_clear(batch);
+    EH_DBG_ERROR_EXEC(eh_udp_batch_add(batch, "good0", 5, (struct sockaddr*)rx_addr, sizeof(*rx_addr), 0) < 0, return -1);
+    EH_DBG_ERROR_EXEC(eh_udp_batch_add(batch, "bad1", 4, (struct sockaddr*)rx_addr, 4, 0) < 0, return -1);
+    EH_DBG_ERROR_EXEC(eh_udp_batch_add(batch, "good2", 5, (struct sockaddr*)rx_addr, sizeof(*rx_addr), 0) < 0, return -1);
+    EH_DBG_ERROR_EXEC(__await__ eh_udp_send_batch(tx, batch, EH_TIME_FOREVER) != 1 || errno != EINVAL, return -1);
+    EH_DBG_ERROR_EXEC(eh_udp_batch_count(batch) != 2, return -1);
+    msg = eh_udp_batch_msg(batch, 0);
+    EH_DBG_ERROR_EXEC(msg->len != 4 || memcmp(msg->data, "bad1", 4) != 0, return -1);
+    msg->addrlen = sizeof(*rx_addr);
+    msg = eh_udp_batch_msg(batch, 1);
+    EH_DBG_ERROR_EXEC(msg->len != 5 || memcmp(msg->data, "good2", 5) != 0, return -1);
+    EH_DBG_ERROR_EXEC(__await__ eh_udp_send_batch(tx, batch, EH_TIME_FOREVER) != 2, return -1);
+    EH_DBG_ERROR_EXEC(eh_udp_batch_count(batch) != 0, return -1);
+    for(cnt = 0; cnt < 3; ){
+        int n = __await__ eh_udp_recv_batch(rx, batch, (eh_sclock_t)eh_msec_to_clock(1000));
+        EH_DBG_ERROR_EXEC(n <= 0, return -1);
+        cnt += n;
+    }
+    msg = eh_udp_batch_msg(batch, eh_udp_batch_count(batch) - 1);
+    EH_DBG_ERROR_EXEC(cnt != 3 || msg->len != 5 || memcmp(msg->data, "good2", 5) != 0, return -1);
+    eh_udp_batch_destroy(batch);
+    return 0;
+}
+
+/* 一个报文按TEST_GSO_SEGMENT切分发送，接收端开启GRO后可能再合并 */
+static int test_gso(int tx, int rx, struct sockaddr_in *rx_addr, bool gro){
+    eh_udp_batch_t *batch;
+    struct eh_udp_msg *msg;
+    size_t total = 0;
+    int cnt = 0;
+
+    for(size_t i = 0; i < sizeof(gso_buf); i++)
+        gso_buf[i] = (uint8_t)(i / TEST_GSO_SEGMENT);
+    if(gro && eh_udp_set_gro(rx, true) < 0){
+        eh_infofl("gro: not supported, skip");
+        return 0;
+    }
+    batch = eh_udp_batch_create(TEST_GSO_SEGMENT_CNT, sizeof(gso_buf));
+    EH_DBG_ERROR_EXEC(eh_ptr_to_error(batch) < 0, return -1);
+    EH_DBG_ERROR_EXEC(eh_udp_batch_add(batch, gso_buf, sizeof(gso_buf), (struct sockaddr*)rx_addr, sizeof(*rx_addr), TEST_GSO_SEGMENT) < 0, return -1);
+    if(__await__ eh_udp_send_batch(tx, batch, EH_TIME_FOREVER) != 1){
+        eh_infofl("gso: send failed errno=%d, skip", errno);
+        eh_udp_batch_destroy(batch);
+        return 0;
+    }
+    while(total < sizeof(gso_buf)){
+        int n = __await__ eh_udp_recv_batch(rx, batch, (eh_sclock_t)eh_msec_to_clock(1000));
+        EH_DBG_ERROR_EXEC(n <= 0, return -1);
+        for(int i = 0; i < n; i++, cnt++){
+            msg = eh_udp_batch_msg(batch, i);
+            EH_DBG_ERROR_EXEC(memcmp(msg->data, gso_buf + total, msg->len) != 0, return -1);
+            EH_DBG_ERROR_EXEC(!gro && msg->len != TEST_GSO_SEGMENT, return -1);
+            total += msg->len;
+        }
+    }
+    eh_infofl("%s: %zu bytes in %d messages, segment size %u", gro ? "gro" : "gso", total, cnt,
+        (unsigned)eh_udp_batch_msg(batch, 0)->segment_size);
+    eh_udp_batch_destroy(batch);
+    if(gro)
+        eh_udp_set_gro(rx, false);
+    return 0;
+}
+
+static int test_bench(int tx, int rx, struct sockaddr_in *rx_addr){
+    eh_udp_batch_t *tx_batch, *rx_batch;
+    uint8_t buf[TEST_BENCH_MSG_LEN] = {0};
+    eh_clock_t start;
+    eh_usec_t batch_usec, single_usec;
+    int total = TEST_BENCH_ROUNDS * TEST_BATCH_CNT;
+
+    tx_batch = eh_udp_batch_create(TEST_BATCH_CNT, TEST_MSG_SIZE);
+    EH_DBG_ERROR_EXEC(eh_ptr_to_error(tx_batch) < 0, return -1);
+    rx_batch = eh_udp_batch_create(TEST_BATCH_CNT, TEST_MSG_SIZE);
+    EH_DBG_ERROR_EXEC(eh_ptr_to_error(rx_batch) < 0, return -1);
+
+    /* 每轮发出TEST_BATCH_CNT个报文后全部收回，接收缓冲区不会溢出 */
+    start = eh_get_clock_monotonic_time();
+    for(int round = 0; round < TEST_BENCH_ROUNDS; round++){
+        int got = 0;
+        for(int i = 0; i < TEST_BATCH_CNT; i++)
+            eh_udp_batch_add(tx_batch, buf, sizeof(buf), (struct sockaddr*)rx_addr, sizeof(*rx_addr), 0);
+        EH_DBG_ERROR_EXEC(__await__ eh_udp_send_batch(tx, tx_batch, EH_TIME_FOREVER) != TEST_BATCH_CNT, return -1);
+        while(got < TEST_BATCH_CNT){
+            int n = __await__ eh_udp_recv_batch(rx, rx_batch, (eh_sclock_t)eh_msec_to_clock(1000));
+            EH_DBG_ERROR_EXEC(n <= 0, return -1);
+            got += n;
+        }
+    }
+    batch_usec = eh_clock_to_usec(eh_get_clock_monotonic_time() - start);
+
+    start = eh_get_clock_monotonic_time();
+    for(int round = 0; round < TEST_BENCH_ROUNDS; round++){
+        for(int i = 0; i < TEST_BATCH_CNT; i++)
+            EH_DBG_ERROR_EXEC(sendto(tx, buf, sizeof(buf), 0, (struct sockaddr*)rx_addr, sizeof(*rx_addr)) != sizeof(buf), return -1);
+        for(int i = 0; i < TEST_BATCH_CNT; i++)
+            EH_DBG_ERROR_EXEC(recvfrom(rx, buf, sizeof(buf), 0, NULL, NULL) != sizeof(buf), return -1);
+    }
+    single_usec = eh_clock_to_usec(eh_get_clock_monotonic_time() - start);
+
+    eh_infofl("bench: %d datagrams, batch %llu us (%llu pps), sendto/recvfrom %llu us (%llu pps)", total,
+        (unsigned long long)batch_usec, (unsigned long long)((uint64_t)total * 1000000 / (batch_usec ? batch_usec : 1)),
+        (unsigned long long)single_usec, (unsigned long long)((uint64_t)total * 1000000 / (single_usec ? single_usec : 1)));
+    eh_udp_batch_destroy(tx_batch);
+    eh_udp_batch_destroy(rx_batch);
+    return 0;
+}
+
+int task_app(void *arg){
+    struct sockaddr_in tx_addr, rx_addr;
+    int tx, rx;
+    (void) arg;
+    tx = udp_socket(&tx_addr);
+    rx = udp_socket(&rx_addr);
+    EH_DBG_ERROR_EXEC(tx < 0 || rx < 0, return -1);
+    EH_DBG_ERROR_EXEC(test_basic(tx, rx, &tx_addr, &rx_addr) < 0, return -1);
+    eh_debugfl("test udp basic Pass");
+    EH_DBG_ERROR_EXEC(test_gso(tx, rx, &rx_addr, false) < 0, return -1);
+    eh_debugfl("test udp gso Pass");
+    EH_DBG_ERROR_EXEC(test_gso(tx, rx, &rx_addr, true) < 0, return -1);
+    eh_debugfl("test udp gro Pass");
+    EH_DBG_ERROR_EXEC(test_bench(tx, rx, &rx_addr) < 0, return -1);
+    eh_debugfl("test udp bench Pass");
+    eh_close(tx);
+    eh_close(rx);
+    return 0;
+}
+
+int main(void){
+    int ret;
+    eh_global_init();
+    ret = task_app("task_app");
+    eh_global_exit();
+    return ret;
+}
@@ -0,0 +1,150 @@
+/**
+ * @file test_uring.c
+ * @brief io_uring后端测试，需要使用-DEH_CONFIG_LINUX_IO_URING=ON配置
+ * @author simon.xiaoapeng (simon.xiaoapeng@gmail.com)
+ * @version 1.0
+ * @date 2024-08-22
+ *
+ * @copyright Copyright (c) 2024  simon.xiaoapeng@gmail.com
+ *
+ * @par 修改日志:
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include "eh.h"
+#include "eh_debug.h"
+#include "eh_event.h"
+#include "eh_platform.h"
+#include "eh_timer.h"
+#include "eh_sleep.h"
+#include "eh_fd.h"
+#include "eh_uring.h"
+
+#define TEST_BENCH_TASK_CNT     16
+#define TEST_BENCH_READ_CNT     20000
+#define TEST_BENCH_BLOCK_SIZE   4096
+
+static int bench_fd;
+
+void stdout_write(void *stream, const uint8_t *buf, size_t size){
+    (void)stream;
+    printf("%.*s", (int)size, (const char*)buf);
+}
+
+static int test_pipe(void){
+    int fds[2];
+    char buf[8];
+    EH_DBG_ERROR_EXEC(pipe(fds) < 0, return -1);
+    EH_DBG_ERROR_EXEC(__await__ eh_uring_read(fds[0], buf, sizeof(buf), -1, (eh_sclock_t)eh_msec_to_clock(10)) != -1 || errno != ETIMEDOUT, return -1);
+    EH_DBG_ERROR_EXEC(__await__ eh_uring_write(fds[1], "hello", 5, -1, EH_TIME_FOREVER) != 5, return -1);
+    EH_DBG_ERROR_EXEC(__await__ eh_uring_read(fds[0], buf, sizeof(buf), -1, EH_TIME_FOREVER) != 5, return -1);
+    EH_DBG_ERROR_EXEC(memcmp(buf, "hello", 5) != 0, return -1);
+    close(fds[0]);
+    close(fds[1]);
+    return 0;
+}
+
+static int task_client(void *arg){
+    struct sockaddr_in *addr = (struct sockaddr_in *)arg;
+    char buf[8];
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    EH_DBG_ERROR_EXEC(fd < 0, return -1);
+    /* 与epoll_hub_add_fd的接口可以同时使用 */
+    EH_DBG_ERROR_EXEC(__await__ eh_connect(fd, (struct sockaddr*)addr, sizeof(*addr), (eh_sclock_t)eh_msec_to_clock(1000)) < 0, return -1);
+    EH_DBG_ERROR_EXEC(__await__ eh_send(fd, "ping", 4, 0, EH_TIME_FOREVER) != 4, return -1);
+    EH_DBG_ERROR_EXEC(__await__ eh_recv(fd, buf, sizeof(buf), 0, EH_TIME_FOREVER) != 4, return -1);
+    eh_close(fd);
+    return memcmp(buf, "pong", 4) == 0 ? 0 : -1;
+}
+
+static int test_socket(void){
+    struct sockaddr_in addr;
+    socklen_t addrlen = sizeof(addr);
+    eh_task_t *client;
+    char buf[8];
+    int listen_fd, fd, client_ret;
+
+    listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    EH_DBG_ERROR_EXEC(listen_fd < 0, return -1);
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    EH_DBG_ERROR_EXEC(bind(listen_fd, (struct sockaddr*)&addr, sizeof(addr)) < 0, return -1);
+    EH_DBG_ERROR_EXEC(listen(listen_fd, 8) < 0, return -1);
+    getsockname(listen_fd, (struct sockaddr*)&addr, &addrlen);
+
+    client = eh_task_create("client", 0, 12*1024, &addr, task_client);
+    EH_DBG_ERROR_EXEC(eh_ptr_to_error(client) < 0, return -1);
+    fd = __await__ eh_uring_accept(listen_fd, NULL, NULL, (eh_sclock_t)eh_msec_to_clock(1000));
+    EH_DBG_ERROR_EXEC(fd < 0, return -1);
+    EH_DBG_ERROR_EXEC(__await__ eh_uring_recv(fd, buf, sizeof(buf), 0, EH_TIME_FOREVER) != 4, return -1);
+    EH_DBG_ERROR_EXEC(memcmp(buf, "ping", 4) != 0, return -1);
+    EH_DBG_ERROR_EXEC(__await__ eh_uring_send(fd, "pong", 4, 0, EH_TIME_FOREVER) != 4, return -1);
+    EH_DBG_ERROR_EXEC(__await__ eh_task_join(client, &client_ret, EH_TIME_FOREVER) < 0 || client_ret != 0, return -1);
+    close(fd);
+    close(listen_fd);
+    return 0;
+}
+
+static int task_bench_reader(void *arg){
+    uint8_t buf[TEST_BENCH_BLOCK_SIZE];
+    (void)arg;
+    for(int i = 0; i < TEST_BENCH_READ_CNT; i++){
+        if(__await__ eh_uring_read(bench_fd, buf, sizeof(buf), 0, EH_TIME_FOREVER) != sizeof(buf))
+            return -1;
+    }
+    return 0;
+}
+
+static int test_bench(void){
+    eh_task_t *tasks[TEST_BENCH_TASK_CNT];
+    uint64_t enter_start, enter_end, submit_start, submit_end;
+    eh_clock_t start;
+    eh_usec_t usec;
+    int ret;
+
+    bench_fd = open("/dev/zero", O_RDONLY);
+    EH_DBG_ERROR_EXEC(bench_fd < 0, return -1);
+    eh_uring_stat(&enter_start, &submit_start);
+    start = eh_get_clock_monotonic_time();
+    for(int i = 0; i < TEST_BENCH_TASK_CNT; i++){
+        tasks[i] = eh_task_create("bench_reader", 0, 12*1024, NULL, task_bench_reader);
+        EH_DBG_ERROR_EXEC(eh_ptr_to_error(tasks[i]) < 0, return -1);
+    }
+    for(int i = 0; i < TEST_BENCH_TASK_CNT; i++){
+        EH_DBG_ERROR_EXEC(__await__ eh_task_join(tasks[i], &ret, EH_TIME_FOREVER) < 0 || ret != 0, return -1);
+    }
+    usec = eh_clock_to_usec(eh_get_clock_monotonic_time() - start);
+    eh_uring_stat(&enter_end, &submit_end);
+    eh_infofl("%d reads in %llu us (%llu IOPS), %llu submissions in %llu io_uring_enter calls",
+        TEST_BENCH_TASK_CNT * TEST_BENCH_READ_CNT, (unsigned long long)usec,
+        (unsigned long long)((uint64_t)TEST_BENCH_TASK_CNT * TEST_BENCH_READ_CNT * 1000000 / (usec ? usec : 1)),
+        (unsigned long long)(submit_end - submit_start), (unsigned long long)(enter_end - enter_start));
+    close(bench_fd);
+    return 0;
+}
+
+int task_app(void *arg){
+    (void) arg;
+    EH_DBG_ERROR_EXEC(test_pipe() < 0, return -1);
+    eh_debugfl("test uring pipe Pass");
+    EH_DBG_ERROR_EXEC(test_socket() < 0, return -1);
+    eh_debugfl("test uring socket Pass");
+    EH_DBG_ERROR_EXEC(test_bench() < 0, return -1);
+    eh_debugfl("test uring bench Pass");
+    return 0;
+}
+
+int main(void){
+    int ret;
+    eh_global_init();
+    ret = task_app("task_app");
+    eh_global_exit();
+    return ret;
+}
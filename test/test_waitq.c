@@ -0,0 +1,113 @@
+/**
+ * @file test_waitq.c
+ * @brief 带键值的等待队列测试
+ * @author simon.xiaoapeng (simon.xiaoapeng@gmail.com)
+ * @version 1.0
+ * @date 2024-08-12
+ * 
+ * @copyright Copyright (c) 2024  simon.xiaoapeng@gmail.com
+ * 
+ * @par 修改日志:
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "eh.h"
+#include "eh_debug.h"
+#include "eh_event.h"
+#include "eh_platform.h"
+#include "eh_timer.h"
+#include "eh_sleep.h"
+#include "eh_waitq.h"
+
+#define TEST_WAITER_CNT     64
+
+static EH_DEFINE_WAITQ(test_wq);
+static int wakeup_cnt;
+static int error_cnt;
+static void *wakeup_value;
+
+void stdout_write(void *stream, const uint8_t *buf, size_t size){
+    (void)stream;
+    printf("%.*s", (int)size, (const char*)buf);
+}
+
+static bool match_greater_equal(void *match_arg, uintptr_t key){
+    return key >= (uintptr_t)match_arg;
+}
+
+int task_waiter(void *arg){
+    void *value;
+    int ret;
+    if((uintptr_t)arg == TEST_WAITER_CNT)
+        ret = __await__ eh_waitq_wait_match(&test_wq, match_greater_equal, (void*)(uintptr_t)1000, &value, EH_TIME_FOREVER);
+    else
+        ret = __await__ eh_waitq_wait(&test_wq, (uintptr_t)arg, &value, EH_TIME_FOREVER);
+    if(ret == EH_RET_EVENT_ERROR){
+        error_cnt++;
+        return 0;
+    }
+    if(ret < 0)
+        return ret;
+    wakeup_cnt++;
+    wakeup_value = value;
+    return 0;
+}
+
+int task_app(void *arg){
+    eh_task_t *tasks[TEST_WAITER_CNT + 1];
+    (void) arg;
+
+    /* 用例1 超时 */
+    EH_DBG_ERROR_EXEC(eh_waitq_wait(&test_wq, 1, NULL, 0) != EH_RET_TIMEOUT, return -1);
+    EH_DBG_ERROR_EXEC(eh_waitq_wait(&test_wq, 1, NULL, (eh_sclock_t)eh_msec_to_clock(10)) != EH_RET_TIMEOUT, return -1);
+    EH_DBG_ERROR_EXEC(eh_waitq_has_waiter(&test_wq), return -1);
+
+    for(uintptr_t i = 0; i <= TEST_WAITER_CNT; i++){
+        tasks[i] = eh_task_create("waiter", EH_TASK_FLAGS_DETACH, 4*1024, (void*)i, task_waiter);
+        EH_DBG_ERROR_EXEC(eh_ptr_to_error(tasks[i]) < 0, return -1);
+    }
+    __await__ eh_usleep(10*1000);
+
+    /* 用例2 按键值唤醒，只有一个任务被唤醒 */
+    EH_DBG_ERROR_EXEC(eh_waitq_wake(&test_wq, 42, EH_WAITQ_WAKE_ALL, "key42") != 1, return -1);
+    EH_DBG_ERROR_EXEC(eh_waitq_wake(&test_wq, TEST_WAITER_CNT + 1, EH_WAITQ_WAKE_ALL, NULL) != 0, return -1);
+    __await__ eh_usleep(10*1000);
+    EH_DBG_ERROR_EXEC(wakeup_cnt != 1 || strcmp(wakeup_value, "key42"), return -1);
+
+    /* 用例3 匹配函数 */
+    EH_DBG_ERROR_EXEC(eh_waitq_wake(&test_wq, 1000, EH_WAITQ_WAKE_ALL, "match") != 1, return -1);
+    __await__ eh_usleep(10*1000);
+    EH_DBG_ERROR_EXEC(wakeup_cnt != 2 || strcmp(wakeup_value, "match"), return -1);
+
+    /* 用例4 按顺序唤醒指定个数 */
+    EH_DBG_ERROR_EXEC(eh_waitq_wake(&test_wq, EH_WAITQ_KEY_ANY, 3, "any") != 3, return -1);
+    __await__ eh_usleep(10*1000);
+    EH_DBG_ERROR_EXEC(wakeup_cnt != 5 || strcmp(wakeup_value, "any"), return -1);
+
+    /* 用例5 清除剩余的等待者 */
+    eh_waitq_clean(&test_wq);
+    __await__ eh_usleep(10*1000);
+    EH_DBG_ERROR_EXEC(error_cnt != TEST_WAITER_CNT + 1 - 5, return -1);
+    EH_DBG_ERROR_EXEC(eh_waitq_has_waiter(&test_wq), return -1);
+
+    /* 用例6 已被唤醒但还未运行的等待者，清除队列后返回错误 */
+    tasks[0] = eh_task_create("waiter", EH_TASK_FLAGS_DETACH, 4*1024, (void*)7, task_waiter);
+    EH_DBG_ERROR_EXEC(eh_ptr_to_error(tasks[0]) < 0, return -1);
+    __await__ eh_usleep(10*1000);
+    EH_DBG_ERROR_EXEC(eh_waitq_wake(&test_wq, 7, EH_WAITQ_WAKE_ALL, "handoff") != 1, return -1);
+    eh_waitq_clean(&test_wq);
+    __await__ eh_usleep(10*1000);
+    EH_DBG_ERROR_EXEC(wakeup_cnt != 5 || error_cnt != TEST_WAITER_CNT + 1 - 5 + 1, return -1);
+
+    eh_debugfl("test_waitq Pass");
+    return 0;
+}
+
+int main(void){
+    int ret;
+    eh_global_init();
+    ret = task_app("task_app");
+    eh_global_exit();
+    return ret;
+}